@@ -1071,6 +1071,13 @@ int opt_max_alloc(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+int opt_hugepages(void *optctx, const char *opt, const char *arg)
+{
+    av_buffer_set_hugepage_threshold(parse_number_or_die(opt, arg, OPT_INT64,
+                                                         0, SIZE_MAX));
+    return 0;
+}
+
 int opt_timelimit(void *optctx, const char *opt, const char *arg)
 {
 #if HAVE_SETRLIMIT
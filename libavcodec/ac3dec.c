@@ -222,10 +222,8 @@ static av_cold int ac3_decode_init(AVCodecContext *avctx)
         avctx->channels = 2;
     s->downmixed = 1;
 
-    for (i = 0; i < AC3_MAX_CHANNELS; i++) {
-        s->xcfptr[i] = s->transform_coeffs[i];
+    for (i = 0; i < AC3_MAX_CHANNELS; i++)
         s->dlyptr[i] = s->delay[i];
-    }
 
     ff_thread_once(&init_static_once, ac3_tables_init);
 
@@ -369,14 +367,8 @@ static int parse_frame_header(AC3DecodeContext *s)
  * Set stereo downmixing coefficients based on frame header info.
  * reference: Section 7.8.2 Downmixing Into Two Channels
  */
-static int set_downmix_coeffs(AC3DecodeContext *s)
+static int alloc_downmix_coeffs(AC3DecodeContext *s)
 {
-    int i;
-    float cmix = gain_levels[s->  center_mix_level];
-    float smix = gain_levels[s->surround_mix_level];
-    float norm0, norm1;
-    float downmix_coeffs[2][AC3_MAX_CHANNELS];
-
     if (!s->downmix_coeffs[0]) {
         s->downmix_coeffs[0] = av_malloc_array(2 * AC3_MAX_CHANNELS,
                                                sizeof(**s->downmix_coeffs));
@@ -384,6 +376,19 @@ static int set_downmix_coeffs(AC3DecodeContext *s)
             return AVERROR(ENOMEM);
         s->downmix_coeffs[1] = s->downmix_coeffs[0] + AC3_MAX_CHANNELS;
     }
+    return 0;
+}
+
+static int set_downmix_coeffs(AC3DecodeContext *s)
+{
+    int i, ret;
+    float cmix = gain_levels[s->  center_mix_level];
+    float smix = gain_levels[s->surround_mix_level];
+    float norm0, norm1;
+    float downmix_coeffs[2][AC3_MAX_CHANNELS];
+
+    if ((ret = alloc_downmix_coeffs(s)) < 0)
+        return ret;
 
     for (i = 0; i < s->fbw_channels; i++) {
         downmix_coeffs[0][i] = gain_levels[ac3_default_coeffs[s->channel_mode][i][0]];
@@ -688,40 +693,50 @@ static void do_rematrixing(AC3DecodeContext *s)
 /**
  * Inverse MDCT Transform.
  * Convert frequency domain coefficients to time-domain audio samples.
+ * The first half of the output is overlapped with the delay samples by
+ * window_block(), the second half becomes the new delay.
  * reference: Section 7.9.4 Transformation Equations
  */
-static inline void do_imdct(AC3DecodeContext *s, int channels, int offset)
+static inline void do_imdct(AC3DecodeContext *s, int blk, int channels)
 {
     int ch;
 
     for (ch = 1; ch <= channels; ch++) {
-        if (s->block_switch[ch]) {
+        FFTSample *out = s->imdct_output[blk][ch - 1];
+        INTFLOAT *coeffs = s->block_coeffs[blk][ch];
+
+        if (s->block_switched[blk][ch]) {
             int i;
-            FFTSample *x = s->tmp_output + 128;
+            FFTSample *x = s->tmp_output;
             for (i = 0; i < 128; i++)
-                x[i] = s->transform_coeffs[ch][2 * i];
-            s->imdct_256.imdct_half(&s->imdct_256, s->tmp_output, x);
-#if USE_FIXED
-            s->fdsp->vector_fmul_window_scaled(s->outptr[ch - 1], s->delay[ch - 1 + offset],
-                                       s->tmp_output, s->window, 128, 8);
-#else
-            s->fdsp->vector_fmul_window(s->outptr[ch - 1], s->delay[ch - 1 + offset],
-                                       s->tmp_output, s->window, 128);
-#endif
+                x[i] = coeffs[2 * i];
+            s->imdct_256.imdct_half(&s->imdct_256, out, x);
             for (i = 0; i < 128; i++)
-                x[i] = s->transform_coeffs[ch][2 * i + 1];
-            s->imdct_256.imdct_half(&s->imdct_256, s->delay[ch - 1 + offset], x);
+                x[i] = coeffs[2 * i + 1];
+            s->imdct_256.imdct_half(&s->imdct_256, out + 128, x);
         } else {
-            s->imdct_512.imdct_half(&s->imdct_512, s->tmp_output, s->transform_coeffs[ch]);
+            s->imdct_512.imdct_half(&s->imdct_512, out, coeffs);
+        }
+    }
+}
+
+/**
+ * Overlap-add the IMDCT output of a block with the delay samples.
+ */
+static inline void window_block(AC3DecodeContext *s, int blk, int channels, int offset)
+{
+    int ch;
+
+    for (ch = 1; ch <= channels; ch++) {
+        FFTSample *x = s->imdct_output[blk][ch - 1];
 #if USE_FIXED
-            s->fdsp->vector_fmul_window_scaled(s->outptr[ch - 1], s->delay[ch - 1 + offset],
-                                       s->tmp_output, s->window, 128, 8);
+        s->fdsp->vector_fmul_window_scaled(s->outptr[ch - 1], s->delay[ch - 1 + offset],
+                                           x, s->window, 128, 8);
 #else
-            s->fdsp->vector_fmul_window(s->outptr[ch - 1], s->delay[ch - 1 + offset],
-                                       s->tmp_output, s->window, 128);
+        s->fdsp->vector_fmul_window(s->outptr[ch - 1], s->delay[ch - 1 + offset],
+                                    x, s->window, 128);
 #endif
-            memcpy(s->delay[ch - 1 + offset], s->tmp_output + 128, 128 * sizeof(FFTSample));
-        }
+        memcpy(s->delay[ch - 1 + offset], x + 128, 128 * sizeof(FFTSample));
     }
 }
 
@@ -1070,17 +1085,18 @@ static inline int coupling_coordinates(AC3DecodeContext *s, int blk)
 /**
  * Decode a single audio block from the AC-3 bitstream.
  */
-static int decode_audio_block(AC3DecodeContext *s, int blk, int offset)
+static int decode_audio_block(AC3DecodeContext *s, int blk)
 {
     int fbw_channels = s->fbw_channels;
     int channel_mode = s->channel_mode;
     int i, bnd, seg, ch, ret;
     int different_transforms;
-    int downmix_output;
     int cpl_in_use;
     GetBitContext *gbc = &s->gbc;
     uint8_t bit_alloc_stages[AC3_MAX_CHANNELS] = { 0 };
 
+    s->transform_coeffs = s->block_coeffs[blk];
+
     /* block switch flags */
     different_transforms = 0;
     if (s->block_switch_syntax) {
@@ -1419,47 +1435,131 @@ static int decode_audio_block(AC3DecodeContext *s, int blk, int offset)
         ff_eac3_apply_spectral_extension(s);
     }
 
-    /* downmix and MDCT. order depends on whether block switching is used for
-       any channel in this block. this is because coefficients for the long
-       and short transforms cannot be mixed. */
-    downmix_output = s->channels != s->out_channels &&
-                     !((s->output_mode & AC3_OUTPUT_LFEON) &&
-                     s->fbw_channels == s->out_channels);
-    if (different_transforms) {
-        /* the delay samples have already been downmixed, so we upmix the delay
-           samples in order to reconstruct all channels before downmixing. */
-        if (s->downmixed) {
-            s->downmixed = 0;
-            ac3_upmix_delay(s);
+    /* the transform is deferred until the whole frame has been parsed */
+    s->different_transforms[blk] = different_transforms;
+    memcpy(s->block_switched[blk], s->block_switch, sizeof(s->block_switch));
+
+    return 0;
+}
+
+/**
+ * Downmix and IMDCT of the decoded blocks.
+ * The order depends on whether block switching is used for any channel in a
+ * block, because coefficients for the long and short transforms cannot be
+ * mixed. This only depends on the current frame, so frame threads can run it
+ * concurrently.
+ */
+static void transform_blocks(AC3DecodeContext *s, int nb_blocks)
+{
+    int downmix_output = s->channels != s->out_channels &&
+                         !((s->output_mode & AC3_OUTPUT_LFEON) &&
+                         s->fbw_channels == s->out_channels);
+    int blk, ch;
+
+    for (blk = 0; blk < nb_blocks; blk++) {
+        if (s->different_transforms[blk]) {
+            do_imdct(s, blk, s->channels);
+        } else {
+            if (downmix_output) {
+                INTFLOAT *xcfptr[AC3_MAX_CHANNELS];
+                for (ch = 0; ch < AC3_MAX_CHANNELS; ch++)
+                    xcfptr[ch] = s->block_coeffs[blk][ch];
+                AC3_RENAME(ff_ac3dsp_downmix)(&s->ac3dsp, xcfptr + 1, s->downmix_coeffs,
+                                              s->out_channels, s->fbw_channels, 256);
+            }
+            do_imdct(s, blk, s->out_channels);
         }
+    }
+}
+
+/**
+ * With frame threading, the delay line is continued from the thread which
+ * decoded the previous frame. Wait until it is final there and copy it.
+ */
+static void await_delay_line(AC3DecodeContext *s)
+{
+    const AC3DecodeContext *prev = s->prev;
+
+    if (!prev)
+        return;
+
+    if (prev != s) {
+        ff_thread_await_progress(&s->prev_frame, INT_MAX, 0);
+        s->downmixed = prev->downmixed;
+        memcpy(s->delay,  prev->delay,  sizeof(s->delay));
+        memcpy(s->output, prev->output, sizeof(s->output));
+    }
+    s->prev = NULL;
+}
+
+/**
+ * Overlap-add the transformed blocks with the delay line and write them to
+ * the output buffer. Blocks from nb_blocks on could not be decoded and are
+ * concealed by repeating the last good block.
+ */
+static void output_blocks(AC3DecodeContext *s, int offset, int nb_blocks)
+{
+    const uint8_t *channel_map = ff_ac3_dec_channel_map[s->output_mode & ~AC3_OUTPUT_LFEON][s->lfe_on];
+    const SHORTFLOAT *output[AC3_MAX_CHANNELS];
+    int downmix_output = s->channels != s->out_channels &&
+                         !((s->output_mode & AC3_OUTPUT_LFEON) &&
+                         s->fbw_channels == s->out_channels);
+    int blk, ch;
 
-        do_imdct(s, s->channels, offset);
+    transform_blocks(s, nb_blocks);
+    await_delay_line(s);
 
-        if (downmix_output) {
+    for (ch = 0; ch < AC3_MAX_CHANNELS; ch++) {
+        output[ch] = s->output[ch + offset];
+        s->outptr[ch] = s->output[ch + offset];
+    }
+    for (ch = 0; ch < s->channels; ch++) {
+        if (ch < s->out_channels)
+            s->outptr[channel_map[ch]] = s->output_buffer[ch + offset];
+    }
+    for (blk = 0; blk < s->num_blocks; blk++) {
+        if (blk >= nb_blocks) {
+            for (ch = 0; ch < s->out_channels; ch++)
+                memcpy(s->output_buffer[ch + offset] + AC3_BLOCK_SIZE*blk, output[ch], AC3_BLOCK_SIZE*sizeof(SHORTFLOAT));
+        } else if (s->different_transforms[blk]) {
+            /* the delay samples have already been downmixed, so we upmix the delay
+               samples in order to reconstruct all channels before downmixing. */
+            if (s->downmixed) {
+                s->downmixed = 0;
+                ac3_upmix_delay(s);
+            }
+
+            window_block(s, blk, s->channels, offset);
+
+            if (downmix_output) {
 #if USE_FIXED
-            ac3_downmix_c_fixed16(s->outptr, s->downmix_coeffs,
-                              s->out_channels, s->fbw_channels, 256);
+                ac3_downmix_c_fixed16(s->outptr, s->downmix_coeffs,
+                                  s->out_channels, s->fbw_channels, 256);
 #else
-            ff_ac3dsp_downmix(&s->ac3dsp, s->outptr, s->downmix_coeffs,
-                              s->out_channels, s->fbw_channels, 256);
+                ff_ac3dsp_downmix(&s->ac3dsp, s->outptr, s->downmix_coeffs,
+                                  s->out_channels, s->fbw_channels, 256);
 #endif
-        }
-    } else {
-        if (downmix_output) {
-            AC3_RENAME(ff_ac3dsp_downmix)(&s->ac3dsp, s->xcfptr + 1, s->downmix_coeffs,
-                                          s->out_channels, s->fbw_channels, 256);
-        }
+            }
+        } else {
+            if (downmix_output && !s->downmixed) {
+                s->downmixed = 1;
+                AC3_RENAME(ff_ac3dsp_downmix)(&s->ac3dsp, s->dlyptr, s->downmix_coeffs,
+                                              s->out_channels, s->fbw_channels, 128);
+            }
 
-        if (downmix_output && !s->downmixed) {
-            s->downmixed = 1;
-            AC3_RENAME(ff_ac3dsp_downmix)(&s->ac3dsp, s->dlyptr, s->downmix_coeffs,
-                                          s->out_channels, s->fbw_channels, 128);
+            window_block(s, blk, s->out_channels, offset);
+        }
+        for (ch = 0; ch < s->out_channels; ch++)
+            output[ch] = s->outptr[channel_map[ch]];
+        for (ch = 0; ch < s->out_channels; ch++) {
+            if (!ch || channel_map[ch])
+                s->outptr[channel_map[ch]] += AC3_BLOCK_SIZE;
         }
-
-        do_imdct(s, s->out_channels, offset);
     }
 
-    return 0;
+    /* keep last block for error concealment in next frame */
+    for (ch = 0; ch < s->out_channels; ch++)
+        memcpy(s->output[ch + offset], output[ch], AC3_BLOCK_SIZE*sizeof(SHORTFLOAT));
 }
 
 /**
@@ -1477,11 +1577,13 @@ static int ac3_decode_frame(AVCodecContext * avctx, void *data,
     int skip = 0, got_independent_frame = 0;
     const uint8_t *channel_map;
     uint8_t extended_channel_map[EAC3_MAX_CHANNELS];
-    const SHORTFLOAT *output[AC3_MAX_CHANNELS];
     enum AVMatrixEncoding matrix_encoding;
     AVDownmixInfo *downmix_info;
 
     s->superframe_size = 0;
+    s->delay_final     = 0;
+    s->frame.f         = frame;
+    av_buffer_unref(&s->frame.progress);
 
     buf_size = full_buf_size;
     for (i = 1; i < buf_size; i += 2) {
@@ -1628,55 +1730,41 @@ dependent_frame:
     /* decode the audio blocks */
     channel_map = ff_ac3_dec_channel_map[s->output_mode & ~AC3_OUTPUT_LFEON][s->lfe_on];
     offset = s->frame_type == EAC3_FRAME_TYPE_DEPENDENT ? AC3_MAX_CHANNELS : 0;
-    for (ch = 0; ch < AC3_MAX_CHANNELS; ch++) {
-        output[ch] = s->output[ch + offset];
-        s->outptr[ch] = s->output[ch + offset];
-    }
-    for (ch = 0; ch < s->channels; ch++) {
-        if (ch < s->out_channels)
-            s->outptr[channel_map[ch]] = s->output_buffer[ch + offset];
-    }
-    for (blk = 0; blk < s->num_blocks; blk++) {
-        if (!err && decode_audio_block(s, blk, offset)) {
+    for (blk = 0; blk < s->num_blocks && !err; blk++) {
+        if (decode_audio_block(s, blk)) {
             av_log(avctx, AV_LOG_ERROR, "error decoding the audio block\n");
             err = 1;
-        }
-        if (err)
-            for (ch = 0; ch < s->out_channels; ch++)
-                memcpy(s->output_buffer[ch + offset] + AC3_BLOCK_SIZE*blk, output[ch], AC3_BLOCK_SIZE*sizeof(SHORTFLOAT));
-        for (ch = 0; ch < s->out_channels; ch++)
-            output[ch] = s->outptr[channel_map[ch]];
-        for (ch = 0; ch < s->out_channels; ch++) {
-            if (!ch || channel_map[ch])
-                s->outptr[channel_map[ch]] += AC3_BLOCK_SIZE;
+            break;
         }
     }
 
-    /* keep last block for error concealment in next frame */
-    for (ch = 0; ch < s->out_channels; ch++)
-        memcpy(s->output[ch + offset], output[ch], AC3_BLOCK_SIZE*sizeof(SHORTFLOAT));
-
     /* check if there is dependent frame */
     if (buf_size > s->frame_size) {
         AC3HeaderInfo hdr;
-        int err;
 
         if (buf_size - s->frame_size <= 16) {
             skip = buf_size - s->frame_size;
             goto skip;
         }
 
-        if ((ret = init_get_bits8(&s->gbc, buf + s->frame_size, buf_size - s->frame_size)) < 0)
+        if ((ret = init_get_bits8(&s->gbc, buf + s->frame_size, buf_size - s->frame_size)) < 0 ||
+            (ret = ff_ac3_parse_header(&s->gbc, &hdr))) {
+            /* the delay line is still updated with the blocks decoded */
+            output_blocks(s, offset, blk);
+            s->delay_final = 1;
             return ret;
-
-        err = ff_ac3_parse_header(&s->gbc, &hdr);
-        if (err)
-            return err;
+        }
 
         if (hdr.frame_type == EAC3_FRAME_TYPE_DEPENDENT) {
             if (hdr.num_blocks != s->num_blocks || s->sample_rate != hdr.sample_rate) {
                 av_log(avctx, AV_LOG_WARNING, "Ignoring non-compatible dependent frame.\n");
             } else {
+                /* The dependent frame is decoded with the same context, so
+                 * the independent frame has to be output first. This
+                 * serializes frame threads for such streams. */
+                output_blocks(s, offset, blk);
+                s->delay_final = 1;
+
                 buf += s->frame_size;
                 buf_size -= s->frame_size;
                 s->prev_output_mode = s->output_mode;
@@ -1687,6 +1775,8 @@ dependent_frame:
         }
     }
 skip:
+    if (s->delay_final)
+        output_blocks(s, offset, blk);
 
     frame->decode_error_flags = err ? FF_DECODE_ERROR_INVALID_BITSTREAM : 0;
 
@@ -1717,7 +1807,8 @@ skip:
         if (av_get_channel_layout_nb_channels(channel_layout) > EAC3_MAX_CHANNELS) {
             av_log(avctx, AV_LOG_ERROR, "Too many channels (%d) coded\n",
                    av_get_channel_layout_nb_channels(channel_layout));
-            return AVERROR_INVALIDDATA;
+            ret = AVERROR_INVALIDDATA;
+            goto fail;
         }
 
         avctx->channel_layout = channel_layout;
@@ -1728,10 +1819,14 @@ skip:
                 if (ff_eac3_custom_channel_map_locations[ch][0]) {
                     int index = av_get_channel_layout_channel_index(channel_layout,
                                                                     ff_eac3_custom_channel_map_locations[ch][1]);
-                    if (index < 0)
-                        return AVERROR_INVALIDDATA;
-                    if (extend >= channel_map_size)
-                        return AVERROR_INVALIDDATA;
+                    if (index < 0) {
+                        ret = AVERROR_INVALIDDATA;
+                        goto fail;
+                    }
+                    if (extend >= channel_map_size) {
+                        ret = AVERROR_INVALIDDATA;
+                        goto fail;
+                    }
 
                     extended_channel_map[index] = offset + channel_map[extend++];
                 } else {
@@ -1741,10 +1836,14 @@ skip:
                         if ((1ULL << i) & ff_eac3_custom_channel_map_locations[ch][1]) {
                             int index = av_get_channel_layout_channel_index(channel_layout,
                                                                             1ULL << i);
-                            if (index < 0)
-                                return AVERROR_INVALIDDATA;
-                            if (extend >= channel_map_size)
-                                return AVERROR_INVALIDDATA;
+                            if (index < 0) {
+                                ret = AVERROR_INVALIDDATA;
+                                goto fail;
+                            }
+                            if (extend >= channel_map_size) {
+                                ret = AVERROR_INVALIDDATA;
+                                goto fail;
+                            }
 
                             extended_channel_map[index] = offset + channel_map[extend++];
                         }
@@ -1756,16 +1855,8 @@ skip:
 
     /* get output buffer */
     frame->nb_samples = s->num_blocks * AC3_BLOCK_SIZE;
-    if ((ret = ff_get_buffer(avctx, frame, 0)) < 0)
-        return ret;
-
-    for (ch = 0; ch < avctx->channels; ch++) {
-        int map = extended_channel_map[ch];
-        av_assert0(ch>=AV_NUM_DATA_POINTERS || frame->extended_data[ch] == frame->data[ch]);
-        memcpy((SHORTFLOAT *)frame->extended_data[ch],
-               s->output_buffer[map],
-               s->num_blocks * AC3_BLOCK_SIZE * sizeof(SHORTFLOAT));
-    }
+    if ((ret = ff_thread_get_buffer(avctx, &s->frame, 0)) < 0)
+        goto fail;
 
     /*
      * AVMatrixEncoding
@@ -1794,7 +1885,7 @@ skip:
         }
     }
     if ((ret = ff_side_data_update_matrix_encoding(frame, matrix_encoding)) < 0)
-        return ret;
+        goto fail;
 
     /* AVDownmixInfo */
     if ((downmix_info = av_downmix_info_update_side_data(frame))) {
@@ -1820,8 +1911,24 @@ skip:
             downmix_info->lfe_mix_level       = gain_levels_lfe[s->lfe_mix_level];
         else
             downmix_info->lfe_mix_level       = 0.0; // -inf dB
-    } else
-        return AVERROR(ENOMEM);
+    } else {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    ff_thread_finish_setup(avctx);
+
+    if (!s->delay_final)
+        output_blocks(s, offset, blk);
+    ff_thread_report_progress(&s->frame, INT_MAX, 0);
+
+    for (ch = 0; ch < avctx->channels; ch++) {
+        int map = extended_channel_map[ch];
+        av_assert0(ch>=AV_NUM_DATA_POINTERS || frame->extended_data[ch] == frame->data[ch]);
+        memcpy((SHORTFLOAT *)frame->extended_data[ch],
+               s->output_buffer[map],
+               s->num_blocks * AC3_BLOCK_SIZE * sizeof(SHORTFLOAT));
+    }
 
     *got_frame_ptr = 1;
 
@@ -1829,8 +1936,60 @@ skip:
         return FFMIN(full_buf_size, s->frame_size + skip);
 
     return FFMIN(full_buf_size, s->superframe_size + skip);
+
+fail:
+    /* keep the delay line in sync with the decoded blocks */
+    if (!s->delay_final) {
+        output_blocks(s, offset, blk);
+        s->delay_final = 1;
+    }
+    ff_thread_release_buffer(avctx, &s->frame);
+    return ret;
 }
 
+#if HAVE_THREADS
+#define copy_fields(to, from, start_field, end_field)                   \
+    memcpy(&(to)->start_field, &(from)->start_field,                    \
+           (char *)&(to)->end_field - (char *)&(to)->start_field)
+
+static int ac3_update_thread_context(AVCodecContext *dst, const AVCodecContext *src)
+{
+    AC3DecodeContext *s = dst->priv_data;
+    const AC3DecodeContext *s1 = src->priv_data;
+    const ThreadFrame *prev_frame;
+    int ret;
+
+    if (dst == src)
+        return 0;
+
+    /* Bitstream state is kept across frames, e.g. for the dither generator,
+     * for error concealment and for E-AC-3 parameters a frame may omit. */
+    copy_fields(s, s1, frame_type, pre_mantissa);
+    copy_fields(s, s1, fbw_channels, downmix_coeffs);
+    copy_fields(s, s1, output_mode, imdct_512);
+
+    if (s1->downmix_coeffs[0]) {
+        if ((ret = alloc_downmix_coeffs(s)) < 0)
+            return ret;
+        memcpy(s->downmix_coeffs[0], s1->downmix_coeffs[0],
+               2 * AC3_MAX_CHANNELS * sizeof(**s->downmix_coeffs));
+    }
+
+    /* Continue the delay line of the last thread which writes to it, frames
+     * which failed before any output pass on the one they would have used. */
+    if (s1->frame.progress || s1->delay_final || !s1->prev) {
+        s->prev    = s1;
+        prev_frame = &s1->frame;
+    } else {
+        s->prev    = s1->prev;
+        prev_frame = &s1->prev_frame;
+    }
+    s->prev_frame.owner[0] = prev_frame->owner[0];
+    s->prev_frame.owner[1] = prev_frame->owner[1];
+    return av_buffer_replace(&s->prev_frame.progress, prev_frame->progress);
+}
+#endif
+
 /**
  * Uninitialize the AC-3 decoder.
  */
@@ -1841,6 +2000,8 @@ static av_cold int ac3_decode_end(AVCodecContext *avctx)
     ff_mdct_end(&s->imdct_256);
     av_freep(&s->fdsp);
     av_freep(&s->downmix_coeffs[0]);
+    av_buffer_unref(&s->frame.progress);
+    av_buffer_unref(&s->prev_frame.progress);
 
     return 0;
 }
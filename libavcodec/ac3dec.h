@@ -61,6 +61,7 @@
 #include "get_bits.h"
 #include "fft.h"
 #include "fmtconvert.h"
+#include "thread.h"
 
 #define AC3_OUTPUT_LFEON  8
 
@@ -224,6 +225,15 @@ typedef struct AC3DecodeContext {
     int block_switch[AC3_MAX_CHANNELS];     ///< block switch flags                     (blksw)
     FFTContext imdct_512;                   ///< for 512 sample IMDCT
     FFTContext imdct_256;                   ///< for 256 sample IMDCT
+    int block_switched[AC3_MAX_BLOCKS][AC3_MAX_CHANNELS]; ///< block switch flags of each decoded block
+    int different_transforms[AC3_MAX_BLOCKS];             ///< block mixes long and short transforms
+///@}
+
+///@name Frame threading
+    ThreadFrame frame;                      ///< output frame, reports when the delay line is final
+    ThreadFrame prev_frame;                 ///< frame of the thread holding the previous delay line
+    const struct AC3DecodeContext *prev;    ///< context to take the delay line from, NULL if it is our own
+    int delay_final;                        ///< delay line was already updated during frame setup
 ///@}
 
 ///@name Optimization
@@ -238,12 +248,13 @@ typedef struct AC3DecodeContext {
 ///@}
 
     SHORTFLOAT *outptr[AC3_MAX_CHANNELS];
-    INTFLOAT *xcfptr[AC3_MAX_CHANNELS];
     INTFLOAT *dlyptr[AC3_MAX_CHANNELS];
+    INTFLOAT (*transform_coeffs)[AC3_MAX_COEFS]; ///< transform coefficients of the block being decoded
 
 ///@name Aligned arrays
     DECLARE_ALIGNED(16, int,   fixed_coeffs)[AC3_MAX_CHANNELS][AC3_MAX_COEFS];       ///< fixed-point transform coefficients
-    DECLARE_ALIGNED(32, INTFLOAT, transform_coeffs)[AC3_MAX_CHANNELS][AC3_MAX_COEFS];   ///< transform coefficients
+    DECLARE_ALIGNED(32, INTFLOAT, block_coeffs)[AC3_MAX_BLOCKS][AC3_MAX_CHANNELS][AC3_MAX_COEFS]; ///< transform coefficients of each block
+    DECLARE_ALIGNED(32, FFTSample, imdct_output)[AC3_MAX_BLOCKS][AC3_MAX_CHANNELS][AC3_BLOCK_SIZE]; ///< IMDCT output of each block before windowing
     DECLARE_ALIGNED(32, INTFLOAT, delay)[EAC3_MAX_CHANNELS][AC3_BLOCK_SIZE];         ///< delay - added to the next block
     DECLARE_ALIGNED(32, INTFLOAT, window)[AC3_BLOCK_SIZE];                              ///< window coefficients
     DECLARE_ALIGNED(32, INTFLOAT, tmp_output)[AC3_BLOCK_SIZE];                          ///< temporary storage for output before windowing
@@ -31,10 +31,12 @@
 #include "get_bits.h"
 #include "unary.h"
 #include "mpeg4audio.h"
+#include "alsdsp.h"
 #include "bgmc.h"
 #include "bswapdsp.h"
 #include "internal.h"
 #include "mlz.h"
+#include "thread.h"
 #include "libavutil/samplefmt.h"
 #include "libavutil/crc.h"
 #include "libavutil/softfloat_ieee754.h"
@@ -195,6 +197,7 @@ typedef struct ALSDecContext {
     AVCodecContext *avctx;
     ALSSpecificConfig sconf;
     GetBitContext gb;
+    ALSDSPContext dsp;
     BswapDSPContext bdsp;
     const AVCRC *crc_table;
     uint32_t crc_org;               ///< CRC value of the original input data
@@ -237,6 +240,12 @@ typedef struct ALSDecContext {
     unsigned char *larray;          ///< buffer to store the output of masked lz decompression
     int *nbits;                     ///< contains the number of bits to read for masked lz decompression for all samples
     int highest_decoded_channel;
+    ThreadFrame frame;              ///< frame being decoded, reports when the state for the next frame is final
+    ThreadFrame prev_frame;         ///< frame of the thread holding the state of the previous frame
+    const struct ALSDecContext *prev; ///< context to take the state from, NULL if it is our own
+    int32_t *carry_buffer;          ///< copy of raw_buffer as left by the last frame, for frame threading
+    unsigned int carry_frame_id;    ///< frame_id as left by the last frame, for frame threading
+    unsigned int setup_frame_id;    ///< frame_id the next frame starts with if the current one decodes
 } ALSDecContext;
 
 
@@ -912,7 +921,6 @@ static int decode_var_block_data(ALSDecContext *ctx, ALSBlockData *bd)
     int32_t *quant_cof        = bd->quant_cof;
     int32_t *lpc_cof          = bd->lpc_cof;
     int32_t *raw_samples      = bd->raw_samples;
-    int32_t *raw_samples_end  = bd->raw_samples + bd->block_length;
     int32_t *lpc_cof_reversed = ctx->lpc_cof_reversed_buffer;
 
     // reverse long-term prediction
@@ -984,17 +992,9 @@ static int decode_var_block_data(ALSDecContext *ctx, ALSBlockData *bd)
         lpc_cof_reversed[sb] = lpc_cof[-(sb + 1)];
 
     // reconstruct raw samples
-    raw_samples = bd->raw_samples + smp;
-    lpc_cof     = lpc_cof_reversed + opt_order;
-
-    for (; raw_samples < raw_samples_end; raw_samples++) {
-        y = 1 << 19;
-
-        for (sb = -opt_order; sb < 0; sb++)
-            y += (uint64_t)MUL64(lpc_cof[sb], raw_samples[sb]);
-
-        *raw_samples -= y >> 20;
-    }
+    if (opt_order)
+        ctx->dsp.reconstruct(bd->raw_samples + smp, lpc_cof_reversed,
+                             opt_order, block_length - smp);
 
     raw_samples = bd->raw_samples;
 
@@ -1781,53 +1781,176 @@ static int read_frame_data(ALSDecContext *ctx, unsigned int ra_frame)
 }
 
 
+/** Set up the length of the current frame from the frame ID and return
+ *  whether it is a random access frame.
+ */
+static unsigned int init_frame_params(ALSDecContext *ctx)
+{
+    ALSSpecificConfig *sconf = &ctx->sconf;
+
+    // the last frame to decode might have a different length
+    if (sconf->samples != 0xFFFFFFFF)
+        ctx->cur_frame_length = FFMIN(sconf->samples - ctx->frame_id * (uint64_t) sconf->frame_length,
+                                      sconf->frame_length);
+    else
+        ctx->cur_frame_length = sconf->frame_length;
+
+    // In the case that the distance between random access frames is set to zero
+    // (sconf->ra_distance == 0) no frame is treated as a random access frame.
+    // For the first frame, if prediction is used, all samples used from the
+    // previous frame are assumed to be zero.
+    return sconf->ra_distance && !(ctx->frame_id % sconf->ra_distance);
+}
+
+
+/** Take over the state the previous frame left in the context of the
+ *  frame thread which decoded it: the frame ID, the CRC and, if samples is
+ *  set, the sample history and the floating-point state.
+ */
+static void take_over_state(ALSDecContext *ctx, int samples)
+{
+    const ALSDecContext *prev = ctx->prev;
+    AVCodecContext *avctx     = ctx->avctx;
+    ALSSpecificConfig *sconf  = &ctx->sconf;
+    int c;
+
+    if (!prev)
+        return;
+
+    ff_thread_await_progress(&ctx->prev_frame, INT_MAX, 0);
+
+    ctx->frame_id = prev->carry_frame_id;
+    ctx->crc      = prev->crc;
+
+    if (samples) {
+        memcpy(ctx->raw_buffer, prev->carry_buffer,
+               avctx->channels * (sconf->frame_length + sconf->max_order) *
+               sizeof(*ctx->raw_buffer));
+
+        if (sconf->floating) {
+            MLZDict *dict = ctx->mlz->dict;
+
+            *ctx->mlz         = *prev->mlz;
+            ctx->mlz->dict    = dict;
+            ctx->mlz->context = avctx;
+            memcpy(dict, prev->mlz->dict, TABLE_SIZE * sizeof(*dict));
+            memcpy(ctx->last_shift_value, prev->last_shift_value,
+                   avctx->channels * sizeof(*ctx->last_shift_value));
+            memcpy(ctx->last_acf_mantissa, prev->last_acf_mantissa,
+                   avctx->channels * sizeof(*ctx->last_acf_mantissa));
+            for (c = 0; c < avctx->channels; c++)
+                memcpy(ctx->raw_mantissa[c], prev->raw_mantissa[c],
+                       sconf->frame_length * sizeof(**ctx->raw_mantissa));
+        }
+    }
+
+    ctx->prev = NULL;
+}
+
+
+/** Make the state left by the current frame available to the frame thread
+ *  decoding the next one.
+ */
+static void pass_on_state(ALSDecContext *ctx)
+{
+    ALSSpecificConfig *sconf = &ctx->sconf;
+
+    if (ctx->carry_buffer)
+        memcpy(ctx->carry_buffer, ctx->raw_buffer,
+               ctx->avctx->channels * (sconf->frame_length + sconf->max_order) *
+               sizeof(*ctx->raw_buffer));
+    ctx->carry_frame_id = ctx->frame_id;
+
+    ff_thread_report_progress(&ctx->frame, INT_MAX, 0);
+}
+
+
+/** Read the frame data on top of the state of the previous frame.
+ *  The frame is set up assuming that the previous frame decodes. Integer
+ *  random access frames do not depend on the state, so they are read without
+ *  waiting for the previous frame thread. Only if such a frame turns out to be
+ *  damaged or short, which leaves parts of the sample buffer to the previous
+ *  frame, or if the previous frame failed, which shifts the frame ID, it is
+ *  read again after taking over the state.
+ */
+static int decode_frame_data(ALSDecContext *ctx, AVPacket *avpkt,
+                             unsigned int *ra_frame)
+{
+    int ret;
+
+    if (!*ra_frame || ctx->sconf.floating) {
+        take_over_state(ctx, 1);
+        *ra_frame = init_frame_params(ctx);
+    }
+
+    ctx->highest_decoded_channel = -1;
+    ret = read_frame_data(ctx, *ra_frame);
+
+    if (ctx->prev) {
+        ff_thread_await_progress(&ctx->prev_frame, INT_MAX, 0);
+        if (ret < 0 || ctx->highest_decoded_channel == -1 ||
+            ctx->cur_frame_length != ctx->sconf.frame_length ||
+            ctx->frame_id != ctx->prev->carry_frame_id) {
+            take_over_state(ctx, 1);
+            *ra_frame = init_frame_params(ctx);
+            init_get_bits8(&ctx->gb, avpkt->data, avpkt->size);
+            ctx->highest_decoded_channel = -1;
+            ret = read_frame_data(ctx, *ra_frame);
+        }
+    }
+
+    take_over_state(ctx, 0);
+
+    return ret;
+}
+
+
 /** Decode an ALS frame.
  */
 static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame_ptr,
                         AVPacket *avpkt)
 {
     ALSDecContext *ctx       = avctx->priv_data;
-    AVFrame *frame           = data;
+    AVFrame *frame           = ctx->frame.f;
     ALSSpecificConfig *sconf = &ctx->sconf;
     const uint8_t *buffer    = avpkt->data;
     int buffer_size          = avpkt->size;
     int invalid_frame, ret;
     unsigned int c, sample, ra_frame, bytes_read, shift;
 
+    ff_thread_release_buffer(avctx, &ctx->frame);
+
+    ctx->setup_frame_id = ctx->frame_id;
+
     if ((ret = init_get_bits8(&ctx->gb, buffer, buffer_size)) < 0)
         return ret;
 
-    // In the case that the distance between random access frames is set to zero
-    // (sconf->ra_distance == 0) no frame is treated as a random access frame.
-    // For the first frame, if prediction is used, all samples used from the
-    // previous frame are assumed to be zero.
-    ra_frame = sconf->ra_distance && !(ctx->frame_id % sconf->ra_distance);
+    ra_frame = init_frame_params(ctx);
 
-    // the last frame to decode might have a different length
-    if (sconf->samples != 0xFFFFFFFF)
-        ctx->cur_frame_length = FFMIN(sconf->samples - ctx->frame_id * (uint64_t) sconf->frame_length,
-                                      sconf->frame_length);
-    else
-        ctx->cur_frame_length = sconf->frame_length;
+    /* get output buffer, the frame length is only final once the frame
+     * threads before have decoded */
+    frame->nb_samples = avctx->active_thread_type & FF_THREAD_FRAME ?
+                        sconf->frame_length : ctx->cur_frame_length;
+    if ((ret = ff_thread_get_buffer(avctx, &ctx->frame, 0)) < 0)
+        return ret;
+
+    ctx->setup_frame_id = ctx->frame_id + 1;
+    ff_thread_finish_setup(avctx);
 
-    ctx->highest_decoded_channel = -1;
     // decode the frame data
-    if ((invalid_frame = read_frame_data(ctx, ra_frame)) < 0)
+    if ((invalid_frame = decode_frame_data(ctx, avpkt, &ra_frame)) < 0)
         av_log(ctx->avctx, AV_LOG_WARNING,
                "Reading frame data failed. Skipping RA unit.\n");
 
     if (ctx->highest_decoded_channel == -1) {
         av_log(ctx->avctx, AV_LOG_WARNING,
                "No channel data decoded.\n");
-        return AVERROR_INVALIDDATA;
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
     }
 
     ctx->frame_id++;
-
-    /* get output buffer */
     frame->nb_samples = ctx->cur_frame_length;
-    if ((ret = ff_get_buffer(avctx, frame, 0)) < 0)
-        return ret;
 
     // transform decoded frame into output format
     #define INTERLEAVE_OUTPUT(bps)                                                   \
@@ -1906,17 +2029,27 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame_ptr,
         if (ctx->cur_frame_length != sconf->frame_length &&
             ctx->crc_org != ctx->crc) {
             av_log(avctx, AV_LOG_ERROR, "CRC error.\n");
-            if (avctx->err_recognition & AV_EF_EXPLODE)
-                return AVERROR_INVALIDDATA;
+            if (avctx->err_recognition & AV_EF_EXPLODE) {
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
+            }
         }
     }
 
+    pass_on_state(ctx);
+
+    if ((ret = av_frame_ref(data, frame)) < 0)
+        return ret;
     *got_frame_ptr = 1;
 
     bytes_read = invalid_frame ? buffer_size :
                                  (get_bits_count(&ctx->gb) + 7) >> 3;
 
     return bytes_read;
+
+fail:
+    pass_on_state(ctx);
+    return ret;
 }
 
 
@@ -1929,6 +2062,12 @@ static av_cold int decode_end(AVCodecContext *avctx)
 
     av_freep(&ctx->sconf.chan_pos);
 
+    if (ctx->frame.f)
+        ff_thread_release_buffer(avctx, &ctx->frame);
+    av_frame_free(&ctx->frame.f);
+    av_buffer_unref(&ctx->prev_frame.progress);
+    av_freep(&ctx->carry_buffer);
+
     ff_bgmc_end(&ctx->bgmc_lut, &ctx->bgmc_lut_status);
 
     av_freep(&ctx->const_block);
@@ -2156,7 +2295,24 @@ static av_cold int decode_init(AVCodecContext *avctx)
         }
     }
 
+    // allocate the buffers passing the state on between frame threads
+    ctx->frame.f = av_frame_alloc();
+    if (!ctx->frame.f) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    if (avctx->active_thread_type & FF_THREAD_FRAME) {
+        ctx->carry_buffer = av_calloc(avctx->channels * channel_size,
+                                      sizeof(*ctx->carry_buffer));
+        if (!ctx->carry_buffer) {
+            av_log(avctx, AV_LOG_ERROR, "Allocating buffer memory failed.\n");
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
     ff_bswapdsp_init(&ctx->bdsp);
+    ff_alsdsp_init(&ctx->dsp);
 
     return 0;
 
@@ -2171,10 +2327,46 @@ static av_cold void flush(AVCodecContext *avctx)
 {
     ALSDecContext *ctx = avctx->priv_data;
 
-    ctx->frame_id = 0;
+    ctx->frame_id       = 0;
+    ctx->carry_frame_id = 0;
+    ctx->setup_frame_id = 0;
+    ctx->prev           = NULL;
+    av_buffer_unref(&ctx->prev_frame.progress);
 }
 
 
+#if HAVE_THREADS
+static int update_thread_context(AVCodecContext *dst, const AVCodecContext *src)
+{
+    ALSDecContext *ctx        = dst->priv_data;
+    const ALSDecContext *ctx1 = src->priv_data;
+    const ThreadFrame *prev_frame;
+
+    if (dst == src)
+        return 0;
+
+    if (ctx1->frame.progress || !ctx1->prev) {
+        ctx->prev  = ctx1;
+        prev_frame = &ctx1->frame;
+    } else if (ctx1->prev == ctx) {
+        // a thread which failed before decoding anything passes on its own
+        // source, here our own state, as we decoded the frame before it
+        ctx->prev = NULL;
+        av_buffer_unref(&ctx->prev_frame.progress);
+        return 0;
+    } else {
+        ctx->prev  = ctx1->prev;
+        prev_frame = &ctx1->prev_frame;
+    }
+    ctx->frame_id = ctx1->setup_frame_id;
+    ctx->prev_frame.owner[0] = prev_frame->owner[0];
+    ctx->prev_frame.owner[1] = prev_frame->owner[1];
+
+    return av_buffer_replace(&ctx->prev_frame.progress, prev_frame->progress);
+}
+#endif
+
+
 const AVCodec ff_als_decoder = {
     .name           = "als",
     .long_name      = NULL_IF_CONFIG_SMALL("MPEG-4 Audio Lossless Coding (ALS)"),
@@ -2185,6 +2377,8 @@ const AVCodec ff_als_decoder = {
     .close          = decode_end,
     .decode         = decode_frame,
     .flush          = flush,
-    .capabilities   = AV_CODEC_CAP_SUBFRAMES | AV_CODEC_CAP_DR1 | AV_CODEC_CAP_CHANNEL_CONF,
-    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(update_thread_context),
+    .capabilities   = AV_CODEC_CAP_SUBFRAMES | AV_CODEC_CAP_DR1 | AV_CODEC_CAP_CHANNEL_CONF |
+                      AV_CODEC_CAP_FRAME_THREADS,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP | FF_CODEC_CAP_ALLOCATE_PROGRESS,
 };
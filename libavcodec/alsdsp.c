@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "alsdsp.h"
+#include "mathops.h"
+
+static void reconstruct_c(int32_t *samples, const int32_t *coeffs,
+                          int order, int len)
+{
+    int i, j;
+
+    for (i = 0; i < len; i++) {
+        int64_t y = 1 << 19;
+
+        for (j = 0; j < order; j++)
+            y += (uint64_t)MUL64(coeffs[j], samples[i - order + j]);
+
+        samples[i] -= y >> 20;
+    }
+}
+
+av_cold void ff_alsdsp_init(ALSDSPContext *c)
+{
+    c->reconstruct = reconstruct_c;
+}
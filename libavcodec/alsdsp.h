@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_ALSDSP_H
+#define AVCODEC_ALSDSP_H
+
+#include <stdint.h>
+
+typedef struct ALSDSPContext {
+    /**
+     * Reconstruct samples from their short-term prediction residual.
+     *
+     * @param samples residuals to be replaced by the reconstructed samples,
+     *                preceded by at least order reconstructed samples
+     * @param coeffs  direct form predictor coefficients in reverse order,
+     *                coeffs[order - 1] is applied to samples[-1]
+     * @param order   prediction order, at least 1
+     * @param len     number of samples to reconstruct
+     */
+    void (*reconstruct)(int32_t *samples, const int32_t *coeffs,
+                        int order, int len);
+} ALSDSPContext;
+
+void ff_alsdsp_init(ALSDSPContext *c);
+
+#endif /* AVCODEC_ALSDSP_H */
@@ -455,12 +455,13 @@ av_cold int avcodec_close(AVCodecContext *avctx)
             avci->frame_thread_encoder && avctx->thread_count > 1) {
             ff_frame_thread_encoder_free(avctx);
         }
-        if (HAVE_THREADS && avci->thread_ctx)
+        if (HAVE_THREADS && (avci->thread_ctx || avci->slice_thread_ctx))
             ff_thread_free(avctx);
         if (avci->needs_close && avctx->codec->close)
             avctx->codec->close(avctx);
         avci->byte_buffer_size = 0;
         av_freep(&avci->byte_buffer);
+        avpriv_packet_pool_uninit(&avci->packet_pool);
         av_frame_free(&avci->buffer_frame);
         av_packet_free(&avci->buffer_pkt);
         if (avci->pkt_props) {
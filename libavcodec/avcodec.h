@@ -354,6 +354,13 @@ typedef struct RcOverride{
  * Do not apply film grain, export it instead.
  */
 #define AV_CODEC_EXPORT_DATA_FILM_GRAIN (1 << 3)
+/**
+ * Decoding only.
+ * Export per-frame decoding latency of frame threading through the
+ * "lavc.decode_latency" and "lavc.output_latency" frame metadata entries,
+ * in microseconds.
+ */
+#define AV_CODEC_EXPORT_DATA_FRAME_LATENCY (1 << 4)
 
 /**
  * The decoder will keep a reference to the frame and may reuse it later.
@@ -1450,6 +1457,7 @@ typedef struct AVCodecContext {
     int thread_type;
 #define FF_THREAD_FRAME   1 ///< Decode more than one frame at once
 #define FF_THREAD_SLICE   2 ///< Decode more than one part of a single frame at once
+#define FF_THREAD_SHARED  4 ///< Run the slice threads on the process-wide shared worker pool
 
     /**
      * Which multithreading methods are in use by the codec.
@@ -2024,6 +2032,19 @@ typedef struct AVCodecContext {
      * - decoding: unused
      */
     int (*get_encode_buffer)(struct AVCodecContext *s, AVPacket *pkt, int flags);
+
+    /**
+     * Maximum number of frames decoded at the same time by frame threading.
+     * When set, frame threading runs in low-delay mode: a frame is returned
+     * once this many packets are being decoded, i.e. after a fixed delay of
+     * max_frames_in_flight - 1 frames instead of thread_count - 1 frames.
+     * The output does not depend on the thread count or timing.
+     * 0 disables the low-delay mode.
+     *
+     * - encoding: unused
+     * - decoding: Set by user.
+     */
+    int max_frames_in_flight;
 } AVCodecContext;
 
 struct MpegEncContext;
@@ -96,6 +96,39 @@ static int packet_alloc(AVBufferRef **buf, int size)
     return 0;
 }
 
+AVBufferRef *avpriv_packet_pool_get(PacketPool *pool, int size)
+{
+    AVBufferRef *buf;
+    int index;
+
+    if (size < 0 || size >= INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
+        return NULL;
+
+    index = av_log2(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (index >= FF_ARRAY_ELEMS(pool->pools)) {
+        buf = av_buffer_alloc(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    } else {
+        if (!pool->pools[index]) {
+            pool->pools[index] = av_buffer_pool_init(2 << index, NULL);
+            if (!pool->pools[index])
+                return NULL;
+        }
+        buf = av_buffer_pool_get(pool->pools[index]);
+    }
+    if (!buf)
+        return NULL;
+
+    memset(buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    return buf;
+}
+
+void avpriv_packet_pool_uninit(PacketPool *pool)
+{
+    for (int i = 0; i < FF_ARRAY_ELEMS(pool->pools); i++)
+        av_buffer_pool_uninit(&pool->pools[i]);
+}
+
 int av_new_packet(AVPacket *pkt, int size)
 {
     AVBufferRef *buf = NULL;
@@ -404,21 +437,36 @@ int av_packet_copy_props(AVPacket *dst, const AVPacket *src)
     if (ret < 0)
         return ret;
 
+    if (!src->side_data_elems)
+        return 0;
+
+    // Allocate the whole array at once rather than growing it per entry.
+    dst->side_data = av_malloc_array(src->side_data_elems,
+                                     sizeof(*dst->side_data));
+    if (!dst->side_data)
+        goto fail;
+
     for (i = 0; i < src->side_data_elems; i++) {
-        enum AVPacketSideDataType type = src->side_data[i].type;
-        size_t size = src->side_data[i].size;
-        uint8_t *src_data = src->side_data[i].data;
-        uint8_t *dst_data = av_packet_new_side_data(dst, type, size);
-
-        if (!dst_data) {
-            av_buffer_unref(&dst->opaque_ref);
-            av_packet_free_side_data(dst);
-            return AVERROR(ENOMEM);
-        }
-        memcpy(dst_data, src_data, size);
+        const AVPacketSideData *src_sd = &src->side_data[i];
+        AVPacketSideData       *dst_sd = &dst->side_data[i];
+
+        if (src_sd->size > SIZE_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
+            goto fail;
+        dst_sd->data = av_malloc(src_sd->size + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!dst_sd->data)
+            goto fail;
+        memcpy(dst_sd->data, src_sd->data, src_sd->size);
+        memset(dst_sd->data + src_sd->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        dst_sd->size = src_sd->size;
+        dst_sd->type = src_sd->type;
+        dst->side_data_elems++;
     }
 
     return 0;
+fail:
+    av_buffer_unref(&dst->opaque_ref);
+    av_packet_free_side_data(dst);
+    return AVERROR(ENOMEM);
 }
 
 void av_packet_unref(AVPacket *pkt)
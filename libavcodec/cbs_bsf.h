@@ -57,6 +57,14 @@ typedef struct CBSBSFContext {
     CodedBitstreamContext *input;
     CodedBitstreamContext *output;
     CodedBitstreamFragment fragment;
+
+    // Unit types which the update_fragment() function needs to inspect
+    // or modify.  If set before ff_cbs_bsf_generic_init(), only these
+    // units are decomposed on input; all other units are left as raw
+    // data and passed through to the output untouched.  If NULL, all
+    // units are decomposed.
+    const CodedBitstreamUnitType *decompose_unit_types;
+    int nb_decompose_unit_types;
 } CBSBSFContext;
 
 /**
@@ -1237,12 +1237,33 @@ static int cbs_h2645_unit_requires_zero_byte(enum AVCodecID codec_id,
     return 0;
 }
 
+static size_t cbs_h2645_find_zero_pair(const uint8_t *src, size_t size)
+{
+    size_t i = 0;
+
+    while (i + 1 < size) {
+#if HAVE_FAST_UNALIGNED && HAVE_FAST_64BIT
+        if (i + 8 <= size) {
+            uint64_t v = AV_RN64(src + i);
+            if (!((v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        if (!src[i] && !src[i + 1])
+            return i;
+        i++;
+    }
+    return size;
+}
+
 static int cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
                                        CodedBitstreamFragment *frag)
 {
     uint8_t *data;
     size_t max_size, dp, sp;
-    int err, i, zero_run;
+    int err, i;
 
     for (i = 0; i < frag->nb_units; i++) {
         // Data should already all have been written when we get here.
@@ -1280,21 +1301,21 @@ static int cbs_h2645_assemble_fragment(CodedBitstreamContext *ctx,
         data[dp++] = 0;
         data[dp++] = 1;
 
-        zero_run = 0;
-        for (sp = 0; sp < unit->data_size; sp++) {
-            if (zero_run < 2) {
-                if (unit->data[sp] == 0)
-                    ++zero_run;
-                else
-                    zero_run = 0;
-            } else {
-                if ((unit->data[sp] & ~3) == 0) {
-                    // emulation_prevention_three_byte
-                    data[dp++] = 3;
-                }
-                zero_run = unit->data[sp] == 0;
+        // Only a byte following two zero bytes can need escaping, so
+        // everything up to and including such a pair is copied as is.
+        sp = 0;
+        while (sp < unit->data_size) {
+            size_t run = cbs_h2645_find_zero_pair(unit->data + sp,
+                                                  unit->data_size - sp);
+            run = FFMIN(run + 2, unit->data_size - sp);
+            memcpy(data + dp, unit->data + sp, run);
+            dp += run;
+            sp += run;
+
+            if (sp < unit->data_size && (unit->data[sp] & ~3) == 0) {
+                // emulation_prevention_three_byte
+                data[dp++] = 3;
             }
-            data[dp++] = unit->data[sp];
         }
     }
 
@@ -440,17 +440,18 @@ static int chs_alloc_lsb_band_data(DCAXllDecoder *s, DCAXllChSet *c)
     return 0;
 }
 
-static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int seg, int band_data_end)
+static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, GetBitContext *gb,
+                               int band, int seg, int band_data_end)
 {
     DCAXllBand *b = &c->bands[band];
     int i, j, k;
 
     // Start unpacking MSB portion of the segment
-    if (!(seg && get_bits1(&s->gb))) {
+    if (!(seg && get_bits1(gb))) {
         // Unpack segment type
         // 0 - distinct coding parameters for each channel
         // 1 - common coding parameters for all channels
-        c->seg_common = get_bits1(&s->gb);
+        c->seg_common = get_bits1(gb);
 
         // Determine number of coding parameters encoded in segment
         k = c->seg_common ? 1 : c->nchannels;
@@ -459,12 +460,12 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
         for (i = 0; i < k; i++) {
             // Unpack Rice coding flag
             // 0 - linear code, 1 - Rice code
-            c->rice_code_flag[i] = get_bits1(&s->gb);
+            c->rice_code_flag[i] = get_bits1(gb);
             // Unpack Hybrid Rice coding flag
             // 0 - Rice code, 1 - Hybrid Rice code
-            if (!c->seg_common && c->rice_code_flag[i] && get_bits1(&s->gb))
+            if (!c->seg_common && c->rice_code_flag[i] && get_bits1(gb))
                 // Unpack binary code length for isolated samples
-                c->bitalloc_hybrid_linear[i] = get_bits(&s->gb, c->nabits) + 1;
+                c->bitalloc_hybrid_linear[i] = get_bits(gb, c->nabits) + 1;
             else
                 // 0 indicates no Hybrid Rice coding
                 c->bitalloc_hybrid_linear[i] = 0;
@@ -474,7 +475,7 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
         for (i = 0; i < k; i++) {
             if (seg == 0) {
                 // Unpack coding parameter for part A of segment 0
-                c->bitalloc_part_a[i] = get_bits(&s->gb, c->nabits);
+                c->bitalloc_part_a[i] = get_bits(gb, c->nabits);
 
                 // Adjust for the linear code
                 if (!c->rice_code_flag[i] && c->bitalloc_part_a[i])
@@ -490,7 +491,7 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
             }
 
             // Unpack coding parameter for part B of segment
-            c->bitalloc_part_b[i] = get_bits(&s->gb, c->nabits);
+            c->bitalloc_part_b[i] = get_bits(gb, c->nabits);
 
             // Adjust for the linear code
             if (!c->rice_code_flag[i] && c->bitalloc_part_b[i])
@@ -511,35 +512,35 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
         part_b = part_a + c->nsamples_part_a[k];
         nsamples_part_b = s->nsegsamples - c->nsamples_part_a[k];
 
-        if (get_bits_left(&s->gb) < 0)
+        if (get_bits_left(gb) < 0)
             return AVERROR_INVALIDDATA;
 
         if (!c->rice_code_flag[k]) {
             // Linear codes
             // Unpack all residuals of part A of segment 0
-            get_linear_array(&s->gb, part_a, c->nsamples_part_a[k],
+            get_linear_array(gb, part_a, c->nsamples_part_a[k],
                              c->bitalloc_part_a[k]);
 
             // Unpack all residuals of part B of segment 0 and others
-            get_linear_array(&s->gb, part_b, nsamples_part_b,
+            get_linear_array(gb, part_b, nsamples_part_b,
                              c->bitalloc_part_b[k]);
         } else {
             // Rice codes
             // Unpack all residuals of part A of segment 0
-            get_rice_array(&s->gb, part_a, c->nsamples_part_a[k],
+            get_rice_array(gb, part_a, c->nsamples_part_a[k],
                            c->bitalloc_part_a[k]);
 
             if (c->bitalloc_hybrid_linear[k]) {
                 // Hybrid Rice codes
                 // Unpack the number of isolated samples
-                int nisosamples = get_bits(&s->gb, s->nsegsamples_log2);
+                int nisosamples = get_bits(gb, s->nsegsamples_log2);
 
                 // Set all locations to 0
                 memset(part_b, 0, sizeof(*part_b) * nsamples_part_b);
 
                 // Extract the locations of isolated samples and flag by -1
                 for (j = 0; j < nisosamples; j++) {
-                    int loc = get_bits(&s->gb, s->nsegsamples_log2);
+                    int loc = get_bits(gb, s->nsegsamples_log2);
                     if (loc >= nsamples_part_b) {
                         av_log(s->avctx, AV_LOG_ERROR, "Invalid isolated sample location\n");
                         return AVERROR_INVALIDDATA;
@@ -550,30 +551,30 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
                 // Unpack all residuals of part B of segment 0 and others
                 for (j = 0; j < nsamples_part_b; j++) {
                     if (part_b[j])
-                        part_b[j] = get_linear(&s->gb, c->bitalloc_hybrid_linear[k]);
+                        part_b[j] = get_linear(gb, c->bitalloc_hybrid_linear[k]);
                     else
-                        part_b[j] = get_rice(&s->gb, c->bitalloc_part_b[k]);
+                        part_b[j] = get_rice(gb, c->bitalloc_part_b[k]);
                 }
             } else {
                 // Rice codes
                 // Unpack all residuals of part B of segment 0 and others
-                get_rice_array(&s->gb, part_b, nsamples_part_b, c->bitalloc_part_b[k]);
+                get_rice_array(gb, part_b, nsamples_part_b, c->bitalloc_part_b[k]);
             }
         }
     }
 
     // Unpack decimator history for frequency band 1
     if (seg == 0 && band == 1) {
-        int nbits = get_bits(&s->gb, 5) + 1;
+        int nbits = get_bits(gb, 5) + 1;
         for (i = 0; i < c->nchannels; i++)
             for (j = 1; j < DCA_XLL_DECI_HISTORY_MAX; j++)
-                c->deci_history[i][j] = get_sbits_long(&s->gb, nbits);
+                c->deci_history[i][j] = get_sbits_long(gb, nbits);
     }
 
     // Start unpacking LSB portion of the segment
     if (b->lsb_section_size) {
         // Skip to the start of LSB portion
-        if (ff_dca_seek_bits(&s->gb, band_data_end - b->lsb_section_size * 8)) {
+        if (ff_dca_seek_bits(gb, band_data_end - b->lsb_section_size * 8)) {
             av_log(s->avctx, AV_LOG_ERROR, "Read past end of XLL band data\n");
             return AVERROR_INVALIDDATA;
         }
@@ -581,7 +582,7 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
         // Unpack all LSB parts of residuals of this segment
         for (i = 0; i < c->nchannels; i++) {
             if (b->nscalablelsbs[i]) {
-                get_array(&s->gb,
+                get_array(gb,
                           b->lsb_sample_buffer[i] + seg * s->nsegsamples,
                           s->nsegsamples, b->nscalablelsbs[i]);
             }
@@ -589,7 +590,7 @@ static int chs_parse_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int s
     }
 
     // Skip to the end of band data
-    if (ff_dca_seek_bits(&s->gb, band_data_end)) {
+    if (ff_dca_seek_bits(gb, band_data_end)) {
         av_log(s->avctx, AV_LOG_ERROR, "Read past end of XLL band data\n");
         return AVERROR_INVALIDDATA;
     }
@@ -683,11 +684,6 @@ static void chs_filter_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band)
         for (i = 0; i < c->nchannels; i++)
             b->msb_sample_buffer[b->orig_order[i]] = tmp[i];
     }
-
-    // Map output channel pointers for frequency band 0
-    if (c->nfreqbands == 1)
-        for (i = 0; i < c->nchannels; i++)
-            s->output_samples[c->ch_remap[i]] = b->msb_sample_buffer[i];
 }
 
 static int chs_get_lsb_width(DCAXllDecoder *s, DCAXllChSet *c, int band, int ch)
@@ -727,8 +723,10 @@ static void chs_assemble_msbs_lsbs(DCAXllDecoder *s, DCAXllChSet *c, int band)
     }
 }
 
-static int chs_assemble_freq_bands(DCAXllDecoder *s, DCAXllChSet *c)
+static int chs_assemble_freq_bands(AVCodecContext *avctx, void *arg, int chs, int threadnr)
 {
+    DCAXllDecoder *s = arg;
+    DCAXllChSet *c = &s->chset[chs];
     int ch, nsamples = s->nframesamples;
     int32_t *ptr;
 
@@ -754,9 +752,6 @@ static int chs_assemble_freq_bands(DCAXllDecoder *s, DCAXllChSet *c)
         s->dcadsp->assemble_freq_bands(ptr, band0, band1,
                                        ff_dca_xll_band_coeff,
                                        nsamples);
-
-        // Remap output channel pointer to assembly buffer
-        s->output_samples[c->ch_remap[ch]] = ptr;
         ptr += nsamples * 2;
     }
 
@@ -1000,9 +995,43 @@ static int parse_navi_table(DCAXllDecoder *s)
     return 0;
 }
 
+static int chs_parse_frame_data(AVCodecContext *avctx, void *arg, int chs, int threadnr)
+{
+    DCAXllDecoder *s = arg;
+    DCAXllChSet *c = &s->chset[chs];
+    GetBitContext gb = s->gb;
+    int ret, i, seg, band, navi_pos = get_bits_count(&s->gb);
+    const int *navi_ptr = s->navi;
+
+    // Every channel set is coded in its own segments, so locate them through
+    // the NAVI table and unpack them independently of the other sets
+    for (band = 0; band < s->nfreqbands; band++) {
+        for (seg = 0; seg < s->nframesegs; seg++) {
+            for (i = 0; i < chs; i++)
+                navi_pos += *navi_ptr++ * 8;
+
+            if (c->nfreqbands > band) {
+                int band_data_end = navi_pos + *navi_ptr * 8;
+                skip_bits_long(&gb, navi_pos - get_bits_count(&gb));
+                if ((ret = chs_parse_band_data(s, c, &gb, band, seg, band_data_end)) < 0) {
+                    if (avctx->err_recognition & AV_EF_EXPLODE)
+                        return ret;
+                    chs_clear_band_data(s, c, band, seg);
+                }
+            }
+
+            for (; i < s->nchsets; i++)
+                navi_pos += *navi_ptr++ * 8;
+        }
+    }
+
+    return 0;
+}
+
 static int parse_band_data(DCAXllDecoder *s)
 {
-    int ret, chs, seg, band, navi_pos, *navi_ptr;
+    int ret, chs, navi_pos, navi_nb = s->nfreqbands * s->nframesegs * s->nchsets;
+    int chs_ret[DCA_XLL_CHSETS_MAX];
     DCAXllChSet *c;
 
     for (chs = 0, c = s->chset; chs < s->nactivechsets; chs++, c++) {
@@ -1013,29 +1042,20 @@ static int parse_band_data(DCAXllDecoder *s)
     }
 
     navi_pos = get_bits_count(&s->gb);
-    navi_ptr = s->navi;
-    for (band = 0; band < s->nfreqbands; band++) {
-        for (seg = 0; seg < s->nframesegs; seg++) {
-            for (chs = 0, c = s->chset; chs < s->nchsets; chs++, c++) {
-                if (c->nfreqbands > band) {
-                    navi_pos += *navi_ptr * 8;
-                    if (navi_pos > s->gb.size_in_bits) {
-                        av_log(s->avctx, AV_LOG_ERROR, "Invalid NAVI position\n");
-                        return AVERROR_INVALIDDATA;
-                    }
-                    if (chs < s->nactivechsets &&
-                        (ret = chs_parse_band_data(s, c, band, seg, navi_pos)) < 0) {
-                        if (s->avctx->err_recognition & AV_EF_EXPLODE)
-                            return ret;
-                        chs_clear_band_data(s, c, band, seg);
-                    }
-                    skip_bits_long(&s->gb, navi_pos - get_bits_count(&s->gb));
-                }
-                navi_ptr++;
-            }
+    for (chs = 0; chs < navi_nb; chs++) {
+        navi_pos += s->navi[chs] * 8;
+        if (navi_pos > s->gb.size_in_bits) {
+            av_log(s->avctx, AV_LOG_ERROR, "Invalid NAVI position\n");
+            return AVERROR_INVALIDDATA;
         }
     }
 
+    s->avctx->execute2(s->avctx, chs_parse_frame_data, s, chs_ret, s->nactivechsets);
+    for (chs = 0; chs < s->nactivechsets; chs++)
+        if (chs_ret[chs] < 0)
+            return chs_ret[chs];
+
+    skip_bits_long(&s->gb, navi_pos - get_bits_count(&s->gb));
     return 0;
 }
 
@@ -1320,6 +1340,29 @@ static int combine_residual_frame(DCAXllDecoder *s, DCAXllChSet *c)
     return 0;
 }
 
+static int chs_filter_frame_data(AVCodecContext *avctx, void *arg, int chs, int threadnr)
+{
+    DCAXllDecoder *s = arg;
+    DCAXllChSet *c = &s->chset[chs];
+    int ret;
+
+    chs_filter_band_data(s, c, 0);
+
+    if (c->residual_encode != (1 << c->nchannels) - 1
+        && (ret = combine_residual_frame(s, c)) < 0)
+        return ret;
+
+    if (s->scalable_lsbs)
+        chs_assemble_msbs_lsbs(s, c, 0);
+
+    if (c->nfreqbands > 1) {
+        chs_filter_band_data(s, c, 1);
+        chs_assemble_msbs_lsbs(s, c, 1);
+    }
+
+    return 0;
+}
+
 int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
 {
     AVCodecContext *avctx = s->avctx;
@@ -1328,7 +1371,7 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
     DCAXllChSet *p = &s->chset[0], *c;
     enum AVMatrixEncoding matrix_encoding = AV_MATRIX_ENCODING_NONE;
     int i, j, k, ret, shift, nsamples, request_mask;
-    int ch_remap[DCA_SPEAKER_COUNT];
+    int ch_remap[DCA_SPEAKER_COUNT], chs_ret[DCA_XLL_CHSETS_MAX];
 
     // Force lossy downmixed output during recovery
     if (dca->packet & DCA_PACKET_RECOVERY) {
@@ -1345,21 +1388,17 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
     }
 
     // Filter frequency bands for active channel sets
+    avctx->execute2(avctx, chs_filter_frame_data, s, chs_ret, s->nactivechsets);
+
     s->output_mask = 0;
     for (i = 0, c = s->chset; i < s->nactivechsets; i++, c++) {
-        chs_filter_band_data(s, c, 0);
-
-        if (c->residual_encode != (1 << c->nchannels) - 1
-            && (ret = combine_residual_frame(s, c)) < 0)
-            return ret;
-
-        if (s->scalable_lsbs)
-            chs_assemble_msbs_lsbs(s, c, 0);
+        if (chs_ret[i] < 0)
+            return chs_ret[i];
 
-        if (c->nfreqbands > 1) {
-            chs_filter_band_data(s, c, 1);
-            chs_assemble_msbs_lsbs(s, c, 1);
-        }
+        // Map output channel pointers for frequency band 0
+        if (c->nfreqbands == 1)
+            for (j = 0; j < c->nchannels; j++)
+                s->output_samples[c->ch_remap[j]] = c->bands[0].msb_sample_buffer[j];
 
         s->output_mask |= c->ch_mask;
     }
@@ -1383,9 +1422,15 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
 
     // Assemble frequency bands for active channel sets
     if (s->nfreqbands > 1) {
-        for (i = 0; i < s->nactivechsets; i++)
-            if ((ret = chs_assemble_freq_bands(s, &s->chset[i])) < 0)
-                return ret;
+        avctx->execute2(avctx, chs_assemble_freq_bands, s, chs_ret, s->nactivechsets);
+        for (i = 0, c = s->chset; i < s->nactivechsets; i++, c++) {
+            if (chs_ret[i] < 0)
+                return chs_ret[i];
+
+            // Remap output channel pointers to assembly buffer
+            for (j = 0; j < c->nchannels; j++)
+                s->output_samples[c->ch_remap[j]] = c->sample_buffer[2] + j * s->nframesamples * 2;
+        }
     }
 
     // Normalize to regular 5.1 layout if downmixing
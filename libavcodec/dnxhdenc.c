@@ -114,6 +114,40 @@ void dnxhd_10bit_get_pixels_8x4_sym(int16_t *av_restrict block,
     memcpy(block + 4 * 8, pixels + 3 * line_size, 8 * sizeof(*block));
 }
 
+static int dnxhd_ssd_block_c(int16_t *qblock, int16_t *block)
+{
+    int score = 0;
+    int i;
+    for (i = 0; i < 64; i++)
+        score += (block[i] - qblock[i]) * (block[i] - qblock[i]);
+    return score;
+}
+
+static void dnxhd_10bit_quantize_c(int16_t *block, const int *qmat)
+{
+    int i;
+
+    for (i = 1; i < 64; i++) {
+        int sign  = FF_SIGNBIT(block[i]);
+        int level = (block[i] ^ sign) - sign;
+        level     = level * qmat[i] >> DNX10BIT_QMAT_SHIFT;
+        block[i]  = (level ^ sign) - sign;
+    }
+}
+
+av_cold void ff_dnxhdenc_init(DNXHDEncContext *ctx)
+{
+    if (ctx->bit_depth == 10)
+        ctx->get_pixels_8x4_sym = dnxhd_10bit_get_pixels_8x4_sym;
+    else
+        ctx->get_pixels_8x4_sym = dnxhd_8bit_get_pixels_8x4_sym;
+    ctx->ssd_block      = dnxhd_ssd_block_c;
+    ctx->quantize_10bit = dnxhd_10bit_quantize_c;
+
+    if (ARCH_X86)
+        ff_dnxhdenc_init_x86(ctx);
+}
+
 static int dnxhd_10bit_dct_quantize_444(MpegEncContext *ctx, int16_t *block,
                                         int n, int qscale, int *overflow)
 {
@@ -176,25 +210,21 @@ static int dnxhd_10bit_dct_quantize_444(MpegEncContext *ctx, int16_t *block,
 static int dnxhd_10bit_dct_quantize(MpegEncContext *ctx, int16_t *block,
                                     int n, int qscale, int *overflow)
 {
+    DNXHDEncContext *dctx = ctx->avctx->priv_data;
     const uint8_t *scantable= ctx->intra_scantable.scantable;
     const int *qmat = n<4 ? ctx->q_intra_matrix[qscale] : ctx->q_chroma_intra_matrix[qscale];
-    int last_non_zero = 0;
-    int i;
+    int last_non_zero;
 
     ctx->fdsp.fdct(block);
 
     // Divide by 4 with rounding, to compensate scaling of DCT coefficients
     block[0] = (block[0] + 2) >> 2;
 
-    for (i = 1; i < 64; ++i) {
-        int j = scantable[i];
-        int sign = FF_SIGNBIT(block[j]);
-        int level = (block[j] ^ sign) - sign;
-        level = level * qmat[j] >> DNX10BIT_QMAT_SHIFT;
-        block[j] = (level ^ sign) - sign;
-        if (level)
-            last_non_zero = i;
-    }
+    dctx->quantize_10bit(block, qmat);
+
+    for (last_non_zero = 63; last_non_zero > 0; last_non_zero--)
+        if (block[scantable[last_non_zero]])
+            break;
 
     /* we need this permutation so that we correct the IDCT, we only permute the !=0 elements */
     if (ctx->idsp.perm_type != FF_IDCT_PERM_NONE)
@@ -432,19 +462,15 @@ static av_cold int dnxhd_encode_init(AVCodecContext *avctx)
 
     if (ctx->is_444 || ctx->profile == FF_PROFILE_DNXHR_HQX) {
         ctx->m.dct_quantize     = dnxhd_10bit_dct_quantize_444;
-        ctx->get_pixels_8x4_sym = dnxhd_10bit_get_pixels_8x4_sym;
         ctx->block_width_l2     = 4;
     } else if (ctx->bit_depth == 10) {
         ctx->m.dct_quantize     = dnxhd_10bit_dct_quantize;
-        ctx->get_pixels_8x4_sym = dnxhd_10bit_get_pixels_8x4_sym;
         ctx->block_width_l2     = 4;
     } else {
-        ctx->get_pixels_8x4_sym = dnxhd_8bit_get_pixels_8x4_sym;
         ctx->block_width_l2     = 3;
     }
 
-    if (ARCH_X86)
-        ff_dnxhdenc_init_x86(ctx);
+    ff_dnxhdenc_init(ctx);
 
     ctx->m.mb_height = (avctx->height + 15) / 16;
     ctx->m.mb_width  = (avctx->width  + 15) / 16;
@@ -646,15 +672,6 @@ void dnxhd_unquantize_c(DNXHDEncContext *ctx, int16_t *block, int n,
     }
 }
 
-static av_always_inline int dnxhd_ssd_block(int16_t *qblock, int16_t *block)
-{
-    int score = 0;
-    int i;
-    for (i = 0; i < 64; i++)
-        score += (block[i] - qblock[i]) * (block[i] - qblock[i]);
-    return score;
-}
-
 static av_always_inline
 int dnxhd_calc_ac_bits(DNXHDEncContext *ctx, int16_t *block, int last_index)
 {
@@ -863,7 +880,7 @@ static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
             if (avctx->mb_decision == FF_MB_DECISION_RD || !RC_VARIANCE) {
                 dnxhd_unquantize_c(ctx, block, i, qscale, last_index);
                 ctx->m.idsp.idct(block);
-                ssd += dnxhd_ssd_block(block, src_block);
+                ssd += ctx->ssd_block(block, src_block);
             }
         }
         ctx->mb_rc[(qscale * ctx->m.mb_num) + mb].ssd  = ssd;
@@ -109,8 +109,21 @@ typedef struct DNXHDEncContext {
 
     void (*get_pixels_8x4_sym)(int16_t *av_restrict /* align 16 */ block,
                                const uint8_t *pixels, ptrdiff_t line_size);
+    /**
+     * Sum of squared differences of two blocks, the differences must fit
+     * in 16 bits.
+     */
+    int  (*ssd_block)(int16_t * /* align 16 */ qblock,
+                      int16_t * /* align 16 */ block);
+    /**
+     * Quantize the AC coefficients of a block for 10-bit profiles.
+     * The DC coefficient is left untouched.
+     */
+    void (*quantize_10bit)(int16_t * /* align 16 */ block,
+                           const int * /* align 16 */ qmat);
 } DNXHDEncContext;
 
+void ff_dnxhdenc_init(DNXHDEncContext *ctx);
 void ff_dnxhdenc_init_x86(DNXHDEncContext *ctx);
 
 #endif /* AVCODEC_DNXHDENC_H */
@@ -30,6 +30,7 @@
 #include "encode.h"
 #include "frame_thread_encoder.h"
 #include "internal.h"
+#include "packet_internal.h"
 
 int ff_alloc_packet(AVCodecContext *avctx, AVPacket *avpkt, int64_t size)
 {
@@ -55,8 +56,6 @@ int ff_alloc_packet(AVCodecContext *avctx, AVPacket *avpkt, int64_t size)
 
 int avcodec_default_get_encode_buffer(AVCodecContext *avctx, AVPacket *avpkt, int flags)
 {
-    int ret;
-
     if (avpkt->size < 0 || avpkt->size > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
         return AVERROR(EINVAL);
 
@@ -65,10 +64,11 @@ int avcodec_default_get_encode_buffer(AVCodecContext *avctx, AVPacket *avpkt, in
         return AVERROR(EINVAL);
     }
 
-    ret = av_buffer_realloc(&avpkt->buf, avpkt->size + AV_INPUT_BUFFER_PADDING_SIZE);
-    if (ret < 0) {
+    avpkt->buf = avpriv_packet_pool_get(&avctx->internal->packet_pool,
+                                        avpkt->size);
+    if (!avpkt->buf) {
         av_log(avctx, AV_LOG_ERROR, "Failed to allocate packet of size %d\n", avpkt->size);
-        return ret;
+        return AVERROR(ENOMEM);
     }
     avpkt->data = avpkt->buf->data;
 
@@ -219,10 +219,16 @@ static int encode_simple_internal(AVCodecContext *avctx, AVPacket *avpkt)
     emms_c();
 
     if (!ret && got_packet) {
-        if (avpkt->data) {
-            ret = av_packet_make_refcounted(avpkt);
-            if (ret < 0)
+        if (avpkt->data && !avpkt->buf) {
+            AVBufferRef *buf = avpriv_packet_pool_get(&avci->packet_pool,
+                                                      avpkt->size);
+            if (!buf) {
+                ret = AVERROR(ENOMEM);
                 goto end;
+            }
+            memcpy(buf->data, avpkt->data, avpkt->size);
+            avpkt->buf  = buf;
+            avpkt->data = buf->data;
         }
 
         if (frame && !(avctx->codec->capabilities & AV_CODEC_CAP_DELAY)) {
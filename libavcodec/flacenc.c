@@ -119,7 +119,7 @@ typedef struct FlacEncodeContext {
     FlacFrame frame;
     CompressionOptions options;
     AVCodecContext *avctx;
-    LPCContext lpc_ctx;
+    LPCContext lpc_ctx[FLAC_MAX_CHANNELS];
     struct AVMD5 *md5ctx;
     uint8_t *md5_buffer;
     unsigned int md5_buffer_size;
@@ -420,8 +420,13 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
         }
     }
 
-    ret = ff_lpc_init(&s->lpc_ctx, avctx->frame_size,
-                      s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+    /* one LPC context per channel so that channels can be searched in parallel */
+    for (i = 0; i < channels; i++) {
+        ret = ff_lpc_init(&s->lpc_ctx[i], avctx->frame_size,
+                          s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+        if (ret < 0)
+            return ret;
+    }
 
     ff_bswapdsp_init(&s->bdsp);
     ff_flacdsp_init(&s->flac_dsp, avctx->sample_fmt, channels,
@@ -848,7 +853,7 @@ static int encode_residual_ch(FlacEncodeContext *s, int ch)
 
     /* LPC */
     sub->type = FLAC_SUBFRAME_LPC;
-    opt_order = ff_lpc_calc_coefs(&s->lpc_ctx, smp, n, min_order, max_order,
+    opt_order = ff_lpc_calc_coefs(&s->lpc_ctx[ch], smp, n, min_order, max_order,
                                   s->options.lpc_coeff_precision, coefs, shift, s->options.lpc_type,
                                   s->options.lpc_passes, omethod,
                                   MIN_LPC_SHIFT, MAX_LPC_SHIFT, 0);
@@ -984,6 +989,13 @@ static int encode_residual_ch(FlacEncodeContext *s, int ch)
 }
 
 
+static int encode_residual_ch_thread(AVCodecContext *avctx, void *arg,
+                                     int jobnr, int threadnr)
+{
+    return encode_residual_ch(avctx->priv_data, jobnr);
+}
+
+
 static int count_frame_header(FlacEncodeContext *s)
 {
     uint8_t av_unused tmp;
@@ -1023,12 +1035,15 @@ static int count_frame_header(FlacEncodeContext *s)
 static int encode_frame(FlacEncodeContext *s)
 {
     int ch;
+    int ch_count[FLAC_MAX_CHANNELS];
     uint64_t count;
 
     count = count_frame_header(s);
 
+    s->avctx->execute2(s->avctx, encode_residual_ch_thread, NULL, ch_count,
+                       s->channels);
     for (ch = 0; ch < s->channels; ch++)
-        count += encode_residual_ch(s, ch);
+        count += ch_count[ch];
 
     count += (8 - (count & 7)) & 7; // byte alignment
     count += 16;                    // CRC-16
@@ -1411,10 +1426,12 @@ static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 static av_cold int flac_encode_close(AVCodecContext *avctx)
 {
     FlacEncodeContext *s = avctx->priv_data;
+    int i;
 
     av_freep(&s->md5ctx);
     av_freep(&s->md5_buffer);
-    ff_lpc_end(&s->lpc_ctx);
+    for (i = 0; i < FLAC_MAX_CHANNELS; i++)
+        ff_lpc_end(&s->lpc_ctx[i]);
     return 0;
 }
 
@@ -1463,7 +1480,7 @@ const AVCodec ff_flac_encoder = {
     .type           = AVMEDIA_TYPE_AUDIO,
     .id             = AV_CODEC_ID_FLAC,
     .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SMALL_LAST_FRAME,
+                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(FlacEncodeContext),
     .init           = flac_encode_init,
     .encode2        = flac_encode_frame,
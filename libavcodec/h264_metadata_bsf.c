@@ -17,6 +17,7 @@
  */
 
 #include "libavutil/avstring.h"
+#include "libavutil/avassert.h"
 #include "libavutil/display.h"
 #include "libavutil/common.h"
 #include "libavutil/opt.h"
@@ -79,6 +80,8 @@ typedef struct H264MetadataContext {
     H264RawSEIDisplayOrientation display_orientation_payload;
 
     int level;
+
+    CodedBitstreamUnitType decompose_unit_types[5];
 } H264MetadataContext;
 
 
@@ -546,6 +549,23 @@ static const CBSBSFType h264_metadata_type = {
 static int h264_metadata_init(AVBSFContext *bsf)
 {
     H264MetadataContext *ctx = bsf->priv_data;
+    CodedBitstreamUnitType *types = ctx->decompose_unit_types;
+    int nb_types = 0;
+
+    // Parameter sets are always needed; SEI and slices are only parsed
+    // when some option actually looks at them.
+    types[nb_types++] = H264_NAL_SPS;
+    types[nb_types++] = H264_NAL_PPS;
+    if (ctx->sei_user_data || ctx->delete_filler ||
+        ctx->display_orientation != BSF_ELEMENT_PASS)
+        types[nb_types++] = H264_NAL_SEI;
+    if (ctx->aud == BSF_ELEMENT_INSERT) {
+        types[nb_types++] = H264_NAL_SLICE;
+        types[nb_types++] = H264_NAL_IDR_SLICE;
+    }
+    av_assert0(nb_types <= FF_ARRAY_ELEMS(ctx->decompose_unit_types));
+    ctx->common.decompose_unit_types    = types;
+    ctx->common.nb_decompose_unit_types = nb_types;
 
     if (ctx->sei_user_data) {
         SEIRawUserDataUnregistered *udu = &ctx->sei_user_data_payload;
@@ -403,8 +403,39 @@ static const CBSBSFType h265_metadata_type = {
     .update_fragment = &h265_metadata_update_fragment,
 };
 
+static const CodedBitstreamUnitType h265_metadata_decompose_unit_types[] = {
+    HEVC_NAL_VPS,
+    HEVC_NAL_SPS,
+    HEVC_NAL_PPS,
+    // Slices are only needed to determine the picture type of an
+    // inserted AUD, so they must stay last.
+    HEVC_NAL_TRAIL_N,
+    HEVC_NAL_TRAIL_R,
+    HEVC_NAL_TSA_N,
+    HEVC_NAL_TSA_R,
+    HEVC_NAL_STSA_N,
+    HEVC_NAL_STSA_R,
+    HEVC_NAL_RADL_N,
+    HEVC_NAL_RADL_R,
+    HEVC_NAL_RASL_N,
+    HEVC_NAL_RASL_R,
+    HEVC_NAL_BLA_W_LP,
+    HEVC_NAL_BLA_W_RADL,
+    HEVC_NAL_BLA_N_LP,
+    HEVC_NAL_IDR_W_RADL,
+    HEVC_NAL_IDR_N_LP,
+    HEVC_NAL_CRA_NUT,
+};
+
 static int h265_metadata_init(AVBSFContext *bsf)
 {
+    H265MetadataContext *ctx = bsf->priv_data;
+
+    ctx->common.decompose_unit_types    = h265_metadata_decompose_unit_types;
+    ctx->common.nb_decompose_unit_types =
+        ctx->aud == BSF_ELEMENT_INSERT ?
+        FF_ARRAY_ELEMS(h265_metadata_decompose_unit_types) : 3;
+
     return ff_cbs_bsf_generic_init(bsf, &h265_metadata_type);
 }
 
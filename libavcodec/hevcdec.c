@@ -3769,9 +3769,14 @@ static av_cold int hevc_decode_init(AVCodecContext *avctx)
     else
         s->threads_number = 1;
 
-    if((avctx->active_thread_type & FF_THREAD_FRAME) && avctx->thread_count > 1)
+    if((avctx->active_thread_type & FF_THREAD_FRAME) && avctx->thread_count > 1) {
         s->threads_type = FF_THREAD_FRAME;
-    else
+        /* keep few frames in flight and spread each one over WPP rows */
+        ret = ff_slice_thread_init_nested(avctx, s->wpp_threads);
+        if (ret < 0)
+            return ret;
+        s->threads_number = ret;
+    } else
         s->threads_type = FF_THREAD_SLICE;
 
     ret = hevc_init_context(avctx);
@@ -3814,6 +3819,8 @@ static const AVOption options[] = {
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
     { "strict-displaywin", "stricly apply default display window size", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
+    { "wpp_threads", "number of WPP slice threads per frame thread", OFFSET(wpp_threads),
+        AV_OPT_TYPE_INT, {.i64 = 0}, 0, UINT8_MAX, PAR },
     { NULL },
 };
 
@@ -34,6 +34,7 @@
 #include "avcodec.h"
 #include "bsf.h"
 #include "config.h"
+#include "packet_internal.h"
 
 /**
  * The codec does not modify any global variables in the init function,
@@ -84,6 +85,12 @@
  * internal logic derive them from AVCodecInternal.last_pkt_props.
  */
 #define FF_CODEC_CAP_SETS_FRAME_PROPS       (1 << 8)
+/**
+ * The slice threading jobs of the codec may wait on higher numbered jobs of
+ * the same execute call, so they all need a thread of their own and cannot
+ * run on the shared worker pool.
+ */
+#define FF_CODEC_CAP_SLICE_THREAD_SYNC      (1 << 9)
 
 /**
  * AVCodec.codec_tags termination value
@@ -133,6 +140,12 @@ typedef struct AVCodecInternal {
 
     void *thread_ctx;
 
+    /**
+     * Slice threading context. Kept apart from thread_ctx so that frame
+     * thread contexts can run slice threads of their own.
+     */
+    void *slice_thread_ctx;
+
     /**
      * This packet is used to hold the packet given to decoders
      * implementing the .decode API; it is unused by the generic
@@ -157,6 +170,11 @@ typedef struct AVCodecInternal {
     uint8_t *byte_buffer;
     unsigned int byte_buffer_size;
 
+    /**
+     * Pools for the payloads of the packets returned by encoders.
+     */
+    PacketPool packet_pool;
+
     /**
      * This is set to AV_PKT_FLAG_KEY for encoders that encode intra-only
      * formats (i.e. whose codec descriptor has AV_CODEC_PROP_INTRA_ONLY set).
@@ -107,6 +107,19 @@ typedef struct {
    double *layer_rates;
 } Jpeg2000Tile;
 
+/**
+ * A code-block together with its position in the transformed component,
+ * so that tier-1 coding of all code-blocks can run in parallel.
+ */
+typedef struct {
+    Jpeg2000Component *comp;
+    Jpeg2000Band *band;
+    Jpeg2000Cblk *cblk;
+    int x0, x1, y0, y1; ///< code-block area within comp->i_data
+    int bandpos;
+    int lev;
+} Jpeg2000CblkJob;
+
 typedef struct {
     AVClass *class;
     AVCodecContext *avctx;
@@ -131,6 +144,9 @@ typedef struct {
     Jpeg2000QuantStyle  qntsty;
 
     Jpeg2000Tile *tile;
+    Jpeg2000CblkJob *cblk_jobs;
+    int nb_cblk_jobs;
+    int *dwt_ret; ///< return values of the per component DWT jobs
     int layer_rates[100];
     uint8_t compression_rate_enc; ///< Is compression done using compression ratio?
 
@@ -447,6 +463,92 @@ static void compute_rates(Jpeg2000EncoderContext* s)
 
 }
 
+/**
+ * Collect the code-blocks of all tiles and components.
+ * If jobs is NULL, only count them.
+ */
+static int collect_cblk_jobs(Jpeg2000EncoderContext *s, Jpeg2000CblkJob *jobs)
+{
+    int tileno, compno, reslevelno, bandno, nb_jobs = 0;
+    Jpeg2000CodingStyle *codsty = &s->codsty;
+
+    for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){
+        for (compno = 0; compno < s->ncomponents; compno++){
+            Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+
+            for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
+                Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+                for (bandno = 0; bandno < reslevel->nbands ; bandno++){
+                    Jpeg2000Band *band = reslevel->band + bandno;
+                    Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+                    int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
+                    yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+                    y0 = yy0;
+                    yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                                band->coord[1][1]) - band->coord[1][0] + yy0;
+
+                    if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                        continue;
+
+                    bandpos = bandno + (reslevelno > 0);
+
+                    for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
+                        if (reslevelno == 0 || bandno == 1)
+                            xx0 = 0;
+                        else
+                            xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+                        x0 = xx0;
+                        xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                                    band->coord[0][1]) - band->coord[0][0] + xx0;
+
+                        for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
+                            if (jobs) {
+                                Jpeg2000CblkJob *job = jobs + nb_jobs;
+                                Jpeg2000Cblk *cblk   = prec->cblk + cblkno;
+
+                                cblk->data   = av_malloc(1 + 8192);
+                                cblk->passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof(*cblk->passes));
+                                if (!cblk->data || !cblk->passes)
+                                    return AVERROR(ENOMEM);
+
+                                job->comp    = comp;
+                                job->band    = band;
+                                job->cblk    = cblk;
+                                job->x0      = xx0;
+                                job->x1      = xx1;
+                                job->y0      = yy0;
+                                job->y1      = yy1;
+                                job->bandpos = bandpos;
+                                job->lev     = codsty->nreslevels - reslevelno - 1;
+                            }
+                            nb_jobs++;
+                            xx0 = xx1;
+                            xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
+                        }
+                        yy0 = yy1;
+                        yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+                    }
+                }
+            }
+        }
+    }
+    return nb_jobs;
+}
+
+static int init_cblk_jobs(Jpeg2000EncoderContext *s)
+{
+    int ret;
+
+    s->nb_cblk_jobs = collect_cblk_jobs(s, NULL);
+    s->cblk_jobs    = av_calloc(s->nb_cblk_jobs, sizeof(*s->cblk_jobs));
+    if (!s->cblk_jobs)
+        return AVERROR(ENOMEM);
+    if ((ret = collect_cblk_jobs(s, s->cblk_jobs)) < 0)
+        return ret;
+    return 0;
+}
+
 /**
  * compute the sizes of tiles, resolution levels, bands, etc.
  * allocate memory for them
@@ -501,7 +603,11 @@ static int init_tiles(Jpeg2000EncoderContext *s)
             }
         }
     compute_rates(s);
-    return 0;
+    s->dwt_ret = av_calloc(s->numXtiles * s->numYtiles * s->ncomponents,
+                           sizeof(*s->dwt_ret));
+    if (!s->dwt_ret)
+        return AVERROR(ENOMEM);
+    return init_cblk_jobs(s);
 }
 
 #define COPY_FRAME(D, PIXEL)                                                                                                \
@@ -702,7 +808,7 @@ static void encode_clnpass(Jpeg2000T1Context *t1, int width, int height, int ban
         }
 }
 
-static void encode_cblk(Jpeg2000EncoderContext *s, Jpeg2000T1Context *t1, Jpeg2000Cblk *cblk, Jpeg2000Tile *tile,
+static void encode_cblk(Jpeg2000EncoderContext *s, Jpeg2000T1Context *t1, Jpeg2000Cblk *cblk,
                         int width, int height, int bandpos, int lev)
 {
     int pass_t = 2, passno, x, y, max=0, nmsedec, bpno;
@@ -1400,84 +1506,70 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+static int dwt_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
-    Jpeg2000T1Context t1;
-    Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
-
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
-
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000Component *comp   = s->tile[jobnr / s->ncomponents].comp + jobnr % s->ncomponents;
 
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    return ff_dwt_encode(&comp->dwt, comp->i_data);
+}
 
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
+static int encode_cblk_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    const Jpeg2000CblkJob *job = s->cblk_jobs + jobnr;
+    Jpeg2000Component *comp = job->comp;
+    Jpeg2000Band *band = job->band;
+    Jpeg2000T1Context t1;
+    int y, x;
 
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
+    t1.stride = (1<<s->codsty.log2_cblk_width) + 2;
 
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
-
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
-                                }
-                            }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
-                            }
-                        }
-                        if (!prec->cblk[cblkno].data)
-                            prec->cblk[cblkno].data = av_malloc(1 + 8192);
-                        if (!prec->cblk[cblkno].passes)
-                            prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
-                        if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
-                            return AVERROR(ENOMEM);
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
-                    }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
-                }
+    if (s->codsty.transform == FF_DWT53){
+        for (y = job->y0; y < job->y1; y++){
+            int *ptr = t1.data + (y-job->y0)*t1.stride;
+            for (x = job->x0; x < job->x1; x++){
+                *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
+            }
+        }
+    } else{
+        for (y = job->y0; y < job->y1; y++){
+            int *ptr = t1.data + (y-job->y0)*t1.stride;
+            for (x = job->x0; x < job->x1; x++){
+                *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
+                *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                ptr++;
             }
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
     }
+    encode_cblk(s, &t1, job->cblk, job->x1 - job->x0, job->y1 - job->y0,
+                job->bandpos, job->lev);
+    return 0;
+}
+
+/**
+ * Wavelet transform and tier-1 code all tiles. Components are transformed
+ * in parallel first, then all code-blocks are coded in parallel.
+ */
+static int encode_tiles_tier1(Jpeg2000EncoderContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int i, nb_dwt_jobs = s->numXtiles * s->numYtiles * s->ncomponents;
+
+    av_log(avctx, AV_LOG_DEBUG,"dwt\n");
+    avctx->execute2(avctx, dwt_job, NULL, s->dwt_ret, nb_dwt_jobs);
+    for (i = 0; i < nb_dwt_jobs; i++)
+        if (s->dwt_ret[i] < 0)
+            return s->dwt_ret[i];
+    av_log(avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+    avctx->execute2(avctx, encode_cblk_job, NULL, NULL, s->nb_cblk_jobs);
+    av_log(avctx, AV_LOG_DEBUG, "after tier1\n");
+    return 0;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     if (s->compression_rate_enc)
@@ -1509,6 +1601,8 @@ static void cleanup(Jpeg2000EncoderContext *s)
         av_freep(&s->tile[tileno].layer_rates);
     }
     av_freep(&s->tile);
+    av_freep(&s->cblk_jobs);
+    av_freep(&s->dwt_ret);
 }
 
 static void reinit(Jpeg2000EncoderContext *s)
@@ -1551,6 +1645,9 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
 
     reinit(s);
 
+    if ((ret = encode_tiles_tier1(s)) < 0)
+        return ret;
+
     if (s->format == CODEC_JP2) {
         av_assert0(s->buf == pkt->data);
 
@@ -1836,6 +1933,7 @@ const AVCodec ff_jpeg2000_encoder = {
     .long_name      = NULL_IF_CONFIG_SMALL("JPEG 2000"),
     .type           = AVMEDIA_TYPE_VIDEO,
     .id             = AV_CODEC_ID_JPEG2000,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(Jpeg2000EncoderContext),
     .init           = j2kenc_init,
     .encode2        = encode_frame,
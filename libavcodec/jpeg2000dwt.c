@@ -93,6 +93,52 @@ static void sd_1d53(int *p, int i0, int i1)
         p[2*i] += (p[2*i-1] + p[2*i+1] + 2) >> 2;
 }
 
+static inline void copy_col(int32_t *p, int dst, int src)
+{
+    memcpy(p + dst * FF_DWT_COLS, p + src * FF_DWT_COLS, FF_DWT_COLS * sizeof(*p));
+}
+
+static void sd_cols53_c(int32_t *p, int i0, int i1)
+{
+    int i, c;
+
+    for (i = ((i0+1)>>1) - 1; i < (i1+1)>>1; i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i+1)*FF_DWT_COLS + c] -= (p[(2*i)*FF_DWT_COLS + c] + p[(2*i+2)*FF_DWT_COLS + c]) >> 1;
+    for (i = ((i0+1)>>1); i < (i1+1)>>1; i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i)*FF_DWT_COLS + c] += (p[(2*i-1)*FF_DWT_COLS + c] + p[(2*i+1)*FF_DWT_COLS + c] + 2) >> 2;
+}
+
+/* vertical 5/3 decomposition of columns lp .. lp + FF_DWT_COLS - 1 */
+static void ver_sd53_cols(DWTContext *s, int *t, int w, int lp, int lv, int mv)
+{
+    int32_t *line = s->i_colbuf + 3 * FF_DWT_COLS;
+    int32_t *l = line + mv * FF_DWT_COLS;
+    int i, c, j = 0;
+
+    for (i = 0; i < lv; i++)
+        memcpy(l + i * FF_DWT_COLS, t + w*i + lp, FF_DWT_COLS * sizeof(*t));
+
+    if (lv <= 1) {
+        if (mv == 1)
+            for (c = 0; c < FF_DWT_COLS; c++)
+                line[FF_DWT_COLS + c] <<= 1;
+    } else {
+        copy_col(line, mv - 1, mv + 1);
+        copy_col(line, mv + lv, mv + lv - 2);
+        copy_col(line, mv - 2, mv + 2);
+        copy_col(line, mv + lv + 1, mv + lv - 3);
+        s->sd_cols53(line, mv, mv + lv);
+    }
+
+    // copy back and deinterleave
+    for (i =   mv; i < lv; i+=2, j++)
+        memcpy(t + w*j + lp, l + i * FF_DWT_COLS, FF_DWT_COLS * sizeof(*t));
+    for (i = 1-mv; i < lv; i+=2, j++)
+        memcpy(t + w*j + lp, l + i * FF_DWT_COLS, FF_DWT_COLS * sizeof(*t));
+}
+
 static void dwt_encode53(DWTContext *s, int *t)
 {
     int lev,
@@ -109,8 +155,11 @@ static void dwt_encode53(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
+        for (lp = 0; lp + FF_DWT_COLS <= lh; lp += FF_DWT_COLS)
+            ver_sd53_cols(s, t, w, lp, lv, mv);
+
         l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
+        for (; lp < lh; lp++) {
             int i, j = 0;
 
             for (i = 0; i < lv; i++)
@@ -244,6 +293,59 @@ static void sd_1d97_int(int *p, int i0, int i1)
         p[2 * i]     += (I_LFTG_DELTA * (p[2 * i - 1] + p[2 * i + 1]) + (1 << 15)) >> 16;
 }
 
+static void sd_cols97_int_c(int32_t *p, int i0, int i1)
+{
+    int i, c;
+
+    i0++; i1++;
+
+    for (i = (i0>>1) - 2; i < (i1>>1) + 1; i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i+1)*FF_DWT_COLS + c] -= (I_LFTG_ALPHA * (p[(2*i)  *FF_DWT_COLS + c] + p[(2*i+2)*FF_DWT_COLS + c]) + (1 << 15)) >> 16;
+    for (i = (i0>>1) - 1; i < (i1>>1) + 1; i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i)  *FF_DWT_COLS + c] -= (I_LFTG_BETA  * (p[(2*i-1)*FF_DWT_COLS + c] + p[(2*i+1)*FF_DWT_COLS + c]) + (1 << 15)) >> 16;
+    for (i = (i0>>1) - 1; i < (i1>>1); i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i+1)*FF_DWT_COLS + c] += (I_LFTG_GAMMA * (p[(2*i)  *FF_DWT_COLS + c] + p[(2*i+2)*FF_DWT_COLS + c]) + (1 << 15)) >> 16;
+    for (i = (i0>>1); i < (i1>>1); i++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            p[(2*i)  *FF_DWT_COLS + c] += (I_LFTG_DELTA * (p[(2*i-1)*FF_DWT_COLS + c] + p[(2*i+1)*FF_DWT_COLS + c]) + (1 << 15)) >> 16;
+}
+
+/* vertical integer 9/7 decomposition of columns lp .. lp + FF_DWT_COLS - 1 */
+static void ver_sd97_int_cols(DWTContext *s, int *t, int w, int lp, int lv, int mv)
+{
+    int32_t *line = s->i_colbuf + 5 * FF_DWT_COLS;
+    int32_t *l = line + mv * FF_DWT_COLS;
+    int i, c, j = 0;
+
+    for (i = 0; i < lv; i++)
+        memcpy(l + i * FF_DWT_COLS, t + w*i + lp, FF_DWT_COLS * sizeof(*t));
+
+    if (lv <= 1) {
+        for (c = 0; c < FF_DWT_COLS; c++) {
+            if (mv == 1)
+                line[FF_DWT_COLS + c] = (line[FF_DWT_COLS + c] * I_LFTG_X + (1<<14)) >> 15;
+            else
+                line[c] = (line[c] * I_LFTG_K + (1<<15)) >> 16;
+        }
+    } else {
+        for (i = 1; i <= 4; i++) {
+            copy_col(line, mv - i,          mv + i);
+            copy_col(line, mv + lv + i - 1, mv + lv - i - 1);
+        }
+        s->sd_cols97_int(line, mv, mv + lv);
+    }
+
+    // copy back and deinterleave
+    for (i =   mv; i < lv; i+=2, j++)
+        for (c = 0; c < FF_DWT_COLS; c++)
+            t[w*j + lp + c] = ((l[i * FF_DWT_COLS + c] * I_LFTG_X) + (1 << 15)) >> 16;
+    for (i = 1-mv; i < lv; i+=2, j++)
+        memcpy(t + w*j + lp, l + i * FF_DWT_COLS, FF_DWT_COLS * sizeof(*t));
+}
+
 static void dwt_encode97_int(DWTContext *s, int *t)
 {
     int lev;
@@ -265,8 +367,11 @@ static void dwt_encode97_int(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
+        for (lp = 0; lp + FF_DWT_COLS <= lh; lp += FF_DWT_COLS)
+            ver_sd97_int_cols(s, t, w, lp, lv, mv);
+
         l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
+        for (; lp < lh; lp++) {
             int i, j = 0;
 
             for (i = 0; i < lv; i++)
@@ -563,17 +668,23 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
         break;
      case FF_DWT97_INT:
         s->i_linebuf = av_malloc_array((maxlen + 12), sizeof(*s->i_linebuf));
-        if (!s->i_linebuf)
+        s->i_colbuf  = av_malloc_array((maxlen + 12) * FF_DWT_COLS, sizeof(*s->i_colbuf));
+        if (!s->i_linebuf || !s->i_colbuf)
             return AVERROR(ENOMEM);
         break;
     case FF_DWT53:
         s->i_linebuf = av_malloc_array((maxlen +  6), sizeof(*s->i_linebuf));
-        if (!s->i_linebuf)
+        s->i_colbuf  = av_malloc_array((maxlen +  6) * FF_DWT_COLS, sizeof(*s->i_colbuf));
+        if (!s->i_linebuf || !s->i_colbuf)
             return AVERROR(ENOMEM);
         break;
     default:
         return -1;
     }
+
+    s->sd_cols53     = sd_cols53_c;
+    s->sd_cols97_int = sd_cols97_int_c;
+
     return 0;
 }
 
@@ -620,4 +731,5 @@ void ff_dwt_destroy(DWTContext *s)
 {
     av_freep(&s->f_linebuf);
     av_freep(&s->i_linebuf);
+    av_freep(&s->i_colbuf);
 }
@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 #define FF_DWT_MAX_DECLVLS 32 ///< max number of decomposition levels
+#define FF_DWT_COLS         8 ///< columns lifted together in the forward vertical pass
 #define F_LFTG_K      1.230174104914001f
 #define F_LFTG_X      0.812893066115961f
 
@@ -48,6 +49,15 @@ typedef struct DWTContext {
     uint8_t type;                        ///< 0 for 9/7; 1 for 5/3
     int32_t *i_linebuf;                  ///< int buffer used by transform
     float   *f_linebuf;                  ///< float buffer used by transform
+    int32_t *i_colbuf;                   ///< FF_DWT_COLS interleaved columns, used by the forward transform
+
+    /**
+     * Forward lifting steps on FF_DWT_COLS interleaved columns.
+     * Element k of the line holds p[k * FF_DWT_COLS + c] for column c.
+     * The line must already be symmetrically extended and i1 > i0 + 1.
+     */
+    void (*sd_cols53)(int32_t *p, int i0, int i1);
+    void (*sd_cols97_int)(int32_t *p, int i0, int i1);
 } DWTContext;
 
 /**
@@ -61,7 +61,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/timecode.h"
 
-#define MAX_THREADS 32
+#define MAX_THREADS 64
 
 #define MAX_B_FRAMES 16
 
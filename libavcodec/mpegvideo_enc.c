@@ -1255,24 +1255,114 @@ static int encode_frame(AVCodecContext *c, AVFrame *frame, AVPacket *pkt)
     return size;
 }
 
-static int estimate_best_b_count(MpegEncContext *s)
+typedef struct BFrameCandidate {
+    MpegEncContext *s;
+    int b_count;        ///< number of B-frames between two P-frames
+    int p_lambda, b_lambda, lambda2;
+    int64_t rd;         ///< rate-distortion cost of the trial encode
+} BFrameCandidate;
+
+/**
+ * Encode the downscaled lookahead frames with one B-frame count.
+ * The candidates are independent of each other and run as slice jobs.
+ */
+static int encode_b_frame_candidate(AVCodecContext *avctx, void *arg)
 {
-    const AVCodec *codec = avcodec_find_encoder(s->avctx->codec_id);
+    BFrameCandidate *cand = arg;
+    MpegEncContext *s     = cand->s;
+    const AVCodec *codec  = avcodec_find_encoder(avctx->codec_id);
+    const int j           = cand->b_count;
+    AVCodecContext *c;
     AVPacket *pkt;
+    AVFrame *frame;
+    int i, out_size, ret;
+    int64_t rd = 0;
+
+    c     = avcodec_alloc_context3(NULL);
+    pkt   = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!c || !pkt || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    c->width        = s->width  >> s->brd_scale;
+    c->height       = s->height >> s->brd_scale;
+    c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
+    c->flags       |= avctx->flags & AV_CODEC_FLAG_QPEL;
+    c->mb_decision  = avctx->mb_decision;
+    c->me_cmp       = avctx->me_cmp;
+    c->mb_cmp       = avctx->mb_cmp;
+    c->me_sub_cmp   = avctx->me_sub_cmp;
+    c->pix_fmt      = AV_PIX_FMT_YUV420P;
+    c->time_base    = avctx->time_base;
+    c->max_b_frames = s->max_b_frames;
+
+    ret = avcodec_open2(c, codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    // the downscaled frames are shared by all candidates, so only refs
+    // of them carry the picture type and quality of this candidate
+    for (i = 0; i < s->max_b_frames + 2; i++) {
+        int is_p = i && ((i - 1) % (j + 1) == j || i - 1 == s->max_b_frames);
+
+        ret = av_frame_ref(frame, s->tmp_frames[i]);
+        if (ret < 0)
+            goto fail;
+
+        if (!i) {
+            frame->pict_type = AV_PICTURE_TYPE_I;
+            frame->quality   = 1 * FF_QP2LAMBDA;
+        } else {
+            frame->pict_type = is_p ? AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
+            frame->quality   = is_p ? cand->p_lambda : cand->b_lambda;
+        }
+
+        out_size = encode_frame(c, frame, pkt);
+        av_frame_unref(frame);
+        if (out_size < 0) {
+            ret = out_size;
+            goto fail;
+        }
+
+        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
+        if (i)
+            rd += (out_size * cand->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    }
+
+    /* get the delayed frames */
+    out_size = encode_frame(c, NULL, pkt);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+    rd += (out_size * cand->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+
+    rd += c->error[0] + c->error[1] + c->error[2];
+
+    cand->rd = rd;
+
+fail:
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&c);
+    return ret;
+}
+
+static int estimate_best_b_count(MpegEncContext *s)
+{
+    BFrameCandidate cand[MAX_B_FRAMES + 1];
+    int cand_ret[MAX_B_FRAMES + 1];
     const int scale = s->brd_scale;
     int width  = s->width  >> scale;
     int height = s->height >> scale;
-    int i, j, out_size, p_lambda, b_lambda, lambda2;
+    int i, j, nb_cand, p_lambda, b_lambda, lambda2;
     int64_t best_rd  = INT64_MAX;
     int best_b_count = -1;
-    int ret = 0;
 
     av_assert0(scale >= 0 && scale <= 3);
 
-    pkt = av_packet_alloc();
-    if (!pkt)
-        return AVERROR(ENOMEM);
-
     //emms_c();
     //s->next_picture_ptr->quality;
     p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
@@ -1316,89 +1406,28 @@ static int estimate_best_b_count(MpegEncContext *s)
         }
     }
 
-    for (j = 0; j < s->max_b_frames + 1; j++) {
-        AVCodecContext *c;
-        int64_t rd = 0;
-
-        if (!s->input_picture[j])
-            break;
-
-        c = avcodec_alloc_context3(NULL);
-        if (!c) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
-        }
-
-        c->width        = width;
-        c->height       = height;
-        c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
-        c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
-        c->mb_decision  = s->avctx->mb_decision;
-        c->me_cmp       = s->avctx->me_cmp;
-        c->mb_cmp       = s->avctx->mb_cmp;
-        c->me_sub_cmp   = s->avctx->me_sub_cmp;
-        c->pix_fmt      = AV_PIX_FMT_YUV420P;
-        c->time_base    = s->avctx->time_base;
-        c->max_b_frames = s->max_b_frames;
-
-        ret = avcodec_open2(c, codec, NULL);
-        if (ret < 0)
-            goto fail;
-
-
-        s->tmp_frames[0]->pict_type = AV_PICTURE_TYPE_I;
-        s->tmp_frames[0]->quality   = 1 * FF_QP2LAMBDA;
-
-        out_size = encode_frame(c, s->tmp_frames[0], pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-
-        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
-
-        for (i = 0; i < s->max_b_frames + 1; i++) {
-            int is_p = i % (j + 1) == j || i == s->max_b_frames;
+    for (j = 0; j < s->max_b_frames + 1 && s->input_picture[j]; j++) {
+        cand[j].s        = s;
+        cand[j].b_count  = j;
+        cand[j].p_lambda = p_lambda;
+        cand[j].b_lambda = b_lambda;
+        cand[j].lambda2  = lambda2;
+    }
+    nb_cand = j;
 
-            s->tmp_frames[i + 1]->pict_type = is_p ?
-                                     AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
-            s->tmp_frames[i + 1]->quality   = is_p ? p_lambda : b_lambda;
+    s->avctx->execute(s->avctx, encode_b_frame_candidate, cand, cand_ret,
+                      nb_cand, sizeof(*cand));
 
-            out_size = encode_frame(c, s->tmp_frames[i + 1], pkt);
-            if (out_size < 0) {
-                ret = out_size;
-                goto fail;
-            }
-
-            rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-        }
+    for (j = 0; j < nb_cand; j++) {
+        if (cand_ret[j] < 0)
+            return cand_ret[j];
 
-        /* get the delayed frames */
-        out_size = encode_frame(c, NULL, pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-        rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-
-        rd += c->error[0] + c->error[1] + c->error[2];
-
-        if (rd < best_rd) {
-            best_rd = rd;
+        if (cand[j].rd < best_rd) {
+            best_rd = cand[j].rd;
             best_b_count = j;
         }
-
-fail:
-        avcodec_free_context(&c);
-        av_packet_unref(pkt);
-        if (ret < 0) {
-            best_b_count = ret;
-            break;
-        }
     }
 
-    av_packet_free(&pkt);
-
     return best_b_count;
 }
 
@@ -379,6 +379,30 @@ static int bands_dist(OpusPsyContext *s, CeltFrame *f, float *total_dist)
     return 0;
 }
 
+/* Evaluate one stereo configuration on a private copy of the frame, so that
+ * all trials start from the same state and can run concurrently */
+static int stereo_trial(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    OpusPsyContext *s = arg;
+    CeltFrame *f = &s->trial_frame[threadnr];
+
+    *f = *s->trial_base;
+    f->pvq = s->trial_pvq[threadnr];
+    if (s->trial_dual)
+        f->dual_stereo = jobnr;
+    else
+        f->intensity_stereo = f->end_band - jobnr;
+
+    return bands_dist(s, f, &s->trial_dist[jobnr]);
+}
+
+static void run_stereo_trials(OpusPsyContext *s, CeltFrame *f, int dual, int nb_trials)
+{
+    s->trial_base = f;
+    s->trial_dual = dual;
+    s->avctx->execute2(s->avctx, stereo_trial, s, NULL, nb_trials);
+}
+
 static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
 {
     float td1, td2;
@@ -387,9 +411,9 @@ static void celt_search_for_dual_stereo(OpusPsyContext *s, CeltFrame *f)
     if (s->avctx->channels < 2)
         return;
 
-    bands_dist(s, f, &td1);
-    f->dual_stereo = 1;
-    bands_dist(s, f, &td2);
+    run_stereo_trials(s, f, 1, 2);
+    td1 = s->trial_dist[0];
+    td2 = s->trial_dist[1];
 
     f->dual_stereo = td2 < td1;
     s->dual_stereo_used += td2 < td1;
@@ -405,9 +429,10 @@ static void celt_search_for_intensity(OpusPsyContext *s, CeltFrame *f)
     if (s->avctx->channels < 2)
         return;
 
+    run_stereo_trials(s, f, 0, f->end_band - end_band + 1);
+
     for (i = f->end_band; i >= end_band; i--) {
-        f->intensity_stereo = i;
-        bands_dist(s, f, &dist);
+        dist = s->trial_dist[f->end_band - i];
         if (best_dist > dist) {
             best_dist = dist;
             best_band = i;
@@ -568,11 +593,27 @@ av_cold int ff_opus_psy_init(OpusPsyContext *s, AVCodecContext *avctx,
             goto fail;
     }
 
+    s->nb_trial_ctx = FFMAX(avctx->thread_count, 1);
+    s->trial_frame  = av_malloc_array(s->nb_trial_ctx, sizeof(*s->trial_frame));
+    s->trial_pvq    = av_calloc(s->nb_trial_ctx, sizeof(*s->trial_pvq));
+    if (!s->trial_frame || !s->trial_pvq) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (i = 0; i < s->nb_trial_ctx; i++)
+        if ((ret = ff_celt_pvq_init(&s->trial_pvq[i], 1)) < 0)
+            goto fail;
+
     return 0;
 
 fail:
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
+    av_freep(&s->trial_frame);
+    if (s->trial_pvq)
+        for (i = 0; i < s->nb_trial_ctx; i++)
+            ff_celt_pvq_uninit(&s->trial_pvq[i]);
+    av_freep(&s->trial_pvq);
 
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         ff_mdct15_uninit(&s->mdct[i]);
@@ -596,6 +637,11 @@ av_cold int ff_opus_psy_end(OpusPsyContext *s)
 
     av_freep(&s->inflection_points);
     av_freep(&s->dsp);
+    av_freep(&s->trial_frame);
+    if (s->trial_pvq)
+        for (i = 0; i < s->nb_trial_ctx; i++)
+            ff_celt_pvq_uninit(&s->trial_pvq[i]);
+    av_freep(&s->trial_pvq);
 
     for (i = 0; i < CELT_BLOCK_NB; i++) {
         ff_mdct15_uninit(&s->mdct[i]);
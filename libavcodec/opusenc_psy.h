@@ -75,6 +75,14 @@ typedef struct OpusPsyContext {
 
     DECLARE_ALIGNED(32, float, scratch)[2048];
 
+    /* Stereo search trials, run in parallel, one frame copy and PVQ per thread */
+    CeltFrame *trial_frame;
+    CeltPVQ **trial_pvq;
+    int nb_trial_ctx;
+    const CeltFrame *trial_base;
+    int trial_dual;
+    float trial_dist[CELT_MAX_BANDS + 1];
+
     /* Stats */
     float rc_waste;
     float avg_is_band;
@@ -21,8 +21,28 @@
 
 #include <stdint.h>
 
+#include "libavutil/buffer.h"
+
 #include "packet.h"
 
+/**
+ * Number of power-of-two size classes in a PacketPool. Payloads whose
+ * padded size does not fit the largest class are allocated directly.
+ */
+#define PACKET_POOL_CLASSES 23
+
+/**
+ * A set of buffer pools for packet payloads, one per power-of-two size
+ * class, so that packets of similar size reuse each other's memory
+ * instead of going through malloc() and free() for every packet.
+ *
+ * The pools are created on demand; a zeroed structure is a valid empty
+ * pool set. Buffers may outlive the PacketPool they came from.
+ */
+typedef struct PacketPool {
+    AVBufferPool *pools[PACKET_POOL_CLASSES];
+} PacketPool;
+
 typedef struct PacketList {
     struct PacketList *next;
     AVPacket pkt;
@@ -69,6 +89,21 @@ int avpriv_packet_list_get(PacketList **head, PacketList **tail,
  */
 void avpriv_packet_list_free(PacketList **head, PacketList **tail);
 
+/**
+ * Get a buffer for a packet payload of the given size from a PacketPool.
+ *
+ * The returned buffer is at least size + AV_INPUT_BUFFER_PADDING_SIZE
+ * bytes large and the padding following the first size bytes is zeroed.
+ *
+ * @return a new reference on success, NULL on failure
+ */
+AVBufferRef *avpriv_packet_pool_get(PacketPool *pool, int size);
+
+/**
+ * Release all pools of a PacketPool. Buffers still in use remain valid.
+ */
+void avpriv_packet_pool_uninit(PacketPool *pool);
+
 int ff_side_data_set_encoder_stats(AVPacket *pkt, int quality, int64_t *error, int error_count, int pict_type);
 
 int ff_side_data_set_prft(AVPacket *pkt, int64_t timestamp);
@@ -34,6 +34,7 @@
 #include "bytestream.h"
 #include "internal.h"
 #include "proresdata.h"
+#include "proresencdsp.h"
 
 #define CFACTOR_Y422 2
 #define CFACTOR_Y444 3
@@ -222,6 +223,7 @@ struct TrellisNode {
 
 typedef struct ProresThreadData {
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(16, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16 * 16];
     int16_t custom_q[64];
     int16_t custom_chroma_q[64];
@@ -231,6 +233,7 @@ typedef struct ProresThreadData {
 typedef struct ProresContext {
     AVClass *class;
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(16, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16*16];
     int16_t quants[MAX_STORED_Q][64];
     int16_t quants_chroma[MAX_STORED_Q][64];
@@ -243,6 +246,7 @@ typedef struct ProresContext {
     void (*fdct)(FDCTDSPContext *fdsp, const uint16_t *src,
                  ptrdiff_t linesize, int16_t *block);
     FDCTDSPContext fdsp;
+    ProresEncDSPContext dsp;
 
     const AVFrame *pic;
     int mb_width, mb_height;
@@ -431,10 +435,10 @@ static void encode_dcs(PutBitContext *pb, int16_t *blocks,
     }
 }
 
-static void encode_acs(PutBitContext *pb, int16_t *blocks,
+static void encode_acs(PutBitContext *pb, const int16_t *levels,
                        int blocks_per_slice,
                        int plane_size_factor,
-                       const uint8_t *scan, const int16_t *qmat)
+                       const uint8_t *scan)
 {
     int idx, i;
     int run, level, run_cb, lev_cb;
@@ -447,7 +451,7 @@ static void encode_acs(PutBitContext *pb, int16_t *blocks,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level = blocks[idx] / qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 encode_vlc_codeword(pb, ff_prores_ac_codebook[run_cb], run);
@@ -473,9 +477,10 @@ static void encode_slice_plane(ProresContext *ctx, PutBitContext *pb,
 {
     int blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
+    ctx->dsp.quantize(ctx->levels, blocks, blocks_per_slice, qmat);
     encode_dcs(pb, blocks, blocks_per_slice, qmat[0]);
-    encode_acs(pb, blocks, blocks_per_slice, plane_size_factor,
-               ctx->scantable, qmat);
+    encode_acs(pb, ctx->levels, blocks_per_slice, plane_size_factor,
+               ctx->scantable);
 }
 
 static void put_alpha_diff(PutBitContext *pb, int cur, int prev, int abits)
@@ -677,9 +682,8 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
     return bits;
 }
 
-static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
-                        int plane_size_factor,
-                        const uint8_t *scan, const int16_t *qmat)
+static int estimate_acs(const int16_t *levels, int blocks_per_slice,
+                        int plane_size_factor, const uint8_t *scan)
 {
     int idx, i;
     int run, level, run_cb, lev_cb;
@@ -693,8 +697,7 @@ static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level   = blocks[idx] / qmat[scan[i]];
-            *error += FFABS(blocks[idx]) % qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 bits += estimate_vlc(ff_prores_ac_codebook[run_cb], run);
@@ -724,9 +727,11 @@ static int estimate_slice_plane(ProresContext *ctx, int *error, int plane,
 
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
-    bits  = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
-    bits += estimate_acs(error, td->blocks[plane], blocks_per_slice,
-                         plane_size_factor, ctx->scantable, qmat);
+    *error += ctx->dsp.quantize(td->levels, td->blocks[plane],
+                                blocks_per_slice, qmat);
+    bits    = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
+    bits   += estimate_acs(td->levels, blocks_per_slice, plane_size_factor,
+                           ctx->scantable);
 
     return FFALIGN(bits, 8);
 }
@@ -1184,6 +1189,7 @@ static av_cold int encode_init(AVCodecContext *avctx)
     ctx->scantable = interlaced ? ff_prores_interlaced_scan
                                 : ff_prores_progressive_scan;
     ff_fdctdsp_init(&ctx->fdsp, avctx);
+    ff_proresencdsp_init(&ctx->dsp);
 
     mps = ctx->mbs_per_slice;
     if (mps & (mps - 1)) {
@@ -0,0 +1,42 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "proresencdsp.h"
+
+static int quantize_c(int16_t *levels, const int16_t *blocks,
+                      int nb_blocks, const int16_t *qmat)
+{
+    int i, j, error = 0;
+
+    for (i = 0; i < nb_blocks; i++, blocks += 64, levels += 64) {
+        levels[0] = blocks[0] / qmat[0];
+        for (j = 1; j < 64; j++) {
+            levels[j] = blocks[j] / qmat[j];
+            error    += FFABS(blocks[j]) % qmat[j];
+        }
+    }
+
+    return error;
+}
+
+av_cold void ff_proresencdsp_init(ProresEncDSPContext *c)
+{
+    c->quantize = quantize_c;
+}
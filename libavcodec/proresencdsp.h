@@ -0,0 +1,42 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PRORESENCDSP_H
+#define AVCODEC_PRORESENCDSP_H
+
+#include <stdint.h>
+
+typedef struct ProresEncDSPContext {
+    /**
+     * Quantize the coefficients of consecutive 8x8 blocks, truncating
+     * towards zero like the C division.
+     *
+     * @param levels    output, quantized coefficients in the order of blocks
+     * @param blocks    input coefficients, 64 per block (aligned to 16 bytes)
+     * @param nb_blocks number of blocks
+     * @param qmat      quantizer of each coefficient, in range [2, 32767]
+     * @return          sum of the absolute quantization remainders of all
+     *                  coefficients except the DC ones
+     */
+    int (*quantize)(int16_t *levels, const int16_t *blocks,
+                    int nb_blocks, const int16_t *qmat);
+} ProresEncDSPContext;
+
+void ff_proresencdsp_init(ProresEncDSPContext *c);
+
+#endif /* AVCODEC_PRORESENCDSP_H */
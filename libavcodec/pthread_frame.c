@@ -44,6 +44,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -94,6 +95,9 @@ typedef struct PerThreadContext {
     int     got_frame;              ///< The output of got_picture_ptr from the last avcodec_decode_video() call.
     int     result;                 ///< The result of the last codec decode/encode() call.
 
+    int64_t submit_time;            ///< av_gettime_relative() when the packet was submitted.
+    int64_t decoded_time;           ///< av_gettime_relative() when decoding of the packet returned.
+
     atomic_int state;
 
 #if FF_API_THREAD_SAFE_CALLBACKS
@@ -145,6 +149,9 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    int max_in_flight;             ///< Low-delay mode: maximum number of frames in flight, 0 if disabled.
+    int nb_in_flight;              ///< Number of submitted packets whose output was not returned yet.
 } FrameThreadContext;
 
 #if FF_API_THREAD_SAFE_CALLBACKS
@@ -217,6 +224,8 @@ FF_ENABLE_DEPRECATION_WARNINGS
         av_frame_unref(p->frame);
         p->got_frame = 0;
         p->result = codec->decode(avctx, p->frame, &p->got_frame, p->avpkt);
+        if (avctx->export_side_data & AV_CODEC_EXPORT_DATA_FRAME_LATENCY)
+            p->decoded_time = av_gettime_relative();
 
         if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
             if (avctx->codec->caps_internal & FF_CODEC_CAP_ALLOCATE_PROGRESS)
@@ -451,6 +460,8 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
         av_log(p->avctx, AV_LOG_ERROR, "av_packet_ref() failed in submit_packet()\n");
         return ret;
     }
+    if (p->avctx->export_side_data & AV_CODEC_EXPORT_DATA_FRAME_LATENCY)
+        p->submit_time = av_gettime_relative();
 
     atomic_store(&p->state, STATE_SETTING_UP);
     pthread_cond_signal(&p->input_cond);
@@ -500,6 +511,78 @@ FF_ENABLE_DEPRECATION_WARNINGS
     return 0;
 }
 
+/**
+ * Move the output of a frame thread which finished decoding to the user.
+ */
+static int return_thread_output(AVCodecContext *avctx, PerThreadContext *p,
+                                AVFrame *picture, int *got_picture_ptr)
+{
+    int err = p->result;
+
+    av_frame_move_ref(picture, p->frame);
+    *got_picture_ptr = p->got_frame;
+    picture->pkt_dts = p->avpkt->dts;
+
+    if (*got_picture_ptr &&
+        avctx->export_side_data & AV_CODEC_EXPORT_DATA_FRAME_LATENCY) {
+        av_dict_set_int(&picture->metadata, "lavc.decode_latency",
+                        p->decoded_time - p->submit_time, 0);
+        av_dict_set_int(&picture->metadata, "lavc.output_latency",
+                        av_gettime_relative() - p->submit_time, 0);
+    }
+
+    /*
+     * A later call with avkpt->size == 0 may loop over all threads,
+     * including this one, searching for a frame/error to return before being
+     * stopped by the "finished != fctx->next_finished" condition.
+     * Make sure we don't mistakenly return the same frame/error again.
+     */
+    p->got_frame = 0;
+    p->result = 0;
+
+    return err;
+}
+
+/**
+ * Low-delay mode: return the output of the oldest thread once
+ * max_in_flight frames are being decoded, or the next frame when draining.
+ * When to wait depends only on the packets submitted, not on how fast the
+ * threads decode, so the output does not depend on timing.
+ */
+static int receive_low_delay(AVCodecContext *avctx, AVFrame *picture,
+                             int *got_picture_ptr, int draining)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    PerThreadContext *p = NULL;
+    int err = 0;
+
+    *got_picture_ptr = 0;
+
+    while (fctx->nb_in_flight) {
+        p = &fctx->threads[fctx->next_finished];
+
+        if (atomic_load(&p->state) != STATE_INPUT_READY) {
+            pthread_mutex_lock(&p->progress_mutex);
+            while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
+                pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+            pthread_mutex_unlock(&p->progress_mutex);
+        }
+
+        err = return_thread_output(avctx, p, picture, got_picture_ptr);
+        if (++fctx->next_finished >= avctx->thread_count)
+            fctx->next_finished = 0;
+        fctx->nb_in_flight--;
+
+        if (!draining || *got_picture_ptr || err < 0)
+            break;
+    }
+
+    if (p)
+        update_context_from_thread(avctx, p->avctx, 1);
+
+    return err;
+}
+
 int ff_thread_decode_frame(AVCodecContext *avctx,
                            AVFrame *picture, int *got_picture_ptr,
                            AVPacket *avpkt)
@@ -513,6 +596,25 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
      * go forward while we are in this function */
     async_unlock(fctx);
 
+    if (fctx->max_in_flight) {
+        int next_decoding = fctx->next_decoding;
+
+        p = &fctx->threads[next_decoding];
+        err = submit_packet(p, avctx, avpkt);
+        if (err)
+            goto finish;
+        fctx->nb_in_flight += fctx->next_decoding != next_decoding;
+        if (fctx->next_decoding >= avctx->thread_count)
+            fctx->next_decoding = 0;
+
+        *got_picture_ptr = 0;
+        if (fctx->nb_in_flight >= fctx->max_in_flight || !avpkt->size)
+            err = receive_low_delay(avctx, picture, got_picture_ptr, !avpkt->size);
+        if (err >= 0)
+            err = avpkt->size;
+        goto finish;
+    }
+
     /*
      * Submit a packet to the next decoding thread.
      */
@@ -554,19 +656,7 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
             pthread_mutex_unlock(&p->progress_mutex);
         }
 
-        av_frame_move_ref(picture, p->frame);
-        *got_picture_ptr = p->got_frame;
-        picture->pkt_dts = p->avpkt->dts;
-        err = p->result;
-
-        /*
-         * A later call with avkpt->size == 0 may loop over all threads,
-         * including this one, searching for a frame/error to return before being
-         * stopped by the "finished != fctx->next_finished" condition.
-         * Make sure we don't mistakenly return the same frame/error again.
-         */
-        p->got_frame = 0;
-        p->result = 0;
+        err = return_thread_output(avctx, p, picture, got_picture_ptr);
 
         if (finished >= avctx->thread_count) finished = 0;
     } while (!avpkt->size && !*got_picture_ptr && err >= 0 && finished != fctx->next_finished);
@@ -729,6 +819,8 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
             }
             if (codec->close && p->thread_init != UNINITIALIZED)
                 codec->close(ctx);
+            if (ctx->internal->slice_thread_ctx)
+                ff_slice_thread_free(ctx);
 
 #if FF_API_THREAD_SAFE_CALLBACKS
             release_delayed_buffers(p);
@@ -875,8 +967,11 @@ int ff_frame_thread_init(AVCodecContext *avctx)
     fctx->async_lock = 1;
     fctx->delaying = 1;
 
+    if (avctx->max_frames_in_flight > 0)
+        fctx->max_in_flight = FFMIN(avctx->max_frames_in_flight, thread_count);
+
     if (codec->type == AVMEDIA_TYPE_VIDEO)
-        avctx->delay = src->thread_count - 1;
+        avctx->delay = (fctx->max_in_flight ? fctx->max_in_flight : thread_count) - 1;
 
     fctx->threads = av_calloc(thread_count, sizeof(*fctx->threads));
     if (!fctx->threads) {
@@ -914,6 +1009,7 @@ void ff_thread_flush(AVCodecContext *avctx)
     }
 
     fctx->next_decoding = fctx->next_finished = 0;
+    fctx->nb_in_flight = 0;
     fctx->delaying = 1;
     fctx->prev_thread = NULL;
     for (i = 0; i < avctx->thread_count; i++) {
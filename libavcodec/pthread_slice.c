@@ -48,6 +48,7 @@ typedef struct SliceThreadContext {
     void *args;
     int *rets;
     int job_size;
+    int nb_threads;
 
     int *entries;
     int entries_count;
@@ -58,14 +59,14 @@ typedef struct SliceThreadContext {
 
 static void main_function(void *priv) {
     AVCodecContext *avctx = priv;
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->mainfunc(avctx);
 }
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
 {
     AVCodecContext *avctx = priv;
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     int ret;
 
     ret = c->func ? c->func(avctx, (char *)c->args + c->job_size * jobnr)
@@ -76,7 +77,7 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 
 void ff_slice_thread_free(AVCodecContext *avctx)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     int i;
 
     avpriv_slicethread_free(&c->thread);
@@ -89,12 +90,12 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     av_freep(&c->entries);
     av_freep(&c->progress_mutex);
     av_freep(&c->progress_cond);
-    av_freep(&avctx->internal->thread_ctx);
+    av_freep(&avctx->internal->slice_thread_ctx);
 }
 
 static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
 
     if (!(avctx->active_thread_type&FF_THREAD_SLICE) || avctx->thread_count <= 1)
         return avcodec_default_execute(avctx, func, arg, ret, job_count, job_size);
@@ -113,25 +114,50 @@ static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, i
 
 static int thread_execute2(AVCodecContext *avctx, action_func2* func2, void *arg, int *ret, int job_count)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->func2 = func2;
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
 int ff_slice_thread_execute_with_mainfunc(AVCodecContext *avctx, action_func2* func2, main_func *mainfunc, void *arg, int *ret, int job_count)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->func2 = func2;
     c->mainfunc = mainfunc;
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
-int ff_slice_thread_init(AVCodecContext *avctx)
+static int slice_thread_init(AVCodecContext *avctx, int thread_count)
 {
     SliceThreadContext *c;
-    int thread_count = avctx->thread_count;
     void (*mainfunc)(void *);
 
+    avctx->internal->slice_thread_ctx = c = av_mallocz(sizeof(*c));
+    mainfunc = avctx->codec->caps_internal & FF_CODEC_CAP_SLICE_THREAD_HAS_MF ? &main_function : NULL;
+    /* the main function runs concurrently with the jobs, and synced jobs run
+     * concurrently with each other, which the shared pool cannot guarantee */
+    if (c && (avctx->thread_type & FF_THREAD_SHARED) && !mainfunc &&
+        !(avctx->codec->caps_internal & FF_CODEC_CAP_SLICE_THREAD_SYNC))
+        thread_count = avpriv_slicethread_create_shared(&c->thread, avctx, worker_func, thread_count);
+    else if (c)
+        thread_count = avpriv_slicethread_create(&c->thread, avctx, worker_func, mainfunc, thread_count);
+    if (!c || thread_count <= 1) {
+        if (c)
+            avpriv_slicethread_free(&c->thread);
+        av_freep(&avctx->internal->slice_thread_ctx);
+        return 1;
+    }
+    c->nb_threads = thread_count;
+
+    avctx->execute = thread_execute;
+    avctx->execute2 = thread_execute2;
+    return thread_count;
+}
+
+int ff_slice_thread_init(AVCodecContext *avctx)
+{
+    int thread_count = avctx->thread_count;
+
     // We cannot do this in the encoder init as the threads are created before
     if (av_codec_is_encoder(avctx->codec) &&
         avctx->codec_id == AV_CODEC_ID_MPEG1VIDEO &&
@@ -154,26 +180,31 @@ int ff_slice_thread_init(AVCodecContext *avctx)
         return 0;
     }
 
-    avctx->internal->thread_ctx = c = av_mallocz(sizeof(*c));
-    mainfunc = avctx->codec->caps_internal & FF_CODEC_CAP_SLICE_THREAD_HAS_MF ? &main_function : NULL;
-    if (!c || (thread_count = avpriv_slicethread_create(&c->thread, avctx, worker_func, mainfunc, thread_count)) <= 1) {
-        if (c)
-            avpriv_slicethread_free(&c->thread);
-        av_freep(&avctx->internal->thread_ctx);
+    thread_count = slice_thread_init(avctx, thread_count);
+    if (thread_count <= 1) {
         avctx->thread_count = 1;
         avctx->active_thread_type = 0;
         return 0;
     }
     avctx->thread_count = thread_count;
-
-    avctx->execute = thread_execute;
-    avctx->execute2 = thread_execute2;
     return 0;
 }
 
+int ff_slice_thread_init_nested(AVCodecContext *avctx, int thread_count)
+{
+    if (!(avctx->active_thread_type & FF_THREAD_FRAME) || thread_count <= 1)
+        return 1;
+
+    thread_count = slice_thread_init(avctx, thread_count);
+    if (thread_count <= 1)
+        return AVERROR(ENOMEM);
+    avctx->active_thread_type |= FF_THREAD_SLICE;
+    return thread_count;
+}
+
 void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, int n)
 {
-    SliceThreadContext *p = avctx->internal->thread_ctx;
+    SliceThreadContext *p = avctx->internal->slice_thread_ctx;
     int *entries = p->entries;
 
     pthread_mutex_lock(&p->progress_mutex[thread]);
@@ -184,7 +215,7 @@ void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, in
 
 void ff_thread_await_progress2(AVCodecContext *avctx, int field, int thread, int shift)
 {
-    SliceThreadContext *p  = avctx->internal->thread_ctx;
+    SliceThreadContext *p  = avctx->internal->slice_thread_ctx;
     int *entries      = p->entries;
 
     if (!entries || !field) return;
@@ -203,14 +234,14 @@ int ff_alloc_entries(AVCodecContext *avctx, int count)
     int i;
 
     if (avctx->active_thread_type & FF_THREAD_SLICE)  {
-        SliceThreadContext *p = avctx->internal->thread_ctx;
+        SliceThreadContext *p = avctx->internal->slice_thread_ctx;
 
         if (p->entries) {
-            av_assert0(p->thread_count == avctx->thread_count);
+            av_assert0(p->thread_count == p->nb_threads);
             av_freep(&p->entries);
         }
 
-        p->thread_count  = avctx->thread_count;
+        p->thread_count  = p->nb_threads;
         p->entries       = av_calloc(count, sizeof(*p->entries));
 
         if (!p->progress_mutex) {
@@ -237,6 +268,6 @@ int ff_alloc_entries(AVCodecContext *avctx, int count)
 
 void ff_reset_entries(AVCodecContext *avctx)
 {
-    SliceThreadContext *p = avctx->internal->thread_ctx;
+    SliceThreadContext *p = avctx->internal->slice_thread_ctx;
     memset(p->entries, 0, p->entries_count * sizeof(int));
 }
@@ -140,6 +140,19 @@ int ff_slice_thread_execute_with_mainfunc(AVCodecContext *avctx,
         int (*action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr),
         int (*main_func)(AVCodecContext *c), void *arg, int *ret, int job_count);
 void ff_thread_free(AVCodecContext *s);
+
+/**
+ * Set up slice threading for a frame thread, so that a frame-threaded
+ * decoder can additionally split each frame across several threads.
+ * Must be called from the codec's init callback on a frame thread context;
+ * does nothing when frame threading is not active.
+ *
+ * @param avctx        the frame thread's codec context
+ * @param thread_count number of slice threads to run per frame thread
+ * @return the number of slice threads in use (1 if slice threading was not
+ *         set up) or a negative error code
+ */
+int ff_slice_thread_init_nested(AVCodecContext *avctx, int thread_count);
 int ff_alloc_entries(AVCodecContext *avctx, int count);
 void ff_reset_entries(AVCodecContext *avctx);
 void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, int n);
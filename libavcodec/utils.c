@@ -840,6 +840,11 @@ int ff_thread_init(AVCodecContext *s)
     return -1;
 }
 
+int ff_slice_thread_init_nested(AVCodecContext *avctx, int thread_count)
+{
+    return 1;
+}
+
 #endif
 
 unsigned int av_xiphlacing(unsigned char *s, unsigned int v)
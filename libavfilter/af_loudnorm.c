@@ -31,6 +31,7 @@ enum FrameType {
     INNER_FRAME,
     FINAL_FRAME,
     LINEAR_MODE,
+    LOOKAHEAD_MODE,
     FRAME_NB
 };
 
@@ -62,6 +63,7 @@ typedef struct LoudNormContext {
     int linear;
     int dual_mono;
     enum PrintFormat print_format;
+    double lookahead;
 
     double *buf;
     int buf_size;
@@ -91,8 +93,24 @@ typedef struct LoudNormContext {
     int prev_nb_samples;
     int channels;
 
+    int lookahead_size;
+    int latency;
+    int in_trim;
+    int eof;
+    int started;
+    int block_size;
+    int block_cnt;
+    int64_t nb_samples_in;
+    double gain;
+    double prev_gain;
+    double env;
+    double env_step;
+    double env_target;
+    int hold;
+
     FFEBUR128State *r128_in;
     FFEBUR128State *r128_out;
+    FFEBUR128TruePeak *tp;
 } LoudNormContext;
 
 #define OFFSET(x) offsetof(LoudNormContext, x)
@@ -119,6 +137,7 @@ static const AVOption loudnorm_options[] = {
     {     "none",         0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  NONE},     0,         0,  FLAGS, "print_format" },
     {     "json",         0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  JSON},     0,         0,  FLAGS, "print_format" },
     {     "summary",      0,                                   0,                        AV_OPT_TYPE_CONST,   {.i64 =  SUMMARY},  0,         0,  FLAGS, "print_format" },
+    { "lookahead",        "set look-ahead in ms for low latency mode", OFFSET(lookahead), AV_OPT_TYPE_DOUBLE,  {.dbl =  0.},      0.,     1000.,  FLAGS },
     { NULL }
 };
 
@@ -164,6 +183,20 @@ static double gaussian_filter(LoudNormContext *s, int index)
     return result;
 }
 
+static double gaussian_filter_causal(LoudNormContext *s, int index)
+{
+    double result = 0., total_weight = 0.;
+    int i;
+
+    index = index - 10 >= 0 ? index - 10 : index + 20;
+    for (i = 0; i <= 10; i++) {
+        result += s->delta[((index + i) < 30) ? (index + i) : (index + i - 30)] * s->weights[i];
+        total_weight += s->weights[i];
+    }
+
+    return result / total_weight;
+}
+
 static void detect_peak(LoudNormContext *s, int offset, int nb_samples, int channels, int *peak_delta, double *peak_value)
 {
     int n, c, i, index;
@@ -406,6 +439,228 @@ static void true_peak_limiter(LoudNormContext *s, double *out, int nb_samples, i
     }
 }
 
+static void lookahead_update_gain(LoudNormContext *s, int sample_rate)
+{
+    double loudness, global, relative_threshold, env_global, env_shortterm;
+    int n;
+
+    s->prev_gain = s->gain;
+
+    if (s->nb_samples_in < frame_size(sample_rate, 400))
+        return;
+
+    if (s->nb_samples_in < frame_size(sample_rate, 3000))
+        ff_ebur128_loudness_momentary(s->r128_in, &loudness);
+    else
+        ff_ebur128_loudness_shortterm(s->r128_in, &loudness);
+
+    if (!s->started) {
+        if (loudness < s->measured_thresh) {
+            s->above_threshold = 0;
+            env_shortterm = loudness <= -70. ? 0. : s->target_i - s->measured_i;
+        } else {
+            s->above_threshold = 1;
+            env_shortterm = loudness <= -70. ? 0. : s->target_i - loudness;
+        }
+
+        for (n = 0; n < 30; n++)
+            s->delta[n] = pow(10., env_shortterm / 20.);
+        s->prev_delta = s->delta[s->index];
+        s->started = 1;
+    } else {
+        ff_ebur128_loudness_global(s->r128_in, &global);
+        ff_ebur128_relative_threshold(s->r128_in, &relative_threshold);
+
+        if (s->above_threshold == 0) {
+            double shortterm_out;
+
+            if (loudness > s->measured_thresh)
+                s->prev_delta *= 1.0058;
+
+            ff_ebur128_loudness_shortterm(s->r128_out, &shortterm_out);
+            if (shortterm_out >= s->target_i)
+                s->above_threshold = 1;
+        }
+
+        if (loudness < relative_threshold || loudness <= -70. || s->above_threshold == 0) {
+            s->delta[s->index] = s->prev_delta;
+        } else {
+            env_global = fabs(loudness - global) < (s->target_lra / 2.) ? loudness - global : (s->target_lra / 2.) * ((loudness - global) < 0 ? -1 : 1);
+            env_shortterm = s->target_i - loudness;
+            s->delta[s->index] = pow(10., (env_global + env_shortterm) / 20.);
+        }
+        s->prev_delta = s->delta[s->index];
+    }
+
+    s->gain = gaussian_filter_causal(s, s->index);
+    s->index++;
+    if (s->index >= 30)
+        s->index -= 30;
+}
+
+static void lookahead_limiter_update(LoudNormContext *s, double peak, int horizon)
+{
+    double gain, predicted;
+
+    if (peak <= s->target_tp)
+        return;
+
+    gain = s->target_tp / peak;
+
+    if (s->env_step < 0.)
+        predicted = FFMAX(s->env_target, s->env + s->env_step * horizon);
+    else if (s->env_step > 0.)
+        predicted = FFMIN(s->env_target, s->env + s->env_step * horizon);
+    else
+        predicted = s->env;
+
+    /* The peak leaves the delay line in horizon samples, make sure the
+     * envelope has reached the required reduction by then without raising
+     * it for the samples already queued. */
+    if (gain < predicted) {
+        const double step = (gain - s->env) / horizon;
+
+        if (s->env_step < 0.) {
+            s->env_step   = FFMIN(s->env_step, step);
+            s->env_target = FFMIN(s->env_target, gain);
+        } else {
+            s->env_step   = step;
+            s->env_target = gain;
+        }
+    }
+
+    s->hold = FFMAX(s->hold, horizon + 1);
+}
+
+static double lookahead_limiter_advance(LoudNormContext *s)
+{
+    if (s->hold > 0)
+        s->hold--;
+
+    if (s->env_step != 0.) {
+        s->env += s->env_step;
+        if ((s->env_step < 0. && s->env <= s->env_target) ||
+            (s->env_step > 0. && s->env >= s->env_target)) {
+            s->env      = s->env_target;
+            s->env_step = 0.;
+        }
+    }
+
+    if (s->env_step == 0. && !s->hold && s->env < 1.) {
+        s->env_target = 1.;
+        s->env_step   = (1. - s->env) / s->release_length;
+    }
+
+    return s->env;
+}
+
+static void lookahead_process(LoudNormContext *s, const double *src, double *dst, int nb_samples)
+{
+    const int channels = s->channels;
+    const int horizon = s->lookahead_size - ff_ebur128_true_peak_delay(s->tp);
+    const double ceiling = s->target_tp;
+    int n, c;
+
+    for (n = 0; n < nb_samples; n++) {
+        const double gain = (s->prev_gain + (((double) s->block_cnt / s->block_size) * (s->gain - s->prev_gain))) * s->offset;
+        double *smp = s->buf + s->buf_index;
+        double env;
+
+        for (c = 0; c < channels; c++) {
+            const double delayed = smp[c];
+
+            smp[c] = src[c] * gain;
+            dst[c] = delayed;
+        }
+
+        lookahead_limiter_update(s, ff_ebur128_true_peak_add_frame(s->tp, smp), horizon);
+        env = lookahead_limiter_advance(s);
+
+        for (c = 0; c < channels; c++) {
+            dst[c] *= env;
+            if (fabs(dst[c]) > ceiling)
+                dst[c] = ceiling * (dst[c] < 0 ? -1 : 1);
+        }
+
+        s->buf_index += channels;
+        if (s->buf_index >= s->buf_size)
+            s->buf_index = 0;
+
+        s->block_cnt++;
+        src += channels;
+        dst += channels;
+    }
+}
+
+static int filter_frame_lookahead(AVFilterLink *inlink, AVFrame *in)
+{
+    AVFilterContext *ctx = inlink->dst;
+    LoudNormContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    const int channels = inlink->channels;
+    AVFrame *out;
+    double *dst;
+    int n, len, trim;
+
+    if (av_frame_is_writable(in)) {
+        out = in;
+    } else {
+        out = ff_get_audio_buffer(outlink, in->nb_samples);
+        if (!out) {
+            av_frame_free(&in);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_copy_props(out, in);
+    }
+
+    if (s->pts == AV_NOPTS_VALUE)
+        s->pts = in->pts;
+
+    dst = (double *)out->data[0];
+
+    for (n = 0; n < in->nb_samples; n += len) {
+        const double *src = (const double *)in->data[0] + n * channels;
+
+        len = FFMIN(in->nb_samples - n, s->block_size - s->block_cnt);
+
+        if (!s->eof) {
+            ff_ebur128_add_frames_double(s->r128_in, src, len);
+            s->nb_samples_in += len;
+        }
+
+        lookahead_process(s, src, dst + n * channels, len);
+
+        if (s->block_cnt >= s->block_size) {
+            s->block_cnt = 0;
+            if (!s->eof)
+                lookahead_update_gain(s, inlink->sample_rate);
+        }
+    }
+
+    if (in != out)
+        av_frame_free(&in);
+
+    /* Drop the samples that only flushed the initial silence out of the
+     * delay line, so that output timestamps match the input ones. */
+    trim = FFMIN(s->in_trim, out->nb_samples);
+    if (trim > 0) {
+        memmove(dst, dst + trim * channels, (out->nb_samples - trim) * channels * sizeof(*dst));
+        out->nb_samples -= trim;
+        s->in_trim      -= trim;
+    }
+
+    if (!out->nb_samples) {
+        av_frame_free(&out);
+        return 0;
+    }
+
+    out->pts = s->pts;
+    s->pts  += out->nb_samples;
+    ff_ebur128_add_frames_double(s->r128_out, dst, out->nb_samples);
+
+    return ff_filter_frame(outlink, out);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -420,6 +675,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     double gain, gain_next, env_global, env_shortterm,
     global, shortterm, lra, relative_threshold;
 
+    if (s->frame_type == LOOKAHEAD_MODE)
+        return filter_frame_lookahead(inlink, in);
+
     if (av_frame_is_writable(in)) {
         out = in;
     } else {
@@ -644,7 +902,18 @@ static int request_frame(AVFilterLink *outlink)
     LoudNormContext *s = ctx->priv;
 
     ret = ff_request_frame(inlink);
-    if (ret == AVERROR_EOF && s->frame_type == INNER_FRAME) {
+    if (ret == AVERROR_EOF && s->frame_type == LOOKAHEAD_MODE &&
+        !s->eof && s->pts != AV_NOPTS_VALUE) {
+        AVFrame *frame = ff_get_audio_buffer(outlink, s->lookahead_size);
+
+        if (!frame)
+            return AVERROR(ENOMEM);
+        av_samples_set_silence(frame->extended_data, 0, frame->nb_samples,
+                               frame->channels, frame->format);
+
+        s->eof = 1;
+        ret = filter_frame(inlink, frame);
+    } else if (ret == AVERROR_EOF && s->frame_type == INNER_FRAME) {
         double *src;
         double *buf;
         int nb_samples, n, c, offset;
@@ -700,7 +969,7 @@ static int query_formats(AVFilterContext *ctx)
     if (ret < 0)
         return ret;
 
-    if (s->frame_type != LINEAR_MODE) {
+    if (s->frame_type != LINEAR_MODE && s->frame_type != LOOKAHEAD_MODE) {
         formats = ff_make_format_list(input_srate);
         if (!formats)
             return AVERROR(ENOMEM);
@@ -733,8 +1002,33 @@ static int config_input(AVFilterLink *inlink)
         ff_ebur128_set_channel(s->r128_out, 0, FF_EBUR128_DUAL_MONO);
     }
 
-    s->buf_size = frame_size(inlink->sample_rate, 3000) * inlink->channels;
-    s->buf = av_malloc_array(s->buf_size, sizeof(*s->buf));
+    ff_ebur128_set_filter_context(s->r128_in,  ctx);
+    ff_ebur128_set_filter_context(s->r128_out, ctx);
+
+    if (s->frame_type == LOOKAHEAD_MODE) {
+        s->tp = ff_ebur128_true_peak_init(inlink->channels, inlink->sample_rate);
+        if (!s->tp)
+            return AVERROR(ENOMEM);
+
+        s->lookahead_size = FFMAX(lrint(inlink->sample_rate * s->lookahead / 1000.),
+                                  ff_ebur128_true_peak_delay(s->tp) + 1);
+        s->in_trim    = s->lookahead_size;
+        s->block_size = frame_size(inlink->sample_rate, 100);
+        s->env        =
+        s->env_target = 1.;
+        s->gain       =
+        s->prev_gain  = s->measured_i != 0. ? pow(10., (s->target_i - s->measured_i) / 20.) : 1.;
+        s->buf_size   = s->lookahead_size * inlink->channels;
+
+        s->latency    = s->lookahead_size;
+
+        av_log(ctx, AV_LOG_VERBOSE, "look-ahead latency: %d samples\n", s->lookahead_size);
+    } else {
+        s->buf_size = frame_size(inlink->sample_rate, 3000) * inlink->channels;
+        s->latency  = s->frame_type == LINEAR_MODE ? 0 : frame_size(inlink->sample_rate, 3000);
+    }
+
+    s->buf = av_calloc(s->buf_size, sizeof(*s->buf));
     if (!s->buf)
         return AVERROR(ENOMEM);
 
@@ -749,7 +1043,7 @@ static int config_input(AVFilterLink *inlink)
 
     init_gaussian_filter(s);
 
-    if (s->frame_type != LINEAR_MODE) {
+    if (s->frame_type != LINEAR_MODE && s->frame_type != LOOKAHEAD_MODE) {
         inlink->min_samples =
         inlink->max_samples = frame_size(inlink->sample_rate, 3000);
     }
@@ -787,6 +1081,9 @@ static av_cold int init(AVFilterContext *ctx)
         }
     }
 
+    if (s->frame_type != LINEAR_MODE && s->lookahead > 0.)
+        s->frame_type = LOOKAHEAD_MODE;
+
     return 0;
 }
 
@@ -835,7 +1132,8 @@ static av_cold void uninit(AVFilterContext *ctx)
             "\t\"output_lra\" : \"%.2f\",\n"
             "\t\"output_thresh\" : \"%.2f\",\n"
             "\t\"normalization_type\" : \"%s\",\n"
-            "\t\"target_offset\" : \"%.2f\"\n"
+            "\t\"target_offset\" : \"%.2f\",\n"
+            "\t\"latency\" : \"%d\"\n"
             "}\n",
             i_in,
             20. * log10(tp_in),
@@ -846,7 +1144,8 @@ static av_cold void uninit(AVFilterContext *ctx)
             lra_out,
             thresh_out,
             s->frame_type == LINEAR_MODE ? "linear" : "dynamic",
-            s->target_i - i_out
+            s->target_i - i_out,
+            s->latency
         );
         break;
 
@@ -864,7 +1163,8 @@ static av_cold void uninit(AVFilterContext *ctx)
             "Output Threshold:   %+6.1f LUFS\n"
             "\n"
             "Normalization Type:   %s\n"
-            "Target Offset:      %+6.1f LU\n",
+            "Target Offset:      %+6.1f LU\n"
+            "Latency:            %6d samples\n",
             i_in,
             20. * log10(tp_in),
             lra_in,
@@ -874,7 +1174,8 @@ static av_cold void uninit(AVFilterContext *ctx)
             lra_out,
             thresh_out,
             s->frame_type == LINEAR_MODE ? "Linear" : "Dynamic",
-            s->target_i - i_out
+            s->target_i - i_out,
+            s->latency
         );
         break;
     }
@@ -884,6 +1185,7 @@ end:
         ff_ebur128_destroy(&s->r128_in);
     if (s->r128_out)
         ff_ebur128_destroy(&s->r128_out);
+    ff_ebur128_true_peak_destroy(&s->tp);
     av_freep(&s->limiter_buf);
     av_freep(&s->prev_smp);
     av_freep(&s->buf);
@@ -913,6 +1215,7 @@ const AVFilter ff_af_loudnorm = {
     .priv_class    = &loudnorm_class,
     .init          = init,
     .uninit        = uninit,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(avfilter_af_loudnorm_inputs),
     FILTER_OUTPUTS(avfilter_af_loudnorm_outputs),
     FILTER_QUERY_FUNC(query_formats),
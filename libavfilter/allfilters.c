@@ -481,6 +481,7 @@ extern const AVFilter ff_vf_vidstabdetect;
 extern const AVFilter ff_vf_vidstabtransform;
 extern const AVFilter ff_vf_vif;
 extern const AVFilter ff_vf_vignette;
+extern const AVFilter ff_vf_vmaf;
 extern const AVFilter ff_vf_vmafmotion;
 extern const AVFilter ff_vf_vpp_qsv;
 extern const AVFilter ff_vf_vstack;
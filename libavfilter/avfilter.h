@@ -396,6 +396,14 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Run the slice threads of the graph on the process-wide worker pool shared
+ * with the other graphs, codecs and scalers which opted into it, instead of
+ * spawning threads for this graph. Only meaningful in
+ * AVFilterGraph.thread_type, together with AVFILTER_THREAD_SLICE.
+ */
+#define AVFILTER_THREAD_SHARED (1 << 1)
+
 typedef struct AVFilterInternal AVFilterInternal;
 
 /** An instance of a filter */
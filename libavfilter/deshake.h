@@ -24,6 +24,7 @@
 
 #include "config.h"
 #include "avfilter.h"
+#include "motion_estimation.h"
 #include "transform.h"
 #include "libavutil/pixelutils.h"
 
@@ -57,6 +58,10 @@ typedef struct DeshakeContext {
     int counts[2*MAX_R+1][2*MAX_R+1]; /// < Scratch buffer for motion search
     double *angles;            ///< Scratch buffer for block angles
     unsigned angles_size;
+    IntMotionVector *mvs;      ///< Scratch buffer for block motion vectors
+    unsigned mvs_size;
+    int b_width, b_height;     ///< Number of searched blocks
+    AVMotionEstContext me_ctx; ///< Block search threading
     AVFrame *ref;              ///< Previous frame
     int rx;                    ///< Maximum horizontal shift
     int ry;                    ///< Maximum vertical shift
@@ -473,6 +473,20 @@ static void blend_pixel(uint8_t *dst, unsigned src, unsigned alpha,
     *dst = ((0x1010101 - alpha) * *dst + alpha * src) >> 24;
 }
 
+/* Same as blend_line_hv() for an 8-bit mask on a plane without subsampling,
+   written so that the compiler can vectorize it. */
+static void blend_line_mask8(uint8_t *dst, int dst_delta,
+                             unsigned src, unsigned alpha,
+                             const uint8_t *mask, int w)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned a = mask[x] * alpha;
+        dst[x * dst_delta] = ((0x1010101 - a) * dst[x * dst_delta] + a * src) >> 24;
+    }
+}
+
 static void blend_line_hv16(uint8_t *dst, int dst_delta,
                             unsigned src, unsigned alpha,
                             const uint8_t *mask, int mask_linesize, int l2depth, int w,
@@ -580,7 +594,16 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 p += dst_linesize[plane];
                 m += top * mask_linesize;
             }
-            if (depth <= 8) {
+            if (depth <= 8 && l2depth == 3 &&
+                !draw->hsub[plane] && !draw->vsub[plane]) {
+                for (y = 0; y < h_sub; y++) {
+                    blend_line_mask8(p, draw->pixelstep[plane],
+                                     color->comp[plane].u8[comp], alpha,
+                                     m + xm0, w_sub);
+                    p += dst_linesize[plane];
+                    m += mask_linesize;
+                }
+            } else if (depth <= 8) {
                 for (y = 0; y < h_sub; y++) {
                     blend_line_hv(p, draw->pixelstep[plane],
                                   color->comp[plane].u8[comp], alpha,
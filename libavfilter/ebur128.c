@@ -52,6 +52,8 @@
 #include "libavutil/mem_internal.h"
 #include "libavutil/thread.h"
 
+#include "internal.h"
+
 #define CHECK_ERROR(condition, errorcode, goto_point)                          \
     if ((condition)) {                                                         \
         errcode = (errorcode);                                                 \
@@ -65,7 +67,8 @@
 #define MINUS_20DB            pow(10.0, -20.0 / 10.0)
 
 struct FFEBUR128StateInternal {
-    /** Filtered audio data (used as ring buffer). */
+    /** Filtered audio data (used as ring buffer), one plane of
+     *  audio_data_frames samples per channel. */
     double *audio_data;
     /** Size of audio_data array. */
     size_t audio_data_frames;
@@ -96,6 +99,15 @@ struct FFEBUR128StateInternal {
     unsigned long window;
     /** Data pointer array for interleaved data */
     void **data_ptrs;
+    /** Filter context whose slice threads process the channels, may be NULL. */
+    AVFilterContext *ctx;
+    /** Arguments of the current per-channel filter or gating block job. */
+    const void **srcs;
+    size_t src_index;
+    size_t frames;
+    int stride;
+    /** Per-channel energy sums of the current gating block. */
+    double *channel_sum;
 };
 
 static AVOnce histogram_init = AV_ONCE_INIT;
@@ -279,9 +291,14 @@ FFEBUR128State *ff_ebur128_init(unsigned int channels,
     st->d->data_ptrs = av_malloc_array(channels, sizeof(*st->d->data_ptrs));
     CHECK_ERROR(!st->d->data_ptrs, 0,
                 free_short_term_block_energy_histogram);
+    st->d->channel_sum = av_malloc_array(channels, sizeof(*st->d->channel_sum));
+    CHECK_ERROR(!st->d->channel_sum, 0, free_data_ptrs);
+    st->d->ctx = NULL;
 
     return st;
 
+free_data_ptrs:
+    av_free(st->d->data_ptrs);
 free_short_term_block_energy_histogram:
     av_free(st->d->short_term_block_energy_histogram);
 free_block_energy_histogram:
@@ -308,59 +325,99 @@ void ff_ebur128_destroy(FFEBUR128State ** st)
     av_free((*st)->d->channel_map);
     av_free((*st)->d->sample_peak);
     av_free((*st)->d->data_ptrs);
+    av_free((*st)->d->channel_sum);
     av_free((*st)->d);
     av_free(*st);
     *st = NULL;
 }
 
+static void ebur128_execute(FFEBUR128State *st, avfilter_action_func *func)
+{
+    unsigned int c;
+
+    if (st->d->ctx && st->channels > 1) {
+        ff_filter_execute(st->d->ctx, func, st, NULL, st->channels);
+    } else {
+        for (c = 0; c < st->channels; c++)
+            func(NULL, st, c, st->channels);
+    }
+}
+
+void ff_ebur128_set_filter_context(FFEBUR128State *st, AVFilterContext *ctx)
+{
+    st->d->ctx = ctx;
+}
+
 #define EBUR128_FILTER(type, scaling_factor)                                       \
-static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,           \
-                                  size_t src_index, size_t frames,                 \
-                                  int stride) {                                    \
-    double* audio_data = st->d->audio_data + st->d->audio_data_index;              \
-    size_t i, c;                                                                   \
+static int ebur128_filter_channel_##type(AVFilterContext *ctx, void *arg,          \
+                                         int jobnr, int nb_jobs)                   \
+{                                                                                  \
+    FFEBUR128State *st = arg;                                                      \
+    const int c = jobnr;                                                           \
+    const type *src = (const type *)st->d->srcs[c] + st->d->src_index;             \
+    const size_t frames = st->d->frames;                                           \
+    const int stride = st->d->stride;                                              \
+    double *audio_data = st->d->audio_data + c * st->d->audio_data_frames +        \
+                         st->d->audio_data_index / st->channels;                   \
+    const double *a = st->d->a, *b = st->d->b;                                     \
+    double v0, v1, v2, v3, v4;                                                     \
+    int ci = st->d->channel_map[c] - 1;                                            \
+    size_t i;                                                                      \
                                                                                    \
     if ((st->mode & FF_EBUR128_MODE_SAMPLE_PEAK) == FF_EBUR128_MODE_SAMPLE_PEAK) { \
-        for (c = 0; c < st->channels; ++c) {                                       \
-            double max = 0.0;                                                      \
-            for (i = 0; i < frames; ++i) {                                         \
-                type v = srcs[c][src_index + i * stride];                          \
-                if (v > max) {                                                     \
-                    max =        v;                                                \
-                } else if (-v > max) {                                             \
-                    max = -1.0 * v;                                                \
-                }                                                                  \
+        double max = 0.0;                                                          \
+        for (i = 0; i < frames; ++i) {                                             \
+            type v = src[i * stride];                                              \
+            if (v > max) {                                                         \
+                max =        v;                                                    \
+            } else if (-v > max) {                                                 \
+                max = -1.0 * v;                                                    \
             }                                                                      \
-            max /= scaling_factor;                                                 \
-            if (max > st->d->sample_peak[c]) st->d->sample_peak[c] = max;          \
         }                                                                          \
+        max /= scaling_factor;                                                     \
+        if (max > st->d->sample_peak[c]) st->d->sample_peak[c] = max;              \
     }                                                                              \
-    for (c = 0; c < st->channels; ++c) {                                           \
-        int ci = st->d->channel_map[c] - 1;                                        \
-        if (ci < 0) continue;                                                      \
-        else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */            \
-        for (i = 0; i < frames; ++i) {                                             \
-            st->d->v[ci][0] = (double) (srcs[c][src_index + i * stride] / scaling_factor) \
-                         - st->d->a[1] * st->d->v[ci][1]                           \
-                         - st->d->a[2] * st->d->v[ci][2]                           \
-                         - st->d->a[3] * st->d->v[ci][3]                           \
-                         - st->d->a[4] * st->d->v[ci][4];                          \
-            audio_data[i * st->channels + c] =                                     \
-                           st->d->b[0] * st->d->v[ci][0]                           \
-                         + st->d->b[1] * st->d->v[ci][1]                           \
-                         + st->d->b[2] * st->d->v[ci][2]                           \
-                         + st->d->b[3] * st->d->v[ci][3]                           \
-                         + st->d->b[4] * st->d->v[ci][4];                          \
-            st->d->v[ci][4] = st->d->v[ci][3];                                     \
-            st->d->v[ci][3] = st->d->v[ci][2];                                     \
-            st->d->v[ci][2] = st->d->v[ci][1];                                     \
-            st->d->v[ci][1] = st->d->v[ci][0];                                     \
-        }                                                                          \
-        st->d->v[ci][4] = fabs(st->d->v[ci][4]) < DBL_MIN ? 0.0 : st->d->v[ci][4]; \
-        st->d->v[ci][3] = fabs(st->d->v[ci][3]) < DBL_MIN ? 0.0 : st->d->v[ci][3]; \
-        st->d->v[ci][2] = fabs(st->d->v[ci][2]) < DBL_MIN ? 0.0 : st->d->v[ci][2]; \
-        st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1]; \
+    if (ci < 0) return 0;                                                          \
+    else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */                \
+    v0 = st->d->v[ci][0];                                                          \
+    v1 = st->d->v[ci][1];                                                          \
+    v2 = st->d->v[ci][2];                                                          \
+    v3 = st->d->v[ci][3];                                                          \
+    v4 = st->d->v[ci][4];                                                          \
+    /* keep the filter state in locals so that it can stay in registers */         \
+    for (i = 0; i < frames; ++i) {                                                 \
+        v0 = (double) (src[i * stride] / scaling_factor)                           \
+                     - a[1] * v1                                                   \
+                     - a[2] * v2                                                   \
+                     - a[3] * v3                                                   \
+                     - a[4] * v4;                                                  \
+        audio_data[i] =                                                            \
+                       b[0] * v0                                                   \
+                     + b[1] * v1                                                   \
+                     + b[2] * v2                                                   \
+                     + b[3] * v3                                                   \
+                     + b[4] * v4;                                                  \
+        v4 = v3;                                                                   \
+        v3 = v2;                                                                   \
+        v2 = v1;                                                                   \
+        v1 = v0;                                                                   \
     }                                                                              \
+    st->d->v[ci][0] = v0;                                                          \
+    st->d->v[ci][4] = fabs(v4) < DBL_MIN ? 0.0 : v4;                               \
+    st->d->v[ci][3] = fabs(v3) < DBL_MIN ? 0.0 : v3;                               \
+    st->d->v[ci][2] = fabs(v2) < DBL_MIN ? 0.0 : v2;                               \
+    st->d->v[ci][1] = fabs(v1) < DBL_MIN ? 0.0 : v1;                               \
+    return 0;                                                                      \
+}                                                                                  \
+                                                                                   \
+static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,           \
+                                  size_t src_index, size_t frames,                 \
+                                  int stride) {                                    \
+    st->d->srcs      = (const void **)srcs;                                        \
+    st->d->src_index = src_index;                                                  \
+    st->d->frames    = frames;                                                     \
+    st->d->stride    = stride;                                                     \
+    ebur128_execute(st, ebur128_filter_channel_##type);                            \
 }
 EBUR128_FILTER(double, 1.0)
 
@@ -387,40 +444,53 @@ static size_t find_histogram_index(double energy)
     return index_min;
 }
 
+static int ebur128_calc_channel_sum(AVFilterContext *ctx, void *arg,
+                                    int jobnr, int nb_jobs)
+{
+    FFEBUR128State *st = arg;
+    const size_t frames_per_block = st->d->frames;
+    const double *audio_data = st->d->audio_data + jobnr * st->d->audio_data_frames;
+    const size_t channels = st->channels;
+    double channel_sum = 0.0;
+    size_t i;
+
+    if (st->d->channel_map[jobnr] == FF_EBUR128_UNUSED)
+        return 0;
+    if (st->d->audio_data_index < frames_per_block * channels) {
+        for (i = 0; i < st->d->audio_data_index / channels; ++i) {
+            channel_sum += audio_data[i] * audio_data[i];
+        }
+        for (i = st->d->audio_data_frames -
+             (frames_per_block -
+              st->d->audio_data_index / channels);
+             i < st->d->audio_data_frames; ++i) {
+            channel_sum += audio_data[i] * audio_data[i];
+        }
+    } else {
+        for (i = st->d->audio_data_index / channels - frames_per_block;
+             i < st->d->audio_data_index / channels; ++i) {
+            channel_sum += audio_data[i] * audio_data[i];
+        }
+    }
+    st->d->channel_sum[jobnr] = channel_sum;
+    return 0;
+}
+
 static void ebur128_calc_gating_block(FFEBUR128State * st,
                                       size_t frames_per_block,
                                       double *optional_output)
 {
-    size_t i, c;
+    size_t c;
     double sum = 0.0;
     double channel_sum;
+
+    st->d->frames = frames_per_block;
+    ebur128_execute(st, ebur128_calc_channel_sum);
+
     for (c = 0; c < st->channels; ++c) {
         if (st->d->channel_map[c] == FF_EBUR128_UNUSED)
             continue;
-        channel_sum = 0.0;
-        if (st->d->audio_data_index < frames_per_block * st->channels) {
-            for (i = 0; i < st->d->audio_data_index / st->channels; ++i) {
-                channel_sum += st->d->audio_data[i * st->channels + c] *
-                    st->d->audio_data[i * st->channels + c];
-            }
-            for (i = st->d->audio_data_frames -
-                 (frames_per_block -
-                  st->d->audio_data_index / st->channels);
-                 i < st->d->audio_data_frames; ++i) {
-                channel_sum += st->d->audio_data[i * st->channels + c] *
-                    st->d->audio_data[i * st->channels + c];
-            }
-        } else {
-            for (i =
-                 st->d->audio_data_index / st->channels - frames_per_block;
-                 i < st->d->audio_data_index / st->channels; ++i) {
-                channel_sum +=
-                    st->d->audio_data[i * st->channels +
-                                      c] * st->d->audio_data[i *
-                                                             st->channels +
-                                                             c];
-            }
-        }
+        channel_sum = st->d->channel_sum[c];
         if (st->d->channel_map[c] == FF_EBUR128_Mp110 ||
             st->d->channel_map[c] == FF_EBUR128_Mm110 ||
             st->d->channel_map[c] == FF_EBUR128_Mp060 ||
@@ -613,6 +683,21 @@ static int ebur128_energy_shortterm(FFEBUR128State * st, double *out)
                                       out);
 }
 
+int ff_ebur128_loudness_momentary(FFEBUR128State * st, double *out)
+{
+    double energy;
+    int error = ebur128_energy_in_interval(st, st->d->samples_in_100ms * 4,
+                                           &energy);
+    if (error) {
+        return error;
+    } else if (energy <= 0.0) {
+        *out = -HUGE_VAL;
+        return 0;
+    }
+    *out = ebur128_energy_to_loudness(energy);
+    return 0;
+}
+
 int ff_ebur128_loudness_shortterm(FFEBUR128State * st, double *out)
 {
     double energy;
@@ -722,3 +807,103 @@ int ff_ebur128_sample_peak(FFEBUR128State * st,
     *out = st->d->sample_peak[channel_number];
     return 0;
 }
+
+#define TRUE_PEAK_TAPS 12
+
+/* 48 tap, 4x oversampling interpolation filter from ITU-R BS.1770-4 Annex 2,
+ * split into its four polyphase components. */
+static const double true_peak_coeffs[4][TRUE_PEAK_TAPS] = {
+    {  0.0017089843750,  0.0109863281250, -0.0196533203125,  0.0332031250000,
+      -0.0594482421875,  0.1373291015625,  0.9721679687500, -0.1022949218750,
+       0.0476074218750, -0.0266113281250,  0.0148925781250, -0.0083007812500 },
+    { -0.0291748046875,  0.0292968750000, -0.0517578125000,  0.0891113281250,
+      -0.1665039062500,  0.4650878906250,  0.7797851562500, -0.2003173828125,
+       0.1015625000000, -0.0582275390625,  0.0330810546875, -0.0189208984375 },
+    { -0.0189208984375,  0.0330810546875, -0.0582275390625,  0.1015625000000,
+      -0.2003173828125,  0.7797851562500,  0.4650878906250, -0.1665039062500,
+       0.0891113281250, -0.0517578125000,  0.0292968750000, -0.0291748046875 },
+    { -0.0083007812500,  0.0148925781250, -0.0266113281250,  0.0476074218750,
+      -0.1022949218750,  0.9721679687500,  0.1373291015625, -0.0594482421875,
+       0.0332031250000, -0.0196533203125,  0.0109863281250,  0.0017089843750 },
+};
+
+struct FFEBUR128TruePeak {
+    unsigned int channels;
+    /** Oversampling factor, 1 if the sample rate is high enough. */
+    int factor;
+    /** Position of the newest sample in the history. */
+    int pos;
+    /** Last TRUE_PEAK_TAPS samples of each channel, stored twice. */
+    double *history;
+};
+
+FFEBUR128TruePeak *ff_ebur128_true_peak_init(unsigned int channels,
+                                             unsigned long samplerate)
+{
+    FFEBUR128TruePeak *tp;
+
+    if (!channels)
+        return NULL;
+
+    tp = av_mallocz(sizeof(*tp));
+    if (!tp)
+        return NULL;
+
+    tp->history = av_calloc(channels, 2 * TRUE_PEAK_TAPS * sizeof(*tp->history));
+    if (!tp->history) {
+        av_free(tp);
+        return NULL;
+    }
+
+    tp->channels = channels;
+    tp->factor   = samplerate < 96000 ? 4 : samplerate < 192000 ? 2 : 1;
+
+    return tp;
+}
+
+void ff_ebur128_true_peak_destroy(FFEBUR128TruePeak **tp)
+{
+    if (!*tp)
+        return;
+    av_freep(&(*tp)->history);
+    av_freep(tp);
+}
+
+int ff_ebur128_true_peak_delay(const FFEBUR128TruePeak *tp)
+{
+    return tp->factor > 1 ? TRUE_PEAK_TAPS / 2 : 0;
+}
+
+double ff_ebur128_true_peak_add_frame(FFEBUR128TruePeak *tp, const double *src)
+{
+    const int step = 4 / tp->factor;
+    double peak = 0.;
+    unsigned int c;
+    int p, i;
+
+    if (tp->factor == 1) {
+        for (c = 0; c < tp->channels; c++)
+            peak = FFMAX(peak, fabs(src[c]));
+        return peak;
+    }
+
+    tp->pos = tp->pos ? tp->pos - 1 : TRUE_PEAK_TAPS - 1;
+
+    for (c = 0; c < tp->channels; c++) {
+        double *h = tp->history + c * 2 * TRUE_PEAK_TAPS;
+        const double *x = h + tp->pos;
+
+        h[tp->pos] = h[tp->pos + TRUE_PEAK_TAPS] = src[c];
+
+        for (p = 0; p < 4; p += step) {
+            const double *coeffs = true_peak_coeffs[p];
+            double v = 0.;
+
+            for (i = 0; i < TRUE_PEAK_TAPS; i++)
+                v += coeffs[i] * x[i];
+            peak = FFMAX(peak, fabs(v));
+        }
+    }
+
+    return peak;
+}
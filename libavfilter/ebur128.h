@@ -32,6 +32,8 @@
 
 #include <stddef.h>             /* for size_t */
 
+struct AVFilterContext;
+
 /** \enum channel
  *  Use these values when setting the channel map with ebur128_set_channel().
  *  See definitions in ITU R-REC-BS 1770-4
@@ -81,7 +83,7 @@ enum channel {
  *  modes that suit your needs, as performance will be better.
  */
 enum mode {
-  /** can resurrrect and call ff_ebur128_loudness_momentary */
+  /** can call ff_ebur128_loudness_momentary */
     FF_EBUR128_MODE_M = (1 << 0),
   /** can call ff_ebur128_loudness_shortterm */
     FF_EBUR128_MODE_S = (1 << 1) | FF_EBUR128_MODE_M,
@@ -125,6 +127,17 @@ FFEBUR128State *ff_ebur128_init(unsigned int channels,
  */
 void ff_ebur128_destroy(FFEBUR128State ** st);
 
+/** \brief Process the channels in parallel.
+ *
+ *  The per-channel filtering and energy computations are distributed over
+ *  the slice threads of the given filter context. The results do not depend
+ *  on the number of threads.
+ *
+ *  @param st library state.
+ *  @param ctx filter context to use for threading, NULL to disable.
+ */
+void ff_ebur128_set_filter_context(FFEBUR128State *st, struct AVFilterContext *ctx);
+
 /** \brief Set channel type.
  *
  *  The default is:
@@ -165,6 +178,16 @@ void ff_ebur128_add_frames_double(FFEBUR128State * st,
  */
 int ff_ebur128_loudness_global(FFEBUR128State * st, double *out);
 
+/** \brief Get momentary loudness (last 400ms) in LUFS.
+ *
+ *  @param st library state.
+ *  @param out momentary loudness in LUFS. -HUGE_VAL if result is negative
+ *             infinity.
+ *  @return
+ *    - 0 on success.
+ */
+int ff_ebur128_loudness_momentary(FFEBUR128State * st, double *out);
+
 /** \brief Get short-term loudness (last 3s) in LUFS.
  *
  *  @param st library state.
@@ -226,4 +249,41 @@ int ff_ebur128_sample_peak(FFEBUR128State * st,
  */
 int ff_ebur128_relative_threshold(FFEBUR128State * st, double *out);
 
+/** \brief Streaming true peak estimator.
+ *
+ *  Interpolates the signal with the ITU-R BS.1770 oversampling filter at the
+ *  native sample rate, without buffering more than the filter length.
+ */
+typedef struct FFEBUR128TruePeak FFEBUR128TruePeak;
+
+/** \brief Initialize a true peak estimator.
+ *
+ *  @param channels the number of channels.
+ *  @param samplerate the sample rate, used to select the oversampling factor.
+ *  @return an initialized estimator or NULL on failure.
+ */
+FFEBUR128TruePeak *ff_ebur128_true_peak_init(unsigned int channels,
+                                             unsigned long samplerate);
+
+/** \brief Destroy a true peak estimator.
+ *
+ *  @param tp pointer to an estimator, set to NULL on return.
+ */
+void ff_ebur128_true_peak_destroy(FFEBUR128TruePeak **tp);
+
+/** \brief Get the delay of the estimator in samples.
+ *
+ *  The value returned by ff_ebur128_true_peak_add_frame() describes the
+ *  signal around the sample added this many calls earlier.
+ */
+int ff_ebur128_true_peak_delay(const FFEBUR128TruePeak *tp);
+
+/** \brief Add one frame of interleaved samples.
+ *
+ *  @param tp true peak estimator.
+ *  @param src one sample of each channel.
+ *  @return the highest absolute interpolated value over all channels.
+ */
+double ff_ebur128_true_peak_add_frame(FFEBUR128TruePeak *tp, const double *src);
+
 #endif                          /* AVFILTER_EBUR128_H */
@@ -479,6 +479,7 @@ static int config_audio_output(AVFilterLink *outlink)
         av_opt_set_int(ebur128->swr_ctx, "out_channel_layout",    outlink->channel_layout, 0);
         av_opt_set_int(ebur128->swr_ctx, "out_sample_rate",       192000, 0);
         av_opt_set_sample_fmt(ebur128->swr_ctx, "out_sample_fmt", outlink->format, 0);
+        av_opt_set_int(ebur128->swr_ctx, "threads", ff_filter_get_nb_threads(ctx), 0);
 
         ret = swr_init(ebur128->swr_ctx);
         if (ret < 0)
@@ -598,39 +599,159 @@ static int gate_update(struct integrator *integ, double power,
     return gate_hist_pos;
 }
 
+typedef struct ThreadData {
+    const double *samples;
+    const double *swr_samples;
+    int nb_samples;
+    int bin_id_400, bin_id_3000;
+} ThreadData;
+
+#if CONFIG_SWRESAMPLE
+static int true_peaks_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EBUR128Context *ebur128 = ctx->priv;
+    ThreadData *td = arg;
+    const int nb_channels = ebur128->nb_channels;
+    const int start = (nb_channels *  jobnr     ) / nb_jobs;
+    const int end   = (nb_channels * (jobnr + 1)) / nb_jobs;
+
+    for (int ch = start; ch < end; ch++) {
+        const double *swr_samples = td->swr_samples + ch;
+        double true_peak = ebur128->true_peaks[ch];
+        double true_peak_per_frame = 0.0;
+
+        for (int i = 0; i < td->nb_samples; i++) {
+            true_peak           = FFMAX(true_peak,           fabs(*swr_samples));
+            true_peak_per_frame = FFMAX(true_peak_per_frame, fabs(*swr_samples));
+            swr_samples += nb_channels;
+        }
+        ebur128->true_peaks[ch]           = true_peak;
+        ebur128->true_peaks_per_frame[ch] = true_peak_per_frame;
+    }
+
+    return 0;
+}
+#endif
+
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EBUR128Context *ebur128 = ctx->priv;
+    ThreadData *td = arg;
+    const int nb_channels = ebur128->nb_channels;
+    const int start = (nb_channels *  jobnr     ) / nb_jobs;
+    const int end   = (nb_channels * (jobnr + 1)) / nb_jobs;
+    const double *pre_b = ebur128->pre_b, *pre_a = ebur128->pre_a;
+    const double *rlb_b = ebur128->rlb_b, *rlb_a = ebur128->rlb_a;
+
+    for (int ch = start; ch < end; ch++) {
+        const double *samples = td->samples + ch;
+        double *cache_400  = ebur128->i400.cache[ch];
+        double *cache_3000 = ebur128->i3000.cache[ch];
+        int bin_id_400  = td->bin_id_400;
+        int bin_id_3000 = td->bin_id_3000;
+        double x0, x1, x2, y0, y1, y2, z0, z1, z2;
+        double sum_400, sum_3000;
+
+        if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
+            double peak = ebur128->sample_peaks[ch];
+            for (int i = 0; i < td->nb_samples; i++)
+                peak = FFMAX(peak, fabs(samples[i * nb_channels]));
+            ebur128->sample_peaks[ch] = peak;
+        }
+
+        if (!ebur128->ch_weighting[ch]) {
+            ebur128->x[ch * 3] = samples[(td->nb_samples - 1) * nb_channels]; // set X[i]
+            continue;
+        }
+
+        /* The filter states are kept in locals, the operations are the same
+         * and in the same order as the per-sample version. */
+        x0 = ebur128->x[ch * 3]; x1 = ebur128->x[ch * 3 + 1]; x2 = ebur128->x[ch * 3 + 2];
+        y0 = ebur128->y[ch * 3]; y1 = ebur128->y[ch * 3 + 1]; y2 = ebur128->y[ch * 3 + 2];
+        z0 = ebur128->z[ch * 3]; z1 = ebur128->z[ch * 3 + 1]; z2 = ebur128->z[ch * 3 + 2];
+        sum_400  = ebur128->i400.sum[ch];
+        sum_3000 = ebur128->i3000.sum[ch];
+
+        for (int i = 0; i < td->nb_samples; i++) {
+            double bin;
+
+            x0 = samples[i * nb_channels]; // set X[i]
+
+            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+            // TODO: merge both filters in one?
+            y2 = y1; // apply pre-filter
+            y1 = y0;
+            y0 = x0*pre_b[0] + x1*pre_b[1] + x2*pre_b[2] - y1*pre_a[1] - y2*pre_a[2];
+            x2 = x1;
+            x1 = x0;
+            z2 = z1; // apply RLB-filter
+            z1 = z0;
+            z0 = y0*rlb_b[0] + y1*rlb_b[1] + y2*rlb_b[2] - z1*rlb_a[1] - z2*rlb_a[2];
+
+            bin = z0 * z0;
+
+            /* add the new value, and limit the sum to the cache size (400ms or 3s)
+             * by removing the oldest one */
+            sum_400  = sum_400  + bin - cache_400 [bin_id_400];
+            sum_3000 = sum_3000 + bin - cache_3000[bin_id_3000];
+
+            /* override old cache entry with the new value */
+            cache_400 [bin_id_400 ] = bin;
+            cache_3000[bin_id_3000] = bin;
+
+            if (++bin_id_400  == ebur128->i400.cache_size)
+                bin_id_400  = 0;
+            if (++bin_id_3000 == ebur128->i3000.cache_size)
+                bin_id_3000 = 0;
+        }
+
+        ebur128->x[ch * 3] = x0; ebur128->x[ch * 3 + 1] = x1; ebur128->x[ch * 3 + 2] = x2;
+        ebur128->y[ch * 3] = y0; ebur128->y[ch * 3 + 1] = y1; ebur128->y[ch * 3 + 2] = y2;
+        ebur128->z[ch * 3] = z0; ebur128->z[ch * 3 + 1] = z1; ebur128->z[ch * 3 + 2] = z2;
+        ebur128->i400.sum[ch]  = sum_400;
+        ebur128->i3000.sum[ch] = sum_3000;
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
-    int i, ch, idx_insample;
+    int i, ch, idx_insample, seg_end = 0;
     AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
     const int nb_channels = ebur128->nb_channels;
     const int nb_samples  = insamples->nb_samples;
     const double *samples = (double *)insamples->data[0];
     AVFrame *pic = ebur128->outpicref;
+    ThreadData td;
 
 #if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        const double *swr_samples = ebur128->swr_buf;
         int ret = swr_convert(ebur128->swr_ctx, (uint8_t**)&ebur128->swr_buf, 19200,
                               (const uint8_t **)insamples->data, nb_samples);
         if (ret < 0)
             return ret;
-        for (ch = 0; ch < nb_channels; ch++)
-            ebur128->true_peaks_per_frame[ch] = 0.0;
-        for (idx_insample = 0; idx_insample < ret; idx_insample++) {
-            for (ch = 0; ch < nb_channels; ch++) {
-                ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], fabs(*swr_samples));
-                ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch],
-                                                          fabs(*swr_samples));
-                swr_samples++;
-            }
-        }
+        td.swr_samples = ebur128->swr_buf;
+        td.nb_samples  = ret;
+        ff_filter_execute(ctx, true_peaks_channels, &td, NULL,
+                          FFMIN(nb_channels, ff_filter_get_nb_threads(ctx)));
     }
 #endif
 
     for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
-        const int bin_id_400  = ebur128->i400.cache_pos;
-        const int bin_id_3000 = ebur128->i3000.cache_pos;
+        /* filter all the samples up to the next loudness computation at
+         * once, each channel separately */
+        if (idx_insample == seg_end) {
+            td.samples     = samples + idx_insample * nb_channels;
+            td.nb_samples  = FFMIN(nb_samples - idx_insample,
+                                   inlink->sample_rate / 10 - ebur128->sample_count);
+            td.bin_id_400  = ebur128->i400.cache_pos;
+            td.bin_id_3000 = ebur128->i3000.cache_pos;
+            ff_filter_execute(ctx, filter_channels, &td, NULL,
+                              FFMIN(nb_channels, ff_filter_get_nb_threads(ctx)));
+            seg_end += td.nb_samples;
+        }
 
 #define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
     ebur128->i##time.cache_pos++;                           \
@@ -644,45 +765,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
         MOVE_TO_NEXT_CACHED_ENTRY(400);
         MOVE_TO_NEXT_CACHED_ENTRY(3000);
 
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
-
-            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(*samples));
-
-            ebur128->x[ch * 3] = *samples++; // set X[i]
-
-            if (!ebur128->ch_weighting[ch])
-                continue;
-
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, NUM, DEN) do {                                             \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*NUM[0] + src[1]*NUM[1] + src[2]*NUM[2]              \
-                                   - dst[1]*DEN[1] - dst[2]*DEN[2];             \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, ebur128->pre_b, ebur128->pre_a);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, ebur128->rlb_b, ebur128->rlb_a);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
-            /* add the new value, and limit the sum to the cache size (400ms or 3s)
-             * by removing the oldest one */
-            ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
-            ebur128->i3000.sum[ch] = ebur128->i3000.sum[ch] + bin - ebur128->i3000.cache[ch][bin_id_3000];
-
-            /* override old cache entry with the new value */
-            ebur128->i400.cache [ch][bin_id_400 ] = bin;
-            ebur128->i3000.cache[ch][bin_id_3000] = bin;
-        }
-
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
@@ -1029,5 +1111,5 @@ const AVFilter ff_af_ebur128 = {
     .outputs       = NULL,
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &ebur128_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
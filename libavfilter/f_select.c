@@ -150,6 +150,10 @@ typedef struct SelectContext {
     int nb_planes;
     ptrdiff_t width[4];
     ptrdiff_t height[4];
+    ptrdiff_t ds_width[4];          ///< plane widths in the analysis         (scene detect only)
+    ptrdiff_t ds_height[4];         ///< plane heights in the analysis        (scene detect only)
+    int step;                       ///< distance between two pixels in samples (scene detect only)
+    int downscale;                  ///< log2 of the analysis downscaling     (scene detect only)
     int do_scene_detect;            ///< 1 if the expression requires scene detection variables, 0 otherwise
     ff_scene_sad_fn sad;            ///< Sum of the absolute difference function (scene detect only)
     double prev_mafd;               ///< previous MAFD                           (scene detect only)
@@ -160,14 +164,11 @@ typedef struct SelectContext {
 } SelectContext;
 
 #define OFFSET(x) offsetof(SelectContext, x)
-#define DEFINE_OPTIONS(filt_name, FLAGS)                            \
-static const AVOption filt_name##_options[] = {                     \
+#define COMMON_OPTIONS(FLAGS)                                       \
     { "expr", "set an expression to use for selecting frames", OFFSET(expr_str), AV_OPT_TYPE_STRING, { .str = "1" }, .flags=FLAGS }, \
     { "e",    "set an expression to use for selecting frames", OFFSET(expr_str), AV_OPT_TYPE_STRING, { .str = "1" }, .flags=FLAGS }, \
     { "outputs", "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS }, \
-    { "n",       "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS }, \
-    { NULL }                                                            \
-}
+    { "n",       "set the number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, {.i64 = 1}, 1, INT_MAX, .flags=FLAGS },
 
 static int request_frame(AVFilterLink *outlink);
 
@@ -264,6 +265,14 @@ static int config_input(AVFilterLink *inlink)
         select->sad = ff_scene_sad_get_fn(select->bitdepth == 8 ? 8 : 16);
         if (!select->sad)
             return AVERROR(EINVAL);
+
+        select->step = desc->comp[0].step / ((select->bitdepth + 7) / 8);
+        while ((inlink->w >> select->downscale) < 1 || (inlink->h >> select->downscale) < 1)
+            select->downscale--;
+        memcpy(select->ds_width,  select->width,  sizeof(select->width));
+        memcpy(select->ds_height, select->height, sizeof(select->height));
+        ff_scene_downscale_dims(select->ds_width, select->ds_height, select->step,
+                                select->nb_planes, select->downscale);
     }
     return 0;
 }
@@ -273,31 +282,36 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     double ret = 0;
     SelectContext *select = ctx->priv;
     AVFrame *prev_picref = select->prev_picref;
+    AVFrame *cur = frame;
+
+    if (select->downscale) {
+        cur = ff_scene_downscale(ctx, frame, select->ds_width, select->ds_height,
+                                 select->step, select->nb_planes,
+                                 select->bitdepth, select->downscale);
+        if (!cur)
+            return 0;
+    }
 
     if (prev_picref &&
-        frame->height == prev_picref->height &&
-        frame->width  == prev_picref->width) {
-        uint64_t sad = 0;
+        cur->height == prev_picref->height &&
+        cur->width  == prev_picref->width) {
+        uint64_t sad;
         double mafd, diff;
         uint64_t count = 0;
 
-        for (int plane = 0; plane < select->nb_planes; plane++) {
-            uint64_t plane_sad;
-            select->sad(prev_picref->data[plane], prev_picref->linesize[plane],
-                    frame->data[plane], frame->linesize[plane],
-                    select->width[plane], select->height[plane], &plane_sad);
-            sad += plane_sad;
-            count += select->width[plane] * select->height[plane];
-        }
+        sad = ff_scene_sad_frame(ctx, select->sad, prev_picref, cur,
+                                 select->ds_width, select->ds_height,
+                                 select->nb_planes);
+        for (int plane = 0; plane < select->nb_planes; plane++)
+            count += select->ds_width[plane] * select->ds_height[plane];
 
-        emms_c();
         mafd = (double)sad / count / (1ULL << (select->bitdepth - 8));
         diff = fabs(mafd - select->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff) / 100., 0, 1);
         select->prev_mafd = mafd;
-        av_frame_free(&prev_picref);
     }
-    select->prev_picref = av_frame_clone(frame);
+    av_frame_free(&select->prev_picref);
+    select->prev_picref = cur == frame ? av_frame_clone(frame) : cur;
     return ret;
 }
 
@@ -441,7 +455,10 @@ static av_cold void uninit(AVFilterContext *ctx)
 
 #if CONFIG_ASELECT_FILTER
 
-DEFINE_OPTIONS(aselect, AV_OPT_FLAG_AUDIO_PARAM|AV_OPT_FLAG_FILTERING_PARAM);
+static const AVOption aselect_options[] = {
+    COMMON_OPTIONS(AV_OPT_FLAG_AUDIO_PARAM|AV_OPT_FLAG_FILTERING_PARAM)
+    { NULL }
+};
 AVFILTER_DEFINE_CLASS(aselect);
 
 static av_cold int aselect_init(AVFilterContext *ctx)
@@ -502,7 +519,12 @@ static int query_formats(AVFilterContext *ctx)
     }
 }
 
-DEFINE_OPTIONS(select, AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM);
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+static const AVOption select_options[] = {
+    COMMON_OPTIONS(FLAGS)
+    { "scene_downscale", "set the log2 of the scene detection downscaling factor", OFFSET(downscale), AV_OPT_TYPE_INT, {.i64 = 0}, 0, 4, .flags=FLAGS },
+    { NULL }
+};
 AVFILTER_DEFINE_CLASS(select);
 
 static av_cold int select_init(AVFilterContext *ctx)
@@ -533,6 +555,7 @@ const AVFilter ff_vf_select = {
     .priv_class    = &select_class,
     FILTER_INPUTS(avfilter_vf_select_inputs),
     FILTER_QUERY_FUNC(query_formats),
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_METADATA_ONLY |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_SELECT_FILTER */
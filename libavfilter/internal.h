@@ -370,6 +370,12 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The slice threading jobs of the filter may wait on higher numbered jobs of
+ * the same execute call, so they are never run on the shared worker pool.
+ */
+#define FF_FILTER_FLAG_SLICE_THREAD_SYNC (1 << 1)
+
 /**
  * Run one round of processing on a filter graph.
  */
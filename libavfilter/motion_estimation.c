@@ -18,8 +18,31 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
+
+#include "config.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "internal.h"
 #include "motion_estimation.h"
 
+typedef struct MERowSync {
+    atomic_int progress;        ///< number of finished blocks in the row
+#if HAVE_THREADS
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+} MERowSync;
+
+typedef struct METhreadData {
+    AVMotionEstContext *me_ctx;
+    AVMotionEstBlockFn fn;
+    void *opaque;
+    int b_width;
+    int wavefront;
+} METhreadData;
+
 static const int8_t sqr1[8][2]  = {{ 0,-1}, { 0, 1}, {-1, 0}, { 1, 0}, {-1,-1}, {-1, 1}, { 1,-1}, { 1, 1}};
 static const int8_t dia1[4][2]  = {{-1, 0}, { 0,-1}, { 1, 0}, { 0, 1}};
 static const int8_t dia2[8][2]  = {{-2, 0}, {-1,-1}, { 0,-2}, { 1,-1}, { 2, 0}, { 1, 1}, { 0, 2}, {-1, 1}};
@@ -54,6 +77,129 @@ void ff_me_init_context(AVMotionEstContext *me_ctx, int mb_size, int search_para
     me_ctx->x_max = x_max;
     me_ctx->y_min = y_min;
     me_ctx->y_max = y_max;
+
+    for (int n = 1; n < FF_ARRAY_ELEMS(me_ctx->sad); n++)
+        me_ctx->sad[n] = av_pixelutils_get_sad_fn(n, n, 0, NULL);
+}
+
+static void free_rows(AVMotionEstContext *me_ctx)
+{
+#if HAVE_THREADS
+    for (int i = 0; i < me_ctx->nb_rows; i++) {
+        pthread_mutex_destroy(&me_ctx->rows[i].mutex);
+        pthread_cond_destroy(&me_ctx->rows[i].cond);
+    }
+#endif
+    me_ctx->nb_rows = 0;
+    av_freep(&me_ctx->rows);
+}
+
+void ff_me_uninit_context(AVMotionEstContext *me_ctx)
+{
+    free_rows(me_ctx);
+}
+
+static int alloc_rows(AVMotionEstContext *me_ctx, int nb_rows)
+{
+    if (me_ctx->nb_rows >= nb_rows)
+        return 0;
+
+    free_rows(me_ctx);
+    me_ctx->rows = av_calloc(nb_rows, sizeof(*me_ctx->rows));
+    if (!me_ctx->rows)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < nb_rows; i++) {
+#if HAVE_THREADS
+        MERowSync *row = &me_ctx->rows[i];
+
+        if (pthread_mutex_init(&row->mutex, NULL))
+            return AVERROR(ENOMEM);
+        if (pthread_cond_init(&row->cond, NULL)) {
+            pthread_mutex_destroy(&row->mutex);
+            return AVERROR(ENOMEM);
+        }
+#endif
+        me_ctx->nb_rows++;
+    }
+
+    return 0;
+}
+
+static void row_wait(MERowSync *row, int progress)
+{
+    if (atomic_load_explicit(&row->progress, memory_order_acquire) >= progress)
+        return;
+
+#if HAVE_THREADS
+    pthread_mutex_lock(&row->mutex);
+    while (atomic_load_explicit(&row->progress, memory_order_acquire) < progress)
+        pthread_cond_wait(&row->cond, &row->mutex);
+    pthread_mutex_unlock(&row->mutex);
+#endif
+}
+
+static void row_report(MERowSync *row, int progress)
+{
+#if HAVE_THREADS
+    pthread_mutex_lock(&row->mutex);
+    atomic_store_explicit(&row->progress, progress, memory_order_release);
+    pthread_cond_broadcast(&row->cond);
+    pthread_mutex_unlock(&row->mutex);
+#else
+    atomic_store_explicit(&row->progress, progress, memory_order_release);
+#endif
+}
+
+static int execute_row(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    METhreadData *td = arg;
+    AVMotionEstContext me_ctx = *td->me_ctx;
+    MERowSync *rows = td->me_ctx->rows;
+    const int mb_y = jobnr;
+
+    for (int mb_x = 0; mb_x < td->b_width; mb_x++) {
+        if (td->wavefront && mb_y > 0)
+            row_wait(&rows[mb_y - 1], FFMIN(mb_x + 2, td->b_width));
+
+        td->fn(&me_ctx, td->opaque, mb_x, mb_y);
+
+        if (td->wavefront)
+            row_report(&rows[mb_y], mb_x + 1);
+    }
+    emms_c();
+
+    return 0;
+}
+
+int ff_me_execute(AVFilterContext *ctx, AVMotionEstContext *me_ctx,
+                  int b_width, int b_height, int wavefront,
+                  AVMotionEstBlockFn fn, void *opaque)
+{
+    METhreadData td = {
+        .me_ctx    = me_ctx,
+        .fn        = fn,
+        .opaque    = opaque,
+        .b_width   = b_width,
+        .wavefront = wavefront,
+    };
+    int ret;
+
+    if (b_width <= 0 || b_height <= 0)
+        return 0;
+
+    if (wavefront) {
+        if ((ret = alloc_rows(me_ctx, b_height)) < 0)
+            return ret;
+        for (int i = 0; i < b_height; i++)
+            atomic_init(&me_ctx->rows[i].progress, 0);
+    }
+
+    /* Rows are started in order, so a row can only wait on a row
+     * that is already being processed by another thread. */
+    ff_filter_execute(ctx, execute_row, &td, NULL, b_height);
+
+    return 0;
 }
 
 uint64_t ff_me_cmp_sad(AVMotionEstContext *me_ctx, int x_mb, int y_mb, int x_mv, int y_mv)
@@ -61,12 +207,16 @@ uint64_t ff_me_cmp_sad(AVMotionEstContext *me_ctx, int x_mb, int y_mb, int x_mv,
     const int linesize = me_ctx->linesize;
     uint8_t *data_ref = me_ctx->data_ref;
     uint8_t *data_cur = me_ctx->data_cur;
+    av_pixelutils_sad_fn sad_fn = ff_me_get_sad_fn(me_ctx, me_ctx->mb_size);
     uint64_t sad = 0;
     int i, j;
 
     data_ref += y_mv * linesize;
     data_cur += y_mb * linesize;
 
+    if (sad_fn)
+        return sad_fn(data_cur + x_mb, linesize, data_ref + x_mv, linesize);
+
     for (j = 0; j < me_ctx->mb_size; j++)
         for (i = 0; i < me_ctx->mb_size; i++)
             sad += FFABS(data_ref[x_mv + i + j * linesize] - data_cur[x_mb + i + j * linesize]);
@@ -22,6 +22,9 @@
 #define AVFILTER_MOTION_ESTIMATION_H
 
 #include "libavutil/avutil.h"
+#include "libavutil/pixelutils.h"
+
+#include "avfilter.h"
 
 #define AV_ME_METHOD_ESA        1
 #define AV_ME_METHOD_TSS        2
@@ -57,13 +60,55 @@ typedef struct AVMotionEstContext {
     int pred_y;     ///< median predictor y
     AVMotionEstPredictor preds[2];
 
+    av_pixelutils_sad_fn sad[6];    ///< SAD of (1 << n) x (1 << n) blocks, NULL if unavailable
+
+    struct MERowSync *rows;         ///< per block row progress for wavefront searches
+    int nb_rows;
+
     uint64_t (*get_cost)(struct AVMotionEstContext *me_ctx, int x_mb, int y_mb,
                          int mv_x, int mv_y);
 } AVMotionEstContext;
 
+/**
+ * Block callback for ff_me_execute().
+ *
+ * @param me_ctx private copy of the motion estimation context for this row
+ */
+typedef void (*AVMotionEstBlockFn)(AVMotionEstContext *me_ctx, void *opaque,
+                                   int mb_x, int mb_y);
+
 void ff_me_init_context(AVMotionEstContext *me_ctx, int mb_size, int search_param,
                         int width, int height, int x_min, int x_max, int y_min, int y_max);
 
+void ff_me_uninit_context(AVMotionEstContext *me_ctx);
+
+/**
+ * Return the SAD function for size x size blocks or NULL if there is none.
+ */
+static inline av_pixelutils_sad_fn ff_me_get_sad_fn(const AVMotionEstContext *me_ctx, int size)
+{
+    int n = av_log2(size);
+
+    if (size != 1 << n || n >= FF_ARRAY_ELEMS(me_ctx->sad))
+        return NULL;
+    return me_ctx->sad[n];
+}
+
+/**
+ * Call fn for every block of a b_width x b_height grid, spreading the block
+ * rows over the filter threads. Every row works on its own copy of me_ctx,
+ * so fn may change the predictors and other search state.
+ *
+ * If wavefront is set, block (mb_x, mb_y) is only processed once blocks
+ * 0 to mb_x + 1 of row mb_y - 1 are done. This allows fn to use the left,
+ * top-left, top and top-right blocks of the current frame as predictors.
+ *
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int ff_me_execute(AVFilterContext *ctx, AVMotionEstContext *me_ctx,
+                  int b_width, int b_height, int wavefront,
+                  AVMotionEstBlockFn fn, void *opaque);
+
 uint64_t ff_me_cmp_sad(AVMotionEstContext *me_ctx, int x_mb, int y_mb, int x_mv, int y_mv);
 
 uint64_t ff_me_search_esa(AVMotionEstContext *me_ctx, int x_mb, int y_mb, int *mv);
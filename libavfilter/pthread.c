@@ -35,6 +35,8 @@
 typedef struct ThreadContext {
     AVFilterGraph *graph;
     AVSliceThread *thread;
+    AVSliceThread *sync_thread;     ///< private threads for the synced filters of a shared graph
+    int shared;
     avfilter_action_func *func;
 
     /* per-execute parameters */
@@ -54,34 +56,51 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    avpriv_slicethread_free(&c->sync_thread);
+}
+
+static int thread_init_internal(ThreadContext *c, AVSliceThread **thread,
+                                int nb_threads, int shared)
+{
+    if (shared)
+        nb_threads = avpriv_slicethread_create_shared(thread, c, worker_func, nb_threads);
+    else
+        nb_threads = avpriv_slicethread_create(thread, c, worker_func, NULL, nb_threads);
+    if (nb_threads <= 1)
+        avpriv_slicethread_free(thread);
+    return FFMAX(nb_threads, 1);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
                           void *arg, int *ret, int nb_jobs)
 {
     ThreadContext *c = ctx->graph->internal->thread;
+    AVSliceThread *thread = c->thread;
 
     if (nb_jobs <= 0)
         return 0;
+
+    /* the shared pool does not run the jobs concurrently, which the jobs of
+     * these filters rely on */
+    if (c->shared && ctx->filter->flags_internal & FF_FILTER_FLAG_SLICE_THREAD_SYNC) {
+        if (!c->sync_thread &&
+            thread_init_internal(c, &c->sync_thread, ctx->graph->nb_threads, 0) <= 1)
+            return AVERROR(ENOMEM);
+        thread = c->sync_thread;
+    }
+
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
-    avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    avpriv_slicethread_execute(thread, nb_jobs, 0);
     return 0;
 }
 
-static int thread_init_internal(ThreadContext *c, int nb_threads)
-{
-    nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
-    if (nb_threads <= 1)
-        avpriv_slicethread_free(&c->thread);
-    return FFMAX(nb_threads, 1);
-}
-
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
+    ThreadContext *c;
     int ret;
 
     if (graph->nb_threads == 1) {
@@ -93,7 +112,9 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     if (!graph->internal->thread)
         return AVERROR(ENOMEM);
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    c = graph->internal->thread;
+    c->shared = !!(graph->thread_type & AVFILTER_THREAD_SHARED);
+    ret = thread_init_internal(c, &c->thread, graph->nb_threads, c->shared);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
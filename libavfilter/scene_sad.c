@@ -21,8 +21,14 @@
  * Scene SAD functions
  */
 
+#include "internal.h"
 #include "scene_sad.h"
 
+/* upper bound on the number of jobs, also keeps the slices from getting
+ * too small for the thread overhead to pay off */
+#define MAX_JOBS      64
+#define MIN_JOB_ROWS  16
+
 void ff_scene_sad16_c(SCENE_SAD_PARAMS)
 {
     uint64_t sad = 0;
@@ -70,3 +76,155 @@ ff_scene_sad_fn ff_scene_sad_get_fn(int depth)
     return sad;
 }
 
+
+typedef struct SADThreadData {
+    ff_scene_sad_fn sad;
+    const AVFrame *src1, *src2;
+    const ptrdiff_t *width, *height;
+    int nb_planes;
+    uint64_t sum[MAX_JOBS];
+} SADThreadData;
+
+static int sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SADThreadData *td = arg;
+    uint64_t sum = 0;
+
+    for (int plane = 0; plane < td->nb_planes; plane++) {
+        const ptrdiff_t stride1 = td->src1->linesize[plane];
+        const ptrdiff_t stride2 = td->src2->linesize[plane];
+        const int slice_start = (td->height[plane] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->height[plane] * (jobnr+1)) / nb_jobs;
+        uint64_t plane_sad;
+
+        if (slice_end <= slice_start)
+            continue;
+        td->sad(td->src1->data[plane] + slice_start * stride1, stride1,
+                td->src2->data[plane] + slice_start * stride2, stride2,
+                td->width[plane], slice_end - slice_start, &plane_sad);
+        sum += plane_sad;
+    }
+    emms_c();
+    td->sum[jobnr] = sum;
+
+    return 0;
+}
+
+uint64_t ff_scene_sad_frame(AVFilterContext *ctx, ff_scene_sad_fn sad,
+                            const AVFrame *src1, const AVFrame *src2,
+                            const ptrdiff_t *width, const ptrdiff_t *height,
+                            int nb_planes)
+{
+    SADThreadData td = { .sad = sad, .src1 = src1, .src2 = src2,
+                         .width = width, .height = height,
+                         .nb_planes = nb_planes };
+    const int nb_jobs = av_clip(FFMIN(height[0] / MIN_JOB_ROWS, ff_filter_get_nb_threads(ctx)),
+                                1, MAX_JOBS);
+    uint64_t sum = 0;
+
+    ff_filter_execute(ctx, sad_slice, &td, NULL, nb_jobs);
+    for (int i = 0; i < nb_jobs; i++)
+        sum += td.sum[i];
+
+    return sum;
+}
+
+void ff_scene_downscale_dims(ptrdiff_t *width, ptrdiff_t *height,
+                             int step, int nb_planes, int log2_factor)
+{
+    for (int plane = 0; plane < nb_planes; plane++) {
+        width[plane]  = ((width[plane] / step) >> log2_factor) * step;
+        height[plane] = height[plane] >> log2_factor;
+    }
+}
+
+typedef struct DownscaleThreadData {
+    const AVFrame *src;
+    AVFrame *dst;
+    const ptrdiff_t *width, *height;
+    int step, nb_planes, depth, log2_factor;
+} DownscaleThreadData;
+
+#define DOWNSCALE_SLICE(name, type)                                             \
+static void name(const DownscaleThreadData *td, int plane,                     \
+                 int slice_start, int slice_end)                               \
+{                                                                              \
+    const ptrdiff_t src_stride = td->src->linesize[plane] / sizeof(type);      \
+    const ptrdiff_t dst_stride = td->dst->linesize[plane] / sizeof(type);      \
+    const int step = td->step, factor = 1 << td->log2_factor;                  \
+    const int shift = 2 * td->log2_factor;                                     \
+    const int nb_pixels = td->width[plane] / step;                             \
+                                                                               \
+    for (int y = slice_start; y < slice_end; y++) {                            \
+        const type *src = (const type *)td->src->data[plane] +                 \
+                          y * factor * src_stride;                             \
+        type *dst = (type *)td->dst->data[plane] + y * dst_stride;             \
+                                                                               \
+        for (int x = 0; x < nb_pixels; x++) {                                  \
+            for (int c = 0; c < step; c++) {                                   \
+                const type *s = src + x * factor * step + c;                   \
+                unsigned sum = 0;                                              \
+                                                                               \
+                for (int i = 0; i < factor; i++) {                             \
+                    for (int j = 0; j < factor; j++)                           \
+                        sum += s[j * step];                                    \
+                    s += src_stride;                                           \
+                }                                                              \
+                dst[x * step + c] = (sum + (1 << shift >> 1)) >> shift;        \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+}
+
+DOWNSCALE_SLICE(downscale_slice8,  uint8_t)
+DOWNSCALE_SLICE(downscale_slice16, uint16_t)
+
+static int downscale_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DownscaleThreadData *td = arg;
+
+    for (int plane = 0; plane < td->nb_planes; plane++) {
+        const int slice_start = (td->height[plane] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->height[plane] * (jobnr+1)) / nb_jobs;
+
+        if (td->depth <= 8)
+            downscale_slice8(td, plane, slice_start, slice_end);
+        else
+            downscale_slice16(td, plane, slice_start, slice_end);
+    }
+
+    return 0;
+}
+
+AVFrame *ff_scene_downscale(AVFilterContext *ctx, const AVFrame *src,
+                            const ptrdiff_t *width, const ptrdiff_t *height,
+                            int step, int nb_planes, int depth, int log2_factor)
+{
+    DownscaleThreadData td;
+    AVFrame *dst = av_frame_alloc();
+    int nb_jobs;
+
+    if (!dst)
+        return NULL;
+    dst->format = src->format;
+    dst->width  = src->width  >> log2_factor;
+    dst->height = src->height >> log2_factor;
+    if (av_frame_get_buffer(dst, 0) < 0) {
+        av_frame_free(&dst);
+        return NULL;
+    }
+
+    td.src         = src;
+    td.dst         = dst;
+    td.width       = width;
+    td.height      = height;
+    td.step        = step;
+    td.nb_planes   = nb_planes;
+    td.depth       = depth;
+    td.log2_factor = log2_factor;
+    nb_jobs = av_clip(FFMIN(height[0] / MIN_JOB_ROWS, ff_filter_get_nb_threads(ctx)),
+                      1, MAX_JOBS);
+    ff_filter_execute(ctx, downscale_slice, &td, NULL, nb_jobs);
+
+    return dst;
+}
@@ -24,6 +24,8 @@
 #ifndef AVFILTER_SCENE_SAD_H
 #define AVFILTER_SCENE_SAD_H
 
+#include "libavutil/frame.h"
+
 #include "avfilter.h"
 
 #define SCENE_SAD_PARAMS const uint8_t *src1, ptrdiff_t stride1, \
@@ -41,4 +43,40 @@ ff_scene_sad_fn ff_scene_sad_get_fn_x86(int depth);
 
 ff_scene_sad_fn ff_scene_sad_get_fn(int depth);
 
+/**
+ * Sum the SAD of the first nb_planes planes of two frames, with the rows
+ * split across the filter threads.
+ *
+ * @param width  width of the planes in samples
+ * @param height height of the planes
+ */
+uint64_t ff_scene_sad_frame(AVFilterContext *ctx, ff_scene_sad_fn sad,
+                            const AVFrame *src1, const AVFrame *src2,
+                            const ptrdiff_t *width, const ptrdiff_t *height,
+                            int nb_planes);
+
+/**
+ * Compute the dimensions of the planes downscaled by 1 << log2_factor.
+ *
+ * @param width  width of the planes in samples, replaced by the downscaled one
+ * @param height height of the planes, replaced by the downscaled one
+ * @param step   distance in samples between two pixels of a plane
+ */
+void ff_scene_downscale_dims(ptrdiff_t *width, ptrdiff_t *height,
+                             int step, int nb_planes, int log2_factor);
+
+/**
+ * Return a new frame holding the first nb_planes planes of src box
+ * downscaled by 1 << log2_factor in both directions, for a cheaper scene
+ * change analysis. The rows are split across the filter threads.
+ *
+ * @param width  width of the downscaled planes in samples
+ * @param height height of the downscaled planes
+ * @param step   distance in samples between two pixels of a plane
+ * @return the downscaled frame, NULL on allocation failure
+ */
+AVFrame *ff_scene_downscale(AVFilterContext *ctx, const AVFrame *src,
+                            const ptrdiff_t *width, const ptrdiff_t *height,
+                            int step, int nb_planes, int depth, int log2_factor);
+
 #endif /* AVFILTER_SCENE_SAD_H */
@@ -25,6 +25,7 @@
 #include "avfilter.h"
 #include "filters.h"
 #include "internal.h"
+#include "scene_sad.h"
 
 #define INPUT_MAIN     0
 #define INPUT_CLEANSRC 1
@@ -52,6 +53,8 @@ typedef struct DecimateContext {
     int nxblocks, nyblocks;
     int bdiffsize;
     int64_t *bdiffs;
+    int nb_threads;
+    ff_scene_sad_fn sad;    ///< block SAD, 8 or 16 bits per sample
 
     /* options */
     int cycle;
@@ -80,9 +83,48 @@ static const AVOption decimate_options[] = {
 
 AVFILTER_DEFINE_CLASS(decimate);
 
-static void calc_diffs(const DecimateContext *dm, struct qitem *q,
+typedef struct ThreadData {
+    const uint8_t *f1p, *f2p;
+    int linesize1, linesize2;
+    int width, height;
+    int hblockx, hblocky;
+} ThreadData;
+
+static int calc_diffs_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const DecimateContext *dm = ctx->priv;
+    const ThreadData *td = arg;
+    const int bps = dm->depth > 8 ? 2 : 1;
+    const int nyblocks = (td->height + td->hblocky - 1) / td->hblocky;
+    const int by_start = (nyblocks *  jobnr     ) / nb_jobs;
+    const int by_end   = (nyblocks * (jobnr + 1)) / nb_jobs;
+    int64_t *bdiffs = dm->bdiffs;
+
+    for (int by = by_start; by < by_end; by++) {
+        const int y = by * td->hblocky;
+        const int h = FFMIN(td->hblocky, td->height - y);
+        const uint8_t *f1p = td->f1p + y * td->linesize1;
+        const uint8_t *f2p = td->f2p + y * td->linesize2;
+        int xdest = 0;
+
+        for (int x = 0; x < td->width; x += td->hblockx) {
+            const int w = FFMIN(td->hblockx, td->width - x);
+            uint64_t sad;
+
+            dm->sad(f1p + x * bps, td->linesize1, f2p + x * bps, td->linesize2,
+                    w, h, &sad);
+            bdiffs[by * dm->nxblocks + xdest] += sad;
+            xdest++;
+        }
+    }
+
+    return 0;
+}
+
+static void calc_diffs(AVFilterContext *ctx, struct qitem *q,
                        const AVFrame *f1, const AVFrame *f2)
 {
+    const DecimateContext *dm = ctx->priv;
     int64_t maxdiff = -1;
     int64_t *bdiffs = dm->bdiffs;
     int plane, i, j;
@@ -90,42 +132,25 @@ static void calc_diffs(const DecimateContext *dm, struct qitem *q,
     memset(bdiffs, 0, dm->bdiffsize * sizeof(*bdiffs));
 
     for (plane = 0; plane < (dm->chroma && f1->data[2] ? 3 : 1); plane++) {
-        int x, y, xl;
-        const int linesize1 = f1->linesize[plane];
-        const int linesize2 = f2->linesize[plane];
-        const uint8_t *f1p = f1->data[plane];
-        const uint8_t *f2p = f2->data[plane];
-        int width    = plane ? AV_CEIL_RSHIFT(f1->width,  dm->hsub) : f1->width;
-        int height   = plane ? AV_CEIL_RSHIFT(f1->height, dm->vsub) : f1->height;
-        int hblockx  = dm->blockx / 2;
-        int hblocky  = dm->blocky / 2;
+        ThreadData td;
+
+        td.f1p       = f1->data[plane];
+        td.f2p       = f2->data[plane];
+        td.linesize1 = f1->linesize[plane];
+        td.linesize2 = f2->linesize[plane];
+        td.width     = plane ? AV_CEIL_RSHIFT(f1->width,  dm->hsub) : f1->width;
+        td.height    = plane ? AV_CEIL_RSHIFT(f1->height, dm->vsub) : f1->height;
+        td.hblockx   = dm->blockx / 2;
+        td.hblocky   = dm->blocky / 2;
 
         if (plane) {
-            hblockx >>= dm->hsub;
-            hblocky >>= dm->vsub;
+            td.hblockx >>= dm->hsub;
+            td.hblocky >>= dm->vsub;
         }
 
-        for (y = 0; y < height; y++) {
-            int ydest = y / hblocky;
-            int xdest = 0;
-
-#define CALC_DIFF(nbits) do {                               \
-    for (x = 0; x < width; x += hblockx) {                  \
-        int64_t acc = 0;                                    \
-        int m = FFMIN(width, x + hblockx);                  \
-        for (xl = x; xl < m; xl++)                          \
-            acc += abs(((const uint##nbits##_t *)f1p)[xl] - \
-                       ((const uint##nbits##_t *)f2p)[xl]); \
-        bdiffs[ydest * dm->nxblocks + xdest] += acc;        \
-        xdest++;                                            \
-    }                                                       \
-} while (0)
-            if (dm->depth == 8) CALC_DIFF(8);
-            else                CALC_DIFF(16);
-
-            f1p += linesize1;
-            f2p += linesize2;
-        }
+        /* every job owns whole rows of blocks, so no locking of bdiffs is needed */
+        ff_filter_execute(ctx, calc_diffs_slice, &td, NULL,
+                          FFMIN((td.height + td.hblocky - 1) / td.hblocky, dm->nb_threads));
     }
 
     for (i = 0; i < dm->nyblocks - 1; i++) {
@@ -176,7 +201,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
             dm->queue[dm->fid].maxbdiff = INT64_MAX;
             dm->queue[dm->fid].totdiff  = INT64_MAX;
         } else {
-            calc_diffs(dm, &dm->queue[dm->fid], prv, in);
+            calc_diffs(ctx, &dm->queue[dm->fid], prv, in);
         }
         if (++dm->fid != dm->cycle)
             return 0;
@@ -385,9 +410,11 @@ static int config_output(AVFilterLink *outlink)
     dm->nyblocks  = (h + dm->blocky/2 - 1) / (dm->blocky/2);
     dm->bdiffsize = dm->nxblocks * dm->nyblocks;
     dm->bdiffs    = av_malloc_array(dm->bdiffsize, sizeof(*dm->bdiffs));
+    dm->sad       = ff_scene_sad_get_fn(dm->depth > 8 ? 16 : 8);
+    dm->nb_threads = ff_filter_get_nb_threads(ctx);
     dm->queue     = av_calloc(dm->cycle, sizeof(*dm->queue));
 
-    if (!dm->bdiffs || !dm->queue)
+    if (!dm->bdiffs || !dm->queue || !dm->sad)
         return AVERROR(ENOMEM);
 
     if (dm->ppsrc) {
@@ -436,5 +463,5 @@ const AVFilter ff_vf_decimate = {
     FILTER_OUTPUTS(decimate_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .priv_class    = &decimate_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
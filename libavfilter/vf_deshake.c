@@ -225,6 +225,26 @@ static double block_angle(int x, int y, int cx, int cy, IntMotionVector *shift)
            diff;
 }
 
+/**
+ * Estimate the motion of one block, or mark it unusable if its contrast is low.
+ */
+static void search_block(AVMotionEstContext *me_ctx, void *arg, int mb_x, int mb_y)
+{
+    DeshakeContext *deshake = arg;
+    IntMotionVector *mv = &deshake->mvs[mb_x + mb_y * deshake->b_width];
+    int x = deshake->rx + mb_x * 16;
+    int y = deshake->ry + mb_y * deshake->blocksize * 2;
+
+    // If the contrast is too low, just skip this block as it probably
+    // won't be very useful to us.
+    if (block_contrast(me_ctx->data_ref, x, y, me_ctx->linesize, deshake->blocksize) > deshake->contrast) {
+        mv->x = mv->y = 0;
+        find_block_motion(deshake, me_ctx->data_cur, me_ctx->data_ref, x, y, me_ctx->linesize, mv);
+    } else {
+        mv->x = mv->y = -1;
+    }
+}
+
 /**
  * Find the estimated global motion for a scene given the most likely shift
  * for each block in the frame. The global motion is estimated to be the
@@ -232,13 +252,17 @@ static double block_angle(int x, int y, int cx, int cy, IntMotionVector *shift)
  * move one pixel to the right and two pixels down, this would yield a
  * motion vector (1, -2).
  */
-static void find_motion(DeshakeContext *deshake, uint8_t *src1, uint8_t *src2,
-                        int width, int height, int stride, Transform *t)
+static int find_motion(AVFilterContext *ctx, uint8_t *src1, uint8_t *src2,
+                       int width, int height, int stride, Transform *t)
 {
-    int x, y;
-    IntMotionVector mv = {0, 0};
+    DeshakeContext *deshake = ctx->priv;
+    AVMotionEstContext *me_ctx = &deshake->me_ctx;
+    int x, y, mb_x, mb_y;
     int count_max_value = 0;
-    int contrast;
+    // We use a width of 16 here to match the sad function
+    int lim_x = width  - deshake->rx * 2 - 16;
+    int lim_y = height - deshake->ry * 2 - deshake->blocksize * 2;
+    int ret;
 
     int pos;
     int center_x = 0, center_y = 0;
@@ -253,25 +277,40 @@ static void find_motion(DeshakeContext *deshake, uint8_t *src1, uint8_t *src2,
         }
     }
 
+    deshake->b_width  = lim_x > 0 ? (lim_x + 15) / 16 : 0;
+    deshake->b_height = lim_y > 0 ? (lim_y + deshake->blocksize * 2 - 1) / (deshake->blocksize * 2) : 0;
+
+    if (deshake->b_width && deshake->b_height) {
+        av_fast_malloc(&deshake->mvs, &deshake->mvs_size,
+                       deshake->b_width * deshake->b_height * sizeof(*deshake->mvs));
+        if (!deshake->mvs)
+            return AVERROR(ENOMEM);
+    }
+
+    // Find motion for every block, rows are searched in parallel
+    me_ctx->data_cur = src1;
+    me_ctx->data_ref = src2;
+    me_ctx->linesize = stride;
+    ret = ff_me_execute(ctx, me_ctx, deshake->b_width, deshake->b_height, 0,
+                        search_block, deshake);
+    if (ret < 0)
+        return ret;
+
     pos = 0;
-    // Find motion for every block and store the motion vector in the counts
-    for (y = deshake->ry; y < height - deshake->ry - (deshake->blocksize * 2); y += deshake->blocksize * 2) {
-        // We use a width of 16 here to match the sad function
-        for (x = deshake->rx; x < width - deshake->rx - 16; x += 16) {
-            // If the contrast is too low, just skip this block as it probably
-            // won't be very useful to us.
-            contrast = block_contrast(src2, x, y, stride, deshake->blocksize);
-            if (contrast > deshake->contrast) {
-                //av_log(NULL, AV_LOG_ERROR, "%d\n", contrast);
-                find_block_motion(deshake, src1, src2, x, y, stride, &mv);
-                if (mv.x != -1 && mv.y != -1) {
-                    deshake->counts[mv.x + deshake->rx][mv.y + deshake->ry] += 1;
-                    if (x > deshake->rx && y > deshake->ry)
-                        deshake->angles[pos++] = block_angle(x, y, 0, 0, &mv);
-
-                    center_x += mv.x;
-                    center_y += mv.y;
-                }
+    // Store the motion vector of every block in the counts
+    for (mb_y = 0; mb_y < deshake->b_height; mb_y++) {
+        for (mb_x = 0; mb_x < deshake->b_width; mb_x++) {
+            IntMotionVector mv = deshake->mvs[mb_x + mb_y * deshake->b_width];
+
+            x = deshake->rx + mb_x * 16;
+            y = deshake->ry + mb_y * deshake->blocksize * 2;
+            if (mv.x != -1 && mv.y != -1) {
+                deshake->counts[mv.x + deshake->rx][mv.y + deshake->ry] += 1;
+                if (x > deshake->rx && y > deshake->ry)
+                    deshake->angles[pos++] = block_angle(x, y, 0, 0, &mv);
+
+                center_x += mv.x;
+                center_y += mv.y;
             }
         }
     }
@@ -310,6 +349,7 @@ static void find_motion(DeshakeContext *deshake, uint8_t *src1, uint8_t *src2,
     t->angle = av_clipf(t->angle, -0.1, 0.1);
 
     //av_log(NULL, AV_LOG_ERROR, "%d x %d\n", avg->x, avg->y);
+    return 0;
 }
 
 static int deshake_transform_c(AVFilterContext *ctx,
@@ -397,6 +437,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_frame_free(&deshake->ref);
     av_freep(&deshake->angles);
     deshake->angles_size = 0;
+    av_freep(&deshake->mvs);
+    deshake->mvs_size = 0;
+    ff_me_uninit_context(&deshake->me_ctx);
     if (deshake->fp)
         fclose(deshake->fp);
 }
@@ -431,7 +474,7 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
 
     if (deshake->cx < 0 || deshake->cy < 0 || deshake->cw < 0 || deshake->ch < 0) {
         // Find the most likely global motion for the current frame
-        find_motion(deshake, (deshake->ref == NULL) ? in->data[0] : deshake->ref->data[0], in->data[0], link->w, link->h, in->linesize[0], &t);
+        ret = find_motion(link->dst, (deshake->ref == NULL) ? in->data[0] : deshake->ref->data[0], in->data[0], link->w, link->h, in->linesize[0], &t);
     } else {
         uint8_t *src1 = (deshake->ref == NULL) ? in->data[0] : deshake->ref->data[0];
         uint8_t *src2 = in->data[0];
@@ -448,7 +491,12 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
         src1 += deshake->cy * in->linesize[0] + deshake->cx;
         src2 += deshake->cy * in->linesize[0] + deshake->cx;
 
-        find_motion(deshake, src1, src2, deshake->cw, deshake->ch, in->linesize[0], &t);
+        ret = find_motion(link->dst, src1, src2, deshake->cw, deshake->ch, in->linesize[0], &t);
+    }
+    if (ret < 0) {
+        av_frame_free(&in);
+        av_frame_free(&out);
+        return ret;
     }
 
 
@@ -548,6 +596,7 @@ const AVFilter ff_vf_deshake = {
     .priv_size     = sizeof(DeshakeContext),
     .init          = init,
     .uninit        = uninit,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(deshake_inputs),
     FILTER_OUTPUTS(deshake_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
@@ -206,6 +206,18 @@ typedef struct DrawTextContext {
     int text_shaping;               ///< 1 to shape the text before drawing it
 #endif
     AVDictionary *metadata;
+
+    struct Glyph **layout_glyphs;   ///< glyph drawn for each element of positions, or NULL
+    int layout_nb;                  ///< number of used elements of positions
+    int layout_valid;               ///< the layout below matches layout_str and layout_fontsize
+    char *layout_str;               ///< expanded text the layout was computed for
+    unsigned int layout_str_size;   ///< allocated size of layout_str
+    unsigned int layout_fontsize;   ///< font size the layout was computed for
+    int layout_w, layout_h;         ///< text width and height
+    int layout_ascent;              ///< max glyph ascent
+    int layout_descent;             ///< min glyph descent
+    int layout_top, layout_bottom;  ///< vertical extent of the glyph bitmaps
+    int layout_border_top, layout_border_bottom; ///< vertical extent of the border bitmaps
 } DrawTextContext;
 
 #define OFFSET(x) offsetof(DrawTextContext, x)
@@ -846,7 +858,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     s->x_pexpr = s->y_pexpr = s->a_pexpr = s->fontsize_pexpr = NULL;
 
     av_freep(&s->positions);
+    av_freep(&s->layout_glyphs);
+    av_freep(&s->layout_str);
     s->nb_positions = 0;
+    s->layout_valid = 0;
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
@@ -1248,52 +1263,83 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+typedef struct ThreadData {
+    AVFrame *frame;
+    int width;
+    int top, bottom, nb_rows;
+    int box_w, box_h;
+    FFDrawColor *fontcolor;
+    FFDrawColor *shadowcolor;
+    FFDrawColor *bordercolor;
+    FFDrawColor *boxcolor;
+} ThreadData;
+
+static void draw_glyphs(DrawTextContext *s, uint8_t *data[], int linesize[],
+                        int width, int height,
+                        FFDrawColor *color,
+                        int x, int y, int borderw)
 {
-    char *text = s->expanded_text.str;
-    uint32_t code = 0;
     int i, x1, y1;
-    uint8_t *p;
-    Glyph *glyph = NULL;
 
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
-continue_on_invalid:
+    for (i = 0; i < s->layout_nb; i++) {
+        const Glyph *glyph = s->layout_glyphs[i];
+        const FT_Bitmap *bitmap;
 
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
+        if (!glyph)
             continue;
 
-        dummy.code = code;
-        dummy.fontsize = s->fontsize;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
-
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
+        bitmap = borderw ? &glyph->border_bitmap : &glyph->bitmap;
 
         x1 = s->positions[i].x+s->x+x - borderw;
         y1 = s->positions[i].y+s->y+y - borderw;
 
         ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
+                      data, linesize, width, height,
+                      bitmap->buffer, bitmap->pitch,
+                      bitmap->width, bitmap->rows,
+                      bitmap->pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
                       0, x1, y1);
     }
+}
+
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int step = 1 << s->dc.vsub_max;
+    const int start = td->top + (td->nb_rows *  jobnr     ) / nb_jobs * step;
+    const int end   = FFMIN(td->top + (td->nb_rows * (jobnr + 1)) / nb_jobs * step, td->bottom);
+    uint8_t *data[4];
+    int p;
+
+    if (start >= end)
+        return 0;
+
+    /* slices start on a chroma row boundary, so that blending each of them
+     * separately gives the same result as blending the whole frame */
+    for (p = 0; p < s->dc.nb_planes; p++)
+        data[p] = td->frame->data[p] + (start >> s->dc.vsub[p]) * td->frame->linesize[p];
+
+    if (s->draw_box)
+        ff_blend_rectangle(&s->dc, td->boxcolor,
+                           data, td->frame->linesize, td->width, end - start,
+                           s->x - s->boxborderw, s->y - s->boxborderw - start,
+                           td->box_w + s->boxborderw * 2, td->box_h + s->boxborderw * 2);
+
+    if (s->shadowx || s->shadowy)
+        draw_glyphs(s, data, td->frame->linesize, td->width, end - start,
+                    td->shadowcolor, s->shadowx, s->shadowy - start, 0);
+
+    if (s->borderw)
+        draw_glyphs(s, data, td->frame->linesize, td->width, end - start,
+                    td->bordercolor, 0, -start, s->borderw);
+
+    draw_glyphs(s, data, td->frame->linesize, td->width, end - start,
+                td->fontcolor, 0, -start, 0);
 
     return 0;
 }
 
-
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
     *color = incolor;
@@ -1316,89 +1362,37 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Load the glyphs of the expanded text and compute their positions.
+ * The result only depends on the text and on the font size, and is kept
+ * until one of them changes.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
+    const char *text = s->expanded_text.str;
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
-    int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
-    uint8_t *p;
+    int max_text_line_w = 0, len = s->expanded_text.len;
+    const uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
     FT_Vector delta;
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
+    s->layout_valid = 0;
 
-    FFDrawColor fontcolor;
-    FFDrawColor shadowcolor;
-    FFDrawColor bordercolor;
-    FFDrawColor boxcolor;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
-
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
-
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
-    if ((len = s->expanded_text.len) > s->nb_positions) {
+    if (len > s->nb_positions) {
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
             return AVERROR(ENOMEM);
-        s->nb_positions = len;
-    }
-
-    if (s->fontcolor_expr[0]) {
-        /* If expression is set, evaluate and replace the static value */
-        av_bprint_clear(&s->expanded_fontcolor);
-        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
-            return ret;
-        if (!av_bprint_is_complete(&s->expanded_fontcolor))
+        if (!(s->layout_glyphs =
+              av_realloc(s->layout_glyphs, len*sizeof(*s->layout_glyphs))))
             return AVERROR(ENOMEM);
-        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
-        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
-        if (ret)
-            return ret;
-        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
+        s->nb_positions = len;
     }
 
-    x = 0;
-    y = 0;
-
-    if ((ret = update_fontsize(ctx)) < 0)
-        return ret;
-
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid;);
@@ -1414,6 +1408,10 @@ continue_on_invalid:
                 return ret;
         }
 
+        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
+            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
+            return AVERROR(EINVAL);
+
         y_min = FFMIN(glyph->bbox.yMin, y_min);
         y_max = FFMAX(glyph->bbox.yMax, y_max);
         x_min = FFMIN(glyph->bbox.xMin, x_min);
@@ -1422,12 +1420,17 @@ continue_on_invalid:
     s->max_glyph_h = y_max - y_min;
     s->max_glyph_w = x_max - x_min;
 
+    s->layout_top     = s->layout_border_top    = INT_MAX;
+    s->layout_bottom  = s->layout_border_bottom = INT_MIN;
+
     /* compute and save position for each glyph */
     glyph = NULL;
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p ? *p++ : 0, code = 0xfffd; goto continue_on_invalid2;);
 continue_on_invalid2:
 
+        s->layout_glyphs[i] = NULL;
+
         /* skip the \n in the sequence \r\n */
         if (prev_code == '\r' && code == '\n')
             continue;
@@ -1459,17 +1462,119 @@ continue_on_invalid2:
         s->positions[i].y = y - glyph->bitmap_top + y_max;
         if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
         else              x += glyph->advance;
+
+        if (code == '\t')
+            continue;
+        s->layout_glyphs[i] = glyph;
+
+        /* vertical extent of the drawn bitmaps, relative to the text origin */
+        s->layout_top    = FFMIN(s->layout_top,    s->positions[i].y);
+        s->layout_bottom = FFMAX(s->layout_bottom, s->positions[i].y + (int)glyph->bitmap.rows);
+        if (s->borderw) {
+            s->layout_border_top    = FFMIN(s->layout_border_top,    s->positions[i].y - s->borderw);
+            s->layout_border_bottom = FFMAX(s->layout_border_bottom, s->positions[i].y - s->borderw +
+                                                                     (int)glyph->border_bitmap.rows);
+        }
     }
 
     max_text_line_w = FFMAX(x, max_text_line_w);
 
-    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
-    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
+    s->layout_nb      = i;
+    s->layout_w       = max_text_line_w;
+    s->layout_h       = y + s->max_glyph_h;
+    s->layout_ascent  = y_max;
+    s->layout_descent = y_min;
+
+    av_fast_malloc(&s->layout_str, &s->layout_str_size, len + 1);
+    if (!s->layout_str)
+        return AVERROR(ENOMEM);
+    memcpy(s->layout_str, text, len + 1);
+    s->layout_fontsize = s->fontsize;
+    s->layout_valid    = 1;
+
+    return 0;
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    int ret;
+    int box_w, box_h;
+    int top, bottom;
+    const int step = 1 << s->dc.vsub_max;
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    FFDrawColor fontcolor;
+    FFDrawColor shadowcolor;
+    FFDrawColor bordercolor;
+    FFDrawColor boxcolor;
+    ThreadData td;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+
+    if (s->fontcolor_expr[0]) {
+        /* If expression is set, evaluate and replace the static value */
+        av_bprint_clear(&s->expanded_fontcolor);
+        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
+            return ret;
+        if (!av_bprint_is_complete(&s->expanded_fontcolor))
+            return AVERROR(ENOMEM);
+        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
+        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
+        if (ret)
+            return ret;
+        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
+    }
+
+    if ((ret = update_fontsize(ctx)) < 0)
+        return ret;
+
+    if (!s->layout_valid || s->layout_fontsize != s->fontsize ||
+        strcmp(s->layout_str, s->expanded_text.str)) {
+        if ((ret = layout_text(ctx)) < 0)
+            return ret;
+    }
+
+    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = s->layout_w;
+    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = s->layout_h;
 
     s->var_values[VAR_MAX_GLYPH_W] = s->max_glyph_w;
     s->var_values[VAR_MAX_GLYPH_H] = s->max_glyph_h;
-    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = y_max;
-    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = y_min;
+    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = s->layout_ascent;
+    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = s->layout_descent;
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
@@ -1489,8 +1594,8 @@ continue_on_invalid2:
     update_color_with_alpha(s, &bordercolor, s->bordercolor);
     update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
 
-    box_w = max_text_line_w;
-    box_h = y + s->max_glyph_h;
+    box_w = s->layout_w;
+    box_h = s->layout_h;
 
     if (s->fix_bounds) {
 
@@ -1518,27 +1623,48 @@ continue_on_invalid2:
             s->y = FFMAX(height - box_h - offsetbottom, 0);
     }
 
-    /* draw box */
-    if (s->draw_box)
-        ff_blend_rectangle(&s->dc, &boxcolor,
-                           frame->data, frame->linesize, width, height,
-                           s->x - s->boxborderw, s->y - s->boxborderw,
-                           box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
-
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
+    /* rows touched by the box, the shadow, the border and the text */
+    top    = INT_MAX;
+    bottom = INT_MIN;
+    if (s->layout_top < s->layout_bottom) {
+        top    = s->layout_top;
+        bottom = s->layout_bottom;
+        if (s->shadowx || s->shadowy) {
+            top    = FFMIN(top,    s->layout_top    + s->shadowy);
+            bottom = FFMAX(bottom, s->layout_bottom + s->shadowy);
+        }
     }
-
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
+    if (s->borderw && s->layout_border_top < s->layout_border_bottom) {
+        top    = FFMIN(top,    s->layout_border_top);
+        bottom = FFMAX(bottom, s->layout_border_bottom);
     }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    if (s->draw_box && box_w + s->boxborderw * 2 > 0) {
+        top    = FFMIN(top,    -s->boxborderw);
+        bottom = FFMAX(bottom, box_h + s->boxborderw);
+    }
+    if (top >= bottom)
+        return 0;
+
+    top    = av_clip64(s->y + (int64_t)top,    0, height);
+    bottom = av_clip64(s->y + (int64_t)bottom, 0, height);
+    top   &= ~(step - 1);
+    if (top >= bottom)
+        return 0;
+
+    td.frame       = frame;
+    td.width       = width;
+    td.top         = top;
+    td.bottom      = bottom;
+    td.nb_rows     = (bottom - top + step - 1) / step;
+    td.box_w       = box_w;
+    td.box_h       = box_h;
+    td.fontcolor   = &fontcolor;
+    td.shadowcolor = &shadowcolor;
+    td.bordercolor = &bordercolor;
+    td.boxcolor    = &boxcolor;
+
+    ff_filter_execute(ctx, draw_text_slice, &td, NULL,
+                      FFMIN(td.nb_rows, ff_filter_get_nb_threads(ctx)));
 
     return 0;
 }
@@ -1639,5 +1765,5 @@ const AVFilter ff_vf_drawtext = {
     FILTER_OUTPUTS(avfilter_vf_drawtext_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -39,6 +39,7 @@
 #include "avfilter.h"
 #include "filters.h"
 #include "internal.h"
+#include "scene_sad.h"
 
 #define INPUT_MAIN     0
 #define INPUT_CLEANSRC 1
@@ -73,6 +74,11 @@ enum comb_dbg {
     NB_COMBDBG
 };
 
+typedef struct FieldAccum {
+    uint64_t pc, pm, pml;
+    uint64_t nc, nm, nml;
+} FieldAccum;
+
 typedef struct FieldMatchContext {
     const AVClass *class;
 
@@ -104,11 +110,20 @@ typedef struct FieldMatchContext {
     /* misc buffers */
     uint8_t *map_data[4];
     int map_linesize[4];
+    /* diff maps between the fields of src and nxt, reused as the diff maps
+     * between the fields of src and prv for the next frame; indexed by the
+     * parity of the frame they were built for */
+    uint8_t *cn_map_data[2][4];
+    int64_t cn_map_n[2];
+    int cn_map_field[2];
     uint8_t *cmask_data[4];
     int cmask_linesize[4];
     int *c_array;
     int tpitchy, tpitchuv;
     uint8_t *tbuffer;
+    FieldAccum *accum;              ///< per job sums of compare_fields()
+    int nb_threads;
+    ff_scene_sad_fn sad;
 } FieldMatchContext;
 
 #define OFFSET(x) offsetof(FieldMatchContext, x)
@@ -163,24 +178,13 @@ static int get_height(const FieldMatchContext *fm, const AVFrame *f, int plane)
     return plane ? AV_CEIL_RSHIFT(f->height, fm->vsub) : f->height;
 }
 
-static int64_t luma_abs_diff(const AVFrame *f1, const AVFrame *f2)
+static int64_t luma_abs_diff(AVFilterContext *ctx, const AVFrame *f1, const AVFrame *f2)
 {
-    int x, y;
-    const uint8_t *srcp1 = f1->data[0];
-    const uint8_t *srcp2 = f2->data[0];
-    const int src1_linesize = f1->linesize[0];
-    const int src2_linesize = f2->linesize[0];
-    const int width  = f1->width;
-    const int height = f1->height;
-    int64_t acc = 0;
-
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++)
-            acc += abs(srcp1[x] - srcp2[x]);
-        srcp1 += src1_linesize;
-        srcp2 += src2_linesize;
-    }
-    return acc;
+    const FieldMatchContext *fm = ctx->priv;
+    const ptrdiff_t width  = f1->width;
+    const ptrdiff_t height = f1->height;
+
+    return ff_scene_sad_frame(ctx, fm->sad, f1, f2, &width, &height, 1);
 }
 
 static void fill_buf(uint8_t *data, int w, int h, int linesize, uint8_t v)
@@ -193,79 +197,66 @@ static void fill_buf(uint8_t *data, int w, int h, int linesize, uint8_t v)
     }
 }
 
-static int calc_combed_score(const FieldMatchContext *fm, const AVFrame *src)
+typedef struct CombThreadData {
+    const AVFrame *src;
+    int plane;
+} CombThreadData;
+
+static int comb_mask_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x, y, plane, max_v = 0;
-    const int cthresh = fm->cthresh;
+    const FieldMatchContext *fm = ctx->priv;
+    const CombThreadData *td = arg;
+    const int plane  = td->plane;
+    const int cthresh  = fm->cthresh;
     const int cthresh6 = cthresh * 6;
+    const int src_linesize = td->src->linesize[plane];
+    const int cmk_linesize = fm->cmask_linesize[plane];
+    const int width  = get_width (fm, td->src, plane);
+    const int height = get_height(fm, td->src, plane);
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    int x, y;
 
-    for (plane = 0; plane < (fm->chroma ? 3 : 1); plane++) {
-        const uint8_t *srcp = src->data[plane];
-        const int src_linesize = src->linesize[plane];
-        const int width  = get_width (fm, src, plane);
-        const int height = get_height(fm, src, plane);
-        uint8_t *cmkp = fm->cmask_data[plane];
-        const int cmk_linesize = fm->cmask_linesize[plane];
-
-        if (cthresh < 0) {
-            fill_buf(cmkp, width, height, cmk_linesize, 0xff);
-            continue;
-        }
-        fill_buf(cmkp, width, height, cmk_linesize, 0);
+    for (y = slice_start; y < slice_end; y++) {
+        const uint8_t *srcp = td->src->data[plane] + y * src_linesize;
+        uint8_t *cmkp = fm->cmask_data[plane] + y * cmk_linesize;
+        /* the lines above the first and below the last ones are mirrored */
+        const int xm2 = y > 1          ? -2 :  2;
+        const int xm1 = y > 0          ? -1 :  1;
+        const int xp1 = y < height - 1 ?  1 : -1;
+        const int xp2 = y < height - 2 ?  2 : -2;
 
         /* [1 -3 4 -3 1] vertical filter */
-#define FILTER(xm2, xm1, xp1, xp2) \
-        abs(  4 * srcp[x] \
-             -3 * (srcp[x + (xm1)*src_linesize] + srcp[x + (xp1)*src_linesize]) \
-             +    (srcp[x + (xm2)*src_linesize] + srcp[x + (xp2)*src_linesize])) > cthresh6
-
-        /* first line */
         for (x = 0; x < width; x++) {
-            const int s1 = abs(srcp[x] - srcp[x + src_linesize]);
-            if (s1 > cthresh && FILTER(2, 1, 1, 2))
-                cmkp[x] = 0xff;
+            const int s1 = abs(srcp[x] - srcp[x + xm1 * src_linesize]);
+            const int s2 = abs(srcp[x] - srcp[x + xp1 * src_linesize]);
+            cmkp[x] = s1 > cthresh && s2 > cthresh &&
+                      abs(  4 * srcp[x]
+                           -3 * (srcp[x + xm1 * src_linesize] + srcp[x + xp1 * src_linesize])
+                           +    (srcp[x + xm2 * src_linesize] + srcp[x + xp2 * src_linesize])) > cthresh6
+                      ? 0xff : 0;
         }
-        srcp += src_linesize;
-        cmkp += cmk_linesize;
+    }
 
-        /* second line */
-        for (x = 0; x < width; x++) {
-            const int s1 = abs(srcp[x] - srcp[x - src_linesize]);
-            const int s2 = abs(srcp[x] - srcp[x + src_linesize]);
-            if (s1 > cthresh && s2 > cthresh && FILTER(2, -1, 1, 2))
-                cmkp[x] = 0xff;
-        }
-        srcp += src_linesize;
-        cmkp += cmk_linesize;
-
-        /* all lines minus first two and last two */
-        for (y = 2; y < height-2; y++) {
-            for (x = 0; x < width; x++) {
-                const int s1 = abs(srcp[x] - srcp[x - src_linesize]);
-                const int s2 = abs(srcp[x] - srcp[x + src_linesize]);
-                if (s1 > cthresh && s2 > cthresh && FILTER(-2, -1, 1, 2))
-                    cmkp[x] = 0xff;
-            }
-            srcp += src_linesize;
-            cmkp += cmk_linesize;
-        }
+    return 0;
+}
 
-        /* before-last line */
-        for (x = 0; x < width; x++) {
-            const int s1 = abs(srcp[x] - srcp[x - src_linesize]);
-            const int s2 = abs(srcp[x] - srcp[x + src_linesize]);
-            if (s1 > cthresh && s2 > cthresh && FILTER(-2, -1, 1, -2))
-                cmkp[x] = 0xff;
-        }
-        srcp += src_linesize;
-        cmkp += cmk_linesize;
+static int calc_combed_score(AVFilterContext *ctx, const AVFrame *src)
+{
+    const FieldMatchContext *fm = ctx->priv;
+    int x, y, plane, max_v = 0;
 
-        /* last line */
-        for (x = 0; x < width; x++) {
-            const int s1 = abs(srcp[x] - srcp[x - src_linesize]);
-            if (s1 > cthresh && FILTER(-2, -1, -1, -2))
-                cmkp[x] = 0xff;
+    for (plane = 0; plane < (fm->chroma ? 3 : 1); plane++) {
+        const int height = get_height(fm, src, plane);
+        CombThreadData td = { .src = src, .plane = plane };
+
+        if (fm->cthresh < 0) {
+            fill_buf(fm->cmask_data[plane], get_width(fm, src, plane), height,
+                     fm->cmask_linesize[plane], 0xff);
+            continue;
         }
+        ff_filter_execute(ctx, comb_mask_slice, &td, NULL,
+                          FFMIN(height, fm->nb_threads));
     }
 
     if (fm->chroma) {
@@ -390,86 +381,152 @@ static int calc_combed_score(const FieldMatchContext *fm, const AVFrame *src)
     return max_v;
 }
 
+typedef struct DiffThreadData {
+    const uint8_t *prvp, *nxtp;     ///< fields the diff map is built from
+    int prv_linesize, nxt_linesize;
+    uint8_t *dstp;                  ///< diff map, NULL if it is already built
+    const uint8_t *mapp;
+    int map_linesize;
+    const uint8_t *srcpf, *srcf, *srcnf;
+    const uint8_t *prvpf, *prvnf, *nxtpf, *nxtnf;
+    int srcf_linesize, prvf_linesize, nxtf_linesize;
+    int width, height, plane;
+    int startx, stopx, y0a, y1a;
+} DiffThreadData;
+
 // the secret is that tbuffer is an interlaced, offset subset of all the lines
-static void build_abs_diff_mask(const uint8_t *prvp, int prv_linesize,
-                                const uint8_t *nxtp, int nxt_linesize,
-                                uint8_t *tbuffer,    int tbuf_linesize,
-                                int width, int height)
+static int build_abs_diff_mask(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    const FieldMatchContext *fm = ctx->priv;
+    const DiffThreadData *td = arg;
+    const int tpitch = td->plane ? fm->tpitchuv : fm->tpitchy;
+    const int height = td->height >> 1;
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    const uint8_t *prvp = td->prvp + (slice_start - 1) * td->prv_linesize;
+    const uint8_t *nxtp = td->nxtp + (slice_start - 1) * td->nxt_linesize;
+    uint8_t *tbuffer = fm->tbuffer + slice_start * tpitch;
     int y, x;
 
-    prvp -= prv_linesize;
-    nxtp -= nxt_linesize;
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++)
+    for (y = slice_start; y < slice_end; y++) {
+        for (x = 0; x < td->width; x++)
             tbuffer[x] = FFABS(prvp[x] - nxtp[x]);
-        prvp += prv_linesize;
-        nxtp += nxt_linesize;
-        tbuffer += tbuf_linesize;
+        prvp += td->prv_linesize;
+        nxtp += td->nxt_linesize;
+        tbuffer += tpitch;
     }
+
+    return 0;
 }
 
 /**
- * Build a map over which pixels differ a lot/a little
+ * Build a line of the map over which pixels differ a lot/a little
  */
-static void build_diff_map(FieldMatchContext *fm,
-                           const uint8_t *prvp, int prv_linesize,
-                           const uint8_t *nxtp, int nxt_linesize,
-                           uint8_t *dstp, int dst_linesize, int height,
-                           int width, int plane)
+static void build_diff_map(const uint8_t *dp, int tpitch, uint8_t *dstp,
+                           int y, int height, int width)
 {
-    int x, y, u, diff, count;
-    int tpitch = plane ? fm->tpitchuv : fm->tpitchy;
-    const uint8_t *dp = fm->tbuffer + tpitch;
-
-    build_abs_diff_mask(prvp, prv_linesize, nxtp, nxt_linesize,
-                        fm->tbuffer, tpitch, width, height>>1);
-
-    for (y = 2; y < height - 2; y += 2) {
-        for (x = 1; x < width - 1; x++) {
-            diff = dp[x];
-            if (diff > 3) {
-                for (count = 0, u = x-1; u < x+2 && count < 2; u++) {
-                    count += dp[u-tpitch] > 3;
-                    count += dp[u       ] > 3;
-                    count += dp[u+tpitch] > 3;
-                }
-                if (count > 1) {
-                    dstp[x] = 1;
-                    if (diff > 19) {
-                        int upper = 0, lower = 0;
-                        for (count = 0, u = x-1; u < x+2 && count < 6; u++) {
-                            if (dp[u-tpitch] > 19) { count++; upper = 1; }
-                            if (dp[u       ] > 19)   count++;
-                            if (dp[u+tpitch] > 19) { count++; lower = 1; }
-                        }
-                        if (count > 3) {
-                            if (upper && lower) {
-                                dstp[x] |= 1<<1;
-                            } else {
-                                int upper2 = 0, lower2 = 0;
-                                for (u = FFMAX(x-4,0); u < FFMIN(x+5,width); u++) {
-                                    if (y != 2 &&        dp[u-2*tpitch] > 19) upper2 = 1;
-                                    if (                 dp[u-  tpitch] > 19) upper  = 1;
-                                    if (                 dp[u+  tpitch] > 19) lower  = 1;
-                                    if (y != height-4 && dp[u+2*tpitch] > 19) lower2 = 1;
-                                }
-                                if ((upper && (lower || upper2)) ||
-                                    (lower && (upper || lower2)))
-                                    dstp[x] |= 1<<1;
-                                else if (count > 5)
-                                    dstp[x] |= 1<<2;
+    int x, u, diff, count;
+
+    for (x = 1; x < width - 1; x++) {
+        diff = dp[x];
+        if (diff > 3) {
+            for (count = 0, u = x-1; u < x+2 && count < 2; u++) {
+                count += dp[u-tpitch] > 3;
+                count += dp[u       ] > 3;
+                count += dp[u+tpitch] > 3;
+            }
+            if (count > 1) {
+                dstp[x] = 1;
+                if (diff > 19) {
+                    int upper = 0, lower = 0;
+                    for (count = 0, u = x-1; u < x+2 && count < 6; u++) {
+                        if (dp[u-tpitch] > 19) { count++; upper = 1; }
+                        if (dp[u       ] > 19)   count++;
+                        if (dp[u+tpitch] > 19) { count++; lower = 1; }
+                    }
+                    if (count > 3) {
+                        if (upper && lower) {
+                            dstp[x] |= 1<<1;
+                        } else {
+                            int upper2 = 0, lower2 = 0;
+                            for (u = FFMAX(x-4,0); u < FFMIN(x+5,width); u++) {
+                                if (y != 2 &&        dp[u-2*tpitch] > 19) upper2 = 1;
+                                if (                 dp[u-  tpitch] > 19) upper  = 1;
+                                if (                 dp[u+  tpitch] > 19) lower  = 1;
+                                if (y != height-4 && dp[u+2*tpitch] > 19) lower2 = 1;
                             }
+                            if ((upper && (lower || upper2)) ||
+                                (lower && (upper || lower2)))
+                                dstp[x] |= 1<<1;
+                            else if (count > 5)
+                                dstp[x] |= 1<<2;
                         }
                     }
                 }
             }
         }
-        dp += tpitch;
-        dstp += dst_linesize;
     }
 }
 
+static int compare_fields_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FieldMatchContext *fm = ctx->priv;
+    const DiffThreadData *td = arg;
+    FieldAccum *acc = &fm->accum[jobnr];
+    const int tpitch = td->plane ? fm->tpitchuv : fm->tpitchy;
+    const int nb_lines = FFMAX(td->height - 3, 0) >> 1;
+    const int slice_start = (nb_lines *  jobnr     ) / nb_jobs;
+    const int slice_end   = (nb_lines * (jobnr + 1)) / nb_jobs;
+    const int map_linesize = td->map_linesize;
+    int i, x, temp1, temp2;
+
+    for (i = slice_start; i < slice_end; i++) {
+        const int y = 2 + 2 * i;
+        const uint8_t *mapp  = td->mapp  + i * map_linesize;
+        const uint8_t *srcpf = td->srcpf + i * td->srcf_linesize;
+        const uint8_t *srcf  = td->srcf  + i * td->srcf_linesize;
+        const uint8_t *srcnf = td->srcnf + i * td->srcf_linesize;
+        const uint8_t *prvpf = td->prvpf + i * td->prvf_linesize;
+        const uint8_t *prvnf = td->prvnf + i * td->prvf_linesize;
+        const uint8_t *nxtpf = td->nxtpf + i * td->nxtf_linesize;
+        const uint8_t *nxtnf = td->nxtnf + i * td->nxtf_linesize;
+
+        if (td->dstp)
+            build_diff_map(fm->tbuffer + (i + 1) * tpitch, tpitch,
+                           td->dstp + i * map_linesize, y, td->height, td->width);
+
+        if (td->y0a == td->y1a || y < td->y0a || y > td->y1a) {
+            for (x = td->startx; x < td->stopx; x++) {
+                if (mapp[x] > 0 || mapp[x + map_linesize] > 0) {
+                    temp1 = srcpf[x] + (srcf[x] << 2) + srcnf[x]; // [1 4 1]
+
+                    temp2 = abs(3 * (prvpf[x] + prvnf[x]) - temp1);
+                    if (temp2 > 23 && ((mapp[x]&1) || (mapp[x + map_linesize]&1)))
+                        acc->pc += temp2;
+                    if (temp2 > 42) {
+                        if ((mapp[x]&2) || (mapp[x + map_linesize]&2))
+                            acc->pm += temp2;
+                        if ((mapp[x]&4) || (mapp[x + map_linesize]&4))
+                            acc->pml += temp2;
+                    }
+
+                    temp2 = abs(3 * (nxtpf[x] + nxtnf[x]) - temp1);
+                    if (temp2 > 23 && ((mapp[x]&1) || (mapp[x + map_linesize]&1)))
+                        acc->nc += temp2;
+                    if (temp2 > 42) {
+                        if ((mapp[x]&2) || (mapp[x + map_linesize]&2))
+                            acc->nm += temp2;
+                        if ((mapp[x]&4) || (mapp[x + map_linesize]&4))
+                            acc->nml += temp2;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
 enum { mP, mC, mN, mB, mU };
 
 static int get_field_base(int match, int field)
@@ -484,19 +541,39 @@ static AVFrame *select_frame(FieldMatchContext *fm, int match)
     else  /* match == mC */              return fm->src;
 }
 
-static int compare_fields(FieldMatchContext *fm, int match1, int match2, int field)
+static int compare_fields(AVFilterContext *ctx, int match1, int match2,
+                          int field, int64_t n)
 {
-    int plane, ret;
+    FieldMatchContext *fm = ctx->priv;
+    int plane, ret, i, nb_jobs = 1;
     uint64_t accumPc = 0, accumPm = 0, accumPml = 0;
     uint64_t accumNc = 0, accumNm = 0, accumNml = 0;
     int norm1, norm2, mtn1, mtn2;
     float c1, c2, mr;
     const AVFrame *src = fm->src;
+    uint8_t **map_data = fm->map_data;
+    int build_map = 1;
+
+    /* The c/n diff map only depends on the absolute difference between a
+     * field of src and the same field of nxt, so it is also the c/p diff map
+     * of the next frame, once the window has slid. */
+    if (match1 == mC && match2 == mN) {
+        const int slot = n & 1;
+        map_data = fm->cn_map_data[slot];
+        fm->cn_map_n[slot]     = n;
+        fm->cn_map_field[slot] = field;
+    } else if (match1 == mC && match2 == mP) {
+        const int slot = (n - 1) & 1;
+        if (fm->cn_map_n[slot] == n - 1 && fm->cn_map_field[slot] == field) {
+            map_data  = fm->cn_map_data[slot];
+            build_map = 0;
+        }
+    }
 
     for (plane = 0; plane < (fm->mchroma ? 3 : 1); plane++) {
-        int x, y, temp1, temp2, fbase;
+        int fbase;
         const AVFrame *prev, *next;
-        uint8_t *mapp    = fm->map_data[plane];
+        uint8_t *mapp    = map_data[plane];
         int map_linesize = fm->map_linesize[plane];
         const uint8_t *srcp = src->data[plane];
         const int src_linesize  = src->linesize[plane];
@@ -505,14 +582,12 @@ static int compare_fields(FieldMatchContext *fm, int match1, int match2, int fie
         int prvf_linesize, nxtf_linesize;
         const int width  = get_width (fm, src, plane);
         const int height = get_height(fm, src, plane);
-        const int y0a = fm->y0 >> (plane ? fm->vsub : 0);
-        const int y1a = fm->y1 >> (plane ? fm->vsub : 0);
-        const int startx = (plane == 0 ? 8 : 8 >> fm->hsub);
-        const int stopx  = width - startx;
         const uint8_t *srcpf, *srcf, *srcnf;
         const uint8_t *prvpf, *prvnf, *nxtpf, *nxtnf;
+        DiffThreadData td;
 
-        fill_buf(mapp, width, height, map_linesize, 0);
+        if (build_map)
+            fill_buf(mapp, width, height, map_linesize, 0);
 
         /* match1 */
         fbase = get_field_base(match1, field);
@@ -535,50 +610,58 @@ static int compare_fields(FieldMatchContext *fm, int match1, int match2, int fie
         nxtnf = nxtpf + nxtf_linesize;                      // next frame, next     field
 
         map_linesize <<= 1;
-        if ((match1 >= 3 && field == 1) || (match1 < 3 && field != 1))
-            build_diff_map(fm, prvpf, prvf_linesize, nxtpf, nxtf_linesize,
-                           mapp, map_linesize, height, width, plane);
+        td.prv_linesize = prvf_linesize;
+        td.nxt_linesize = nxtf_linesize;
+        if ((match1 >= 3 && field == 1) || (match1 < 3 && field != 1)) {
+            td.prvp = prvpf;
+            td.nxtp = nxtpf;
+            td.dstp = mapp;
+        } else {
+            td.prvp = prvnf;
+            td.nxtp = nxtnf;
+            td.dstp = mapp + map_linesize;
+        }
+        td.mapp          = mapp;
+        td.map_linesize  = map_linesize;
+        td.srcpf         = srcpf;
+        td.srcf          = srcf;
+        td.srcnf         = srcnf;
+        td.prvpf         = prvpf;
+        td.prvnf         = prvnf;
+        td.nxtpf         = nxtpf;
+        td.nxtnf         = nxtnf;
+        td.srcf_linesize = srcf_linesize;
+        td.prvf_linesize = prvf_linesize;
+        td.nxtf_linesize = nxtf_linesize;
+        td.width         = width;
+        td.height        = height;
+        td.plane         = plane;
+        td.startx        = plane == 0 ? 8 : 8 >> fm->hsub;
+        td.stopx         = width - td.startx;
+        td.y0a           = fm->y0 >> (plane ? fm->vsub : 0);
+        td.y1a           = fm->y1 >> (plane ? fm->vsub : 0);
+
+        if (build_map)
+            ff_filter_execute(ctx, build_abs_diff_mask, &td, NULL,
+                              av_clip(height >> 1, 1, fm->nb_threads));
         else
-            build_diff_map(fm, prvnf, prvf_linesize, nxtnf, nxtf_linesize,
-                           mapp + map_linesize, map_linesize, height, width, plane);
-
-        for (y = 2; y < height - 2; y += 2) {
-            if (y0a == y1a || y < y0a || y > y1a) {
-                for (x = startx; x < stopx; x++) {
-                    if (mapp[x] > 0 || mapp[x + map_linesize] > 0) {
-                        temp1 = srcpf[x] + (srcf[x] << 2) + srcnf[x]; // [1 4 1]
-
-                        temp2 = abs(3 * (prvpf[x] + prvnf[x]) - temp1);
-                        if (temp2 > 23 && ((mapp[x]&1) || (mapp[x + map_linesize]&1)))
-                            accumPc += temp2;
-                        if (temp2 > 42) {
-                            if ((mapp[x]&2) || (mapp[x + map_linesize]&2))
-                                accumPm += temp2;
-                            if ((mapp[x]&4) || (mapp[x + map_linesize]&4))
-                                accumPml += temp2;
-                        }
+            td.dstp = NULL;
 
-                        temp2 = abs(3 * (nxtpf[x] + nxtnf[x]) - temp1);
-                        if (temp2 > 23 && ((mapp[x]&1) || (mapp[x + map_linesize]&1)))
-                            accumNc += temp2;
-                        if (temp2 > 42) {
-                            if ((mapp[x]&2) || (mapp[x + map_linesize]&2))
-                                accumNm += temp2;
-                            if ((mapp[x]&4) || (mapp[x + map_linesize]&4))
-                                accumNml += temp2;
-                        }
-                    }
-                }
-            }
-            prvpf += prvf_linesize;
-            prvnf += prvf_linesize;
-            srcpf += srcf_linesize;
-            srcf  += srcf_linesize;
-            srcnf += srcf_linesize;
-            nxtpf += nxtf_linesize;
-            nxtnf += nxtf_linesize;
-            mapp  += map_linesize;
+        /* the jobs keep their own sums, the planes are accumulated in them */
+        if (!plane) {
+            nb_jobs = av_clip((height - 3) >> 1, 1, fm->nb_threads);
+            memset(fm->accum, 0, nb_jobs * sizeof(*fm->accum));
         }
+        ff_filter_execute(ctx, compare_fields_slice, &td, NULL, nb_jobs);
+    }
+
+    for (i = 0; i < nb_jobs; i++) {
+        accumPc  += fm->accum[i].pc;
+        accumPm  += fm->accum[i].pm;
+        accumPml += fm->accum[i].pml;
+        accumNc  += fm->accum[i].nc;
+        accumNm  += fm->accum[i].nm;
+        accumNml += fm->accum[i].nml;
     }
 
     if (accumPm < 500 && accumNm < 500 && (accumPml >= 500 || accumNml >= 500) &&
@@ -656,7 +739,7 @@ static int checkmm(AVFilterContext *ctx, int *combs, int m1, int m2,
         if (!gen_frames[mid])                                                   \
             gen_frames[mid] = create_weave_frame(ctx, mid, field,               \
                                                  fm->prv, fm->src, fm->nxt);    \
-        combs[mid] = calc_combed_score(fm, gen_frames[mid]);                    \
+        combs[mid] = calc_combed_score(ctx, gen_frames[mid]);                    \
     }                                                                           \
 } while (0)
 
@@ -729,7 +812,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
                 ret = AVERROR(ENOMEM);
                 goto fail;
             }
-            combs[i] = calc_combed_score(fm, gen_frames[i]);
+            combs[i] = calc_combed_score(ctx, gen_frames[i]);
         }
         av_log(ctx, AV_LOG_INFO, "COMBS: %3d %3d %3d %3d %3d\n",
                combs[0], combs[1], combs[2], combs[3], combs[4]);
@@ -742,22 +825,22 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
 
     /* p/c selection and optional 3-way p/c/n matches */
-    match = compare_fields(fm, fxo[mC], fxo[mP], field);
+    match = compare_fields(ctx, fxo[mC], fxo[mP], field, outlink->frame_count_in);
     if (fm->mode == MODE_PCN || fm->mode == MODE_PCN_UB)
-        match = compare_fields(fm, match, fxo[mN], field);
+        match = compare_fields(ctx, match, fxo[mN], field, outlink->frame_count_in);
 
     /* scene change check */
     if (fm->combmatch == COMBMATCH_SC) {
         if (fm->lastn == outlink->frame_count_in - 1) {
             if (fm->lastscdiff > fm->scthresh)
                 sc = 1;
-        } else if (luma_abs_diff(fm->prv, fm->src) > fm->scthresh) {
+        } else if (luma_abs_diff(ctx, fm->prv, fm->src) > fm->scthresh) {
             sc = 1;
         }
 
         if (!sc) {
             fm->lastn = outlink->frame_count_in;
-            fm->lastscdiff = luma_abs_diff(fm->src, fm->nxt);
+            fm->lastscdiff = luma_abs_diff(ctx, fm->src, fm->nxt);
             sc = fm->lastscdiff > fm->scthresh;
         }
     }
@@ -943,6 +1026,11 @@ static int config_input(AVFilterLink *inlink)
     if ((ret = av_image_alloc(fm->map_data,   fm->map_linesize,   w, h, inlink->format, 32)) < 0 ||
         (ret = av_image_alloc(fm->cmask_data, fm->cmask_linesize, w, h, inlink->format, 32)) < 0)
         return ret;
+    for (int i = 0; i < 2; i++) {
+        if ((ret = av_image_alloc(fm->cn_map_data[i], fm->map_linesize, w, h, inlink->format, 32)) < 0)
+            return ret;
+        fm->cn_map_n[i] = INT64_MIN;
+    }
 
     fm->hsub = pix_desc->log2_chroma_w;
     fm->vsub = pix_desc->log2_chroma_h;
@@ -954,7 +1042,10 @@ static int config_input(AVFilterLink *inlink)
     fm->c_array = av_malloc_array((((w + fm->blockx/2)/fm->blockx)+1) *
                             (((h + fm->blocky/2)/fm->blocky)+1),
                             4 * sizeof(*fm->c_array));
-    if (!fm->tbuffer || !fm->c_array)
+    fm->nb_threads = ff_filter_get_nb_threads(ctx);
+    fm->accum = av_calloc(fm->nb_threads, sizeof(*fm->accum));
+    fm->sad = ff_scene_sad_get_fn(8);
+    if (!fm->tbuffer || !fm->c_array || !fm->accum || !fm->sad)
         return AVERROR(ENOMEM);
 
     return 0;
@@ -1009,9 +1100,12 @@ static av_cold void fieldmatch_uninit(AVFilterContext *ctx)
     av_frame_free(&fm->src);
     av_frame_free(&fm->src2);
     av_freep(&fm->map_data[0]);
+    av_freep(&fm->cn_map_data[0][0]);
+    av_freep(&fm->cn_map_data[1][0]);
     av_freep(&fm->cmask_data[0]);
     av_freep(&fm->tbuffer);
     av_freep(&fm->c_array);
+    av_freep(&fm->accum);
 }
 
 static int config_output(AVFilterLink *outlink)
@@ -1050,5 +1144,5 @@ const AVFilter ff_vf_fieldmatch = {
     FILTER_OUTPUTS(fieldmatch_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class     = &fieldmatch_class,
-    .flags          = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags          = AVFILTER_FLAG_DYNAMIC_INPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -118,18 +118,6 @@ static void add_mv_data(AVMotionVector *mv, int mb_size,
     mv->flags = 0;
 }
 
-#define SEARCH_MV(method)\
-    do {\
-        for (mb_y = 0; mb_y < s->b_height; mb_y++)\
-            for (mb_x = 0; mb_x < s->b_width; mb_x++) {\
-                const int x_mb = mb_x << s->log2_mb_size;\
-                const int y_mb = mb_y << s->log2_mb_size;\
-                int mv[2] = {x_mb, y_mb};\
-                ff_me_search_##method(me_ctx, x_mb, y_mb, mv);\
-                add_mv_data(((AVMotionVector *) sd->data) + mv_count++, me_ctx->mb_size, x_mb, y_mb, mv[0], mv[1], dir);\
-            }\
-    } while (0)
-
 #define ADD_PRED(preds, px, py)\
     do {\
         preds.mvs[preds.nb][0] = px;\
@@ -137,6 +125,152 @@ static void add_mv_data(AVMotionVector *mv, int mb_size,
         preds.nb++;\
     } while(0)
 
+typedef struct ThreadData {
+    MEContext *s;
+    AVMotionVector *mvs;
+    int dir;
+} ThreadData;
+
+static void search_mv(AVMotionEstContext *me_ctx, void *arg, int mb_x, int mb_y)
+{
+    ThreadData *td = arg;
+    MEContext *s = td->s;
+    const int dir = td->dir;
+    const int mb_i = mb_x + mb_y * s->b_width;
+    const int x_mb = mb_x << s->log2_mb_size;
+    const int y_mb = mb_y << s->log2_mb_size;
+    int mv[2] = {x_mb, y_mb};
+    AVMotionEstPredictor *preds = me_ctx->preds;
+
+    switch (s->method) {
+    case AV_ME_METHOD_DS:
+        ff_me_search_ds(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_ESA:
+        ff_me_search_esa(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_FSS:
+        ff_me_search_fss(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_NTSS:
+        ff_me_search_ntss(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_TDLS:
+        ff_me_search_tdls(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_TSS:
+        ff_me_search_tss(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_HEXBS:
+        ff_me_search_hexbs(me_ctx, x_mb, y_mb, mv);
+        break;
+    case AV_ME_METHOD_UMH:
+        preds[0].nb = 0;
+
+        ADD_PRED(preds[0], 0, 0);
+
+        //left mb in current frame
+        if (mb_x > 0)
+            ADD_PRED(preds[0], s->mv_table[0][mb_i - 1][dir][0], s->mv_table[0][mb_i - 1][dir][1]);
+
+        if (mb_y > 0) {
+            //top mb in current frame
+            ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width][dir][0], s->mv_table[0][mb_i - s->b_width][dir][1]);
+
+            //top-right mb in current frame
+            if (mb_x + 1 < s->b_width)
+                ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width + 1][dir][0], s->mv_table[0][mb_i - s->b_width + 1][dir][1]);
+            //top-left mb in current frame
+            else if (mb_x > 0)
+                ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width - 1][dir][0], s->mv_table[0][mb_i - s->b_width - 1][dir][1]);
+        }
+
+        //median predictor
+        if (preds[0].nb == 4) {
+            me_ctx->pred_x = mid_pred(preds[0].mvs[1][0], preds[0].mvs[2][0], preds[0].mvs[3][0]);
+            me_ctx->pred_y = mid_pred(preds[0].mvs[1][1], preds[0].mvs[2][1], preds[0].mvs[3][1]);
+        } else if (preds[0].nb == 3) {
+            me_ctx->pred_x = mid_pred(0, preds[0].mvs[1][0], preds[0].mvs[2][0]);
+            me_ctx->pred_y = mid_pred(0, preds[0].mvs[1][1], preds[0].mvs[2][1]);
+        } else if (preds[0].nb == 2) {
+            me_ctx->pred_x = preds[0].mvs[1][0];
+            me_ctx->pred_y = preds[0].mvs[1][1];
+        } else {
+            me_ctx->pred_x = 0;
+            me_ctx->pred_y = 0;
+        }
+
+        ff_me_search_umh(me_ctx, x_mb, y_mb, mv);
+
+        s->mv_table[0][mb_i][dir][0] = mv[0] - x_mb;
+        s->mv_table[0][mb_i][dir][1] = mv[1] - y_mb;
+        break;
+    case AV_ME_METHOD_EPZS:
+        preds[0].nb = 0;
+        preds[1].nb = 0;
+
+        ADD_PRED(preds[0], 0, 0);
+
+        //left mb in current frame
+        if (mb_x > 0)
+            ADD_PRED(preds[0], s->mv_table[0][mb_i - 1][dir][0], s->mv_table[0][mb_i - 1][dir][1]);
+
+        //top mb in current frame
+        if (mb_y > 0)
+            ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width][dir][0], s->mv_table[0][mb_i - s->b_width][dir][1]);
+
+        //top-right mb in current frame
+        if (mb_y > 0 && mb_x + 1 < s->b_width)
+            ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width + 1][dir][0], s->mv_table[0][mb_i - s->b_width + 1][dir][1]);
+
+        //median predictor
+        if (preds[0].nb == 4) {
+            me_ctx->pred_x = mid_pred(preds[0].mvs[1][0], preds[0].mvs[2][0], preds[0].mvs[3][0]);
+            me_ctx->pred_y = mid_pred(preds[0].mvs[1][1], preds[0].mvs[2][1], preds[0].mvs[3][1]);
+        } else if (preds[0].nb == 3) {
+            me_ctx->pred_x = mid_pred(0, preds[0].mvs[1][0], preds[0].mvs[2][0]);
+            me_ctx->pred_y = mid_pred(0, preds[0].mvs[1][1], preds[0].mvs[2][1]);
+        } else if (preds[0].nb == 2) {
+            me_ctx->pred_x = preds[0].mvs[1][0];
+            me_ctx->pred_y = preds[0].mvs[1][1];
+        } else {
+            me_ctx->pred_x = 0;
+            me_ctx->pred_y = 0;
+        }
+
+        //collocated mb in prev frame
+        ADD_PRED(preds[0], s->mv_table[1][mb_i][dir][0], s->mv_table[1][mb_i][dir][1]);
+
+        //accelerator motion vector of collocated block in prev frame
+        ADD_PRED(preds[1], s->mv_table[1][mb_i][dir][0] + (s->mv_table[1][mb_i][dir][0] - s->mv_table[2][mb_i][dir][0]),
+                           s->mv_table[1][mb_i][dir][1] + (s->mv_table[1][mb_i][dir][1] - s->mv_table[2][mb_i][dir][1]));
+
+        //left mb in prev frame
+        if (mb_x > 0)
+            ADD_PRED(preds[1], s->mv_table[1][mb_i - 1][dir][0], s->mv_table[1][mb_i - 1][dir][1]);
+
+        //top mb in prev frame
+        if (mb_y > 0)
+            ADD_PRED(preds[1], s->mv_table[1][mb_i - s->b_width][dir][0], s->mv_table[1][mb_i - s->b_width][dir][1]);
+
+        //right mb in prev frame
+        if (mb_x + 1 < s->b_width)
+            ADD_PRED(preds[1], s->mv_table[1][mb_i + 1][dir][0], s->mv_table[1][mb_i + 1][dir][1]);
+
+        //bottom mb in prev frame
+        if (mb_y + 1 < s->b_height)
+            ADD_PRED(preds[1], s->mv_table[1][mb_i + s->b_width][dir][0], s->mv_table[1][mb_i + s->b_width][dir][1]);
+
+        ff_me_search_epzs(me_ctx, x_mb, y_mb, mv);
+
+        s->mv_table[0][mb_i][dir][0] = mv[0] - x_mb;
+        s->mv_table[0][mb_i][dir][1] = mv[1] - y_mb;
+        break;
+    }
+
+    add_mv_data(td->mvs + dir * s->b_count + mb_i, s->mb_size, x_mb, y_mb, mv[0], mv[1], dir);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -144,9 +278,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
     AVMotionEstContext *me_ctx = &s->me_ctx;
     AVFrameSideData *sd;
     AVFrame *out;
-    int mb_x, mb_y, dir;
-    int32_t mv_count = 0;
-    int ret;
+    ThreadData td;
+    int dir, ret;
 
     if (frame->pts == AV_NOPTS_VALUE) {
         ret = ff_filter_frame(ctx->outputs[0], frame);
@@ -183,145 +316,19 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
     me_ctx->data_cur = s->cur->data[0];
     me_ctx->linesize = s->cur->linesize[0];
 
+    td.s   = s;
+    td.mvs = (AVMotionVector *)sd->data;
+
     for (dir = 0; dir < 2; dir++) {
         me_ctx->data_ref = (dir ? s->next : s->prev)->data[0];
-
-        if (s->method == AV_ME_METHOD_DS)
-            SEARCH_MV(ds);
-        else if (s->method == AV_ME_METHOD_ESA)
-            SEARCH_MV(esa);
-        else if (s->method == AV_ME_METHOD_FSS)
-            SEARCH_MV(fss);
-        else if (s->method == AV_ME_METHOD_NTSS)
-            SEARCH_MV(ntss);
-        else if (s->method == AV_ME_METHOD_TDLS)
-            SEARCH_MV(tdls);
-        else if (s->method == AV_ME_METHOD_TSS)
-            SEARCH_MV(tss);
-        else if (s->method == AV_ME_METHOD_HEXBS)
-            SEARCH_MV(hexbs);
-        else if (s->method == AV_ME_METHOD_UMH) {
-            for (mb_y = 0; mb_y < s->b_height; mb_y++)
-                for (mb_x = 0; mb_x < s->b_width; mb_x++) {
-                    const int mb_i = mb_x + mb_y * s->b_width;
-                    const int x_mb = mb_x << s->log2_mb_size;
-                    const int y_mb = mb_y << s->log2_mb_size;
-                    int mv[2] = {x_mb, y_mb};
-
-                    AVMotionEstPredictor *preds = me_ctx->preds;
-                    preds[0].nb = 0;
-
-                    ADD_PRED(preds[0], 0, 0);
-
-                    //left mb in current frame
-                    if (mb_x > 0)
-                        ADD_PRED(preds[0], s->mv_table[0][mb_i - 1][dir][0], s->mv_table[0][mb_i - 1][dir][1]);
-
-                    if (mb_y > 0) {
-                        //top mb in current frame
-                        ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width][dir][0], s->mv_table[0][mb_i - s->b_width][dir][1]);
-
-                        //top-right mb in current frame
-                        if (mb_x + 1 < s->b_width)
-                            ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width + 1][dir][0], s->mv_table[0][mb_i - s->b_width + 1][dir][1]);
-                        //top-left mb in current frame
-                        else if (mb_x > 0)
-                            ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width - 1][dir][0], s->mv_table[0][mb_i - s->b_width - 1][dir][1]);
-                    }
-
-                    //median predictor
-                    if (preds[0].nb == 4) {
-                        me_ctx->pred_x = mid_pred(preds[0].mvs[1][0], preds[0].mvs[2][0], preds[0].mvs[3][0]);
-                        me_ctx->pred_y = mid_pred(preds[0].mvs[1][1], preds[0].mvs[2][1], preds[0].mvs[3][1]);
-                    } else if (preds[0].nb == 3) {
-                        me_ctx->pred_x = mid_pred(0, preds[0].mvs[1][0], preds[0].mvs[2][0]);
-                        me_ctx->pred_y = mid_pred(0, preds[0].mvs[1][1], preds[0].mvs[2][1]);
-                    } else if (preds[0].nb == 2) {
-                        me_ctx->pred_x = preds[0].mvs[1][0];
-                        me_ctx->pred_y = preds[0].mvs[1][1];
-                    } else {
-                        me_ctx->pred_x = 0;
-                        me_ctx->pred_y = 0;
-                    }
-
-                    ff_me_search_umh(me_ctx, x_mb, y_mb, mv);
-
-                    s->mv_table[0][mb_i][dir][0] = mv[0] - x_mb;
-                    s->mv_table[0][mb_i][dir][1] = mv[1] - y_mb;
-                    add_mv_data(((AVMotionVector *) sd->data) + mv_count++, me_ctx->mb_size, x_mb, y_mb, mv[0], mv[1], dir);
-                }
-
-        } else if (s->method == AV_ME_METHOD_EPZS) {
-
-            for (mb_y = 0; mb_y < s->b_height; mb_y++)
-                for (mb_x = 0; mb_x < s->b_width; mb_x++) {
-                    const int mb_i = mb_x + mb_y * s->b_width;
-                    const int x_mb = mb_x << s->log2_mb_size;
-                    const int y_mb = mb_y << s->log2_mb_size;
-                    int mv[2] = {x_mb, y_mb};
-
-                    AVMotionEstPredictor *preds = me_ctx->preds;
-                    preds[0].nb = 0;
-                    preds[1].nb = 0;
-
-                    ADD_PRED(preds[0], 0, 0);
-
-                    //left mb in current frame
-                    if (mb_x > 0)
-                        ADD_PRED(preds[0], s->mv_table[0][mb_i - 1][dir][0], s->mv_table[0][mb_i - 1][dir][1]);
-
-                    //top mb in current frame
-                    if (mb_y > 0)
-                        ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width][dir][0], s->mv_table[0][mb_i - s->b_width][dir][1]);
-
-                    //top-right mb in current frame
-                    if (mb_y > 0 && mb_x + 1 < s->b_width)
-                        ADD_PRED(preds[0], s->mv_table[0][mb_i - s->b_width + 1][dir][0], s->mv_table[0][mb_i - s->b_width + 1][dir][1]);
-
-                    //median predictor
-                    if (preds[0].nb == 4) {
-                        me_ctx->pred_x = mid_pred(preds[0].mvs[1][0], preds[0].mvs[2][0], preds[0].mvs[3][0]);
-                        me_ctx->pred_y = mid_pred(preds[0].mvs[1][1], preds[0].mvs[2][1], preds[0].mvs[3][1]);
-                    } else if (preds[0].nb == 3) {
-                        me_ctx->pred_x = mid_pred(0, preds[0].mvs[1][0], preds[0].mvs[2][0]);
-                        me_ctx->pred_y = mid_pred(0, preds[0].mvs[1][1], preds[0].mvs[2][1]);
-                    } else if (preds[0].nb == 2) {
-                        me_ctx->pred_x = preds[0].mvs[1][0];
-                        me_ctx->pred_y = preds[0].mvs[1][1];
-                    } else {
-                        me_ctx->pred_x = 0;
-                        me_ctx->pred_y = 0;
-                    }
-
-                    //collocated mb in prev frame
-                    ADD_PRED(preds[0], s->mv_table[1][mb_i][dir][0], s->mv_table[1][mb_i][dir][1]);
-
-                    //accelerator motion vector of collocated block in prev frame
-                    ADD_PRED(preds[1], s->mv_table[1][mb_i][dir][0] + (s->mv_table[1][mb_i][dir][0] - s->mv_table[2][mb_i][dir][0]),
-                                       s->mv_table[1][mb_i][dir][1] + (s->mv_table[1][mb_i][dir][1] - s->mv_table[2][mb_i][dir][1]));
-
-                    //left mb in prev frame
-                    if (mb_x > 0)
-                        ADD_PRED(preds[1], s->mv_table[1][mb_i - 1][dir][0], s->mv_table[1][mb_i - 1][dir][1]);
-
-                    //top mb in prev frame
-                    if (mb_y > 0)
-                        ADD_PRED(preds[1], s->mv_table[1][mb_i - s->b_width][dir][0], s->mv_table[1][mb_i - s->b_width][dir][1]);
-
-                    //right mb in prev frame
-                    if (mb_x + 1 < s->b_width)
-                        ADD_PRED(preds[1], s->mv_table[1][mb_i + 1][dir][0], s->mv_table[1][mb_i + 1][dir][1]);
-
-                    //bottom mb in prev frame
-                    if (mb_y + 1 < s->b_height)
-                        ADD_PRED(preds[1], s->mv_table[1][mb_i + s->b_width][dir][0], s->mv_table[1][mb_i + s->b_width][dir][1]);
-
-                    ff_me_search_epzs(me_ctx, x_mb, y_mb, mv);
-
-                    s->mv_table[0][mb_i][dir][0] = mv[0] - x_mb;
-                    s->mv_table[0][mb_i][dir][1] = mv[1] - y_mb;
-                    add_mv_data(((AVMotionVector *) sd->data) + mv_count++, s->mb_size, x_mb, y_mb, mv[0], mv[1], dir);
-                }
+        td.dir = dir;
+
+        ret = ff_me_execute(ctx, me_ctx, s->b_width, s->b_height,
+                            s->method == AV_ME_METHOD_UMH || s->method == AV_ME_METHOD_EPZS,
+                            search_mv, &td);
+        if (ret < 0) {
+            av_frame_free(&out);
+            return ret;
         }
     }
 
@@ -339,6 +346,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     for (i = 0; i < 3; i++)
         av_freep(&s->mv_table[i]);
+
+    ff_me_uninit_context(&s->me_ctx);
 }
 
 static const AVFilterPad mestimate_inputs[] = {
@@ -363,7 +372,7 @@ const AVFilter ff_vf_mestimate = {
     .priv_size     = sizeof(MEContext),
     .priv_class    = &mestimate_class,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(mestimate_inputs),
     FILTER_OUTPUTS(mestimate_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
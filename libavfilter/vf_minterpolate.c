@@ -247,11 +247,23 @@ static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_NONE
 };
 
+/**
+ * SAD function for the overlapped 2 * mb_size blocks, the window only
+ * doubles the block size for even mb_size.
+ */
+static av_pixelutils_sad_fn get_sad_fn_ob(const AVMotionEstContext *me_ctx)
+{
+    if (me_ctx->mb_size & 1)
+        return NULL;
+    return ff_me_get_sad_fn(me_ctx, 2 * me_ctx->mb_size);
+}
+
 static uint64_t get_sbad(AVMotionEstContext *me_ctx, int x, int y, int x_mv, int y_mv)
 {
     uint8_t *data_cur = me_ctx->data_cur;
     uint8_t *data_next = me_ctx->data_ref;
     int linesize = me_ctx->linesize;
+    av_pixelutils_sad_fn sad = ff_me_get_sad_fn(me_ctx, me_ctx->mb_size);
     int mv_x1 = x_mv - x;
     int mv_y1 = y_mv - y;
     int mv_x, mv_y, i, j;
@@ -265,9 +277,13 @@ static uint64_t get_sbad(AVMotionEstContext *me_ctx, int x, int y, int x_mv, int
     data_cur += (y + mv_y) * linesize;
     data_next += (y - mv_y) * linesize;
 
-    for (j = 0; j < me_ctx->mb_size; j++)
-        for (i = 0; i < me_ctx->mb_size; i++)
-            sbad += FFABS(data_cur[x + mv_x + i + j * linesize] - data_next[x - mv_x + i + j * linesize]);
+    if (sad) {
+        sbad = sad(data_cur + x + mv_x, linesize, data_next + x - mv_x, linesize);
+    } else {
+        for (j = 0; j < me_ctx->mb_size; j++)
+            for (i = 0; i < me_ctx->mb_size; i++)
+                sbad += FFABS(data_cur[x + mv_x + i + j * linesize] - data_next[x - mv_x + i + j * linesize]);
+    }
 
     return sbad + (FFABS(mv_x1 - me_ctx->pred_x) + FFABS(mv_y1 - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -281,6 +297,7 @@ static uint64_t get_sbad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv,
     int x_max = me_ctx->x_max - me_ctx->mb_size / 2;
     int y_min = me_ctx->y_min + me_ctx->mb_size / 2;
     int y_max = me_ctx->y_max - me_ctx->mb_size / 2;
+    av_pixelutils_sad_fn sad = get_sad_fn_ob(me_ctx);
     int mv_x1 = x_mv - x;
     int mv_y1 = y_mv - y;
     int mv_x, mv_y, i, j;
@@ -291,9 +308,15 @@ static uint64_t get_sbad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv,
     mv_x = av_clip(x_mv - x, -FFMIN(x - x_min, x_max - x), FFMIN(x - x_min, x_max - x));
     mv_y = av_clip(y_mv - y, -FFMIN(y - y_min, y_max - y), FFMIN(y - y_min, y_max - y));
 
-    for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
-        for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
-            sbad += FFABS(data_cur[x + mv_x + i + (y + mv_y + j) * linesize] - data_next[x - mv_x + i + (y - mv_y + j) * linesize]);
+    if (sad) {
+        const int ob = me_ctx->mb_size / 2;
+        sbad = sad(data_cur  + x + mv_x - ob + (y + mv_y - ob) * linesize, linesize,
+                   data_next + x - mv_x - ob + (y - mv_y - ob) * linesize, linesize);
+    } else {
+        for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
+            for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
+                sbad += FFABS(data_cur[x + mv_x + i + (y + mv_y + j) * linesize] - data_next[x - mv_x + i + (y - mv_y + j) * linesize]);
+    }
 
     return sbad + (FFABS(mv_x1 - me_ctx->pred_x) + FFABS(mv_y1 - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -307,6 +330,7 @@ static uint64_t get_sad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv, i
     int x_max = me_ctx->x_max - me_ctx->mb_size / 2;
     int y_min = me_ctx->y_min + me_ctx->mb_size / 2;
     int y_max = me_ctx->y_max - me_ctx->mb_size / 2;
+    av_pixelutils_sad_fn sad_fn = get_sad_fn_ob(me_ctx);
     int mv_x = x_mv - x;
     int mv_y = y_mv - y;
     int i, j;
@@ -317,9 +341,15 @@ static uint64_t get_sad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv, i
     x_mv = av_clip(x_mv, x_min, x_max);
     y_mv = av_clip(y_mv, y_min, y_max);
 
-    for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
-        for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
-            sad += FFABS(data_ref[x_mv + i + (y_mv + j) * linesize] - data_cur[x + i + (y + j) * linesize]);
+    if (sad_fn) {
+        const int ob = me_ctx->mb_size / 2;
+        sad = sad_fn(data_ref + x_mv - ob + (y_mv - ob) * linesize, linesize,
+                     data_cur + x    - ob + (y    - ob) * linesize, linesize);
+    } else {
+        for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
+            for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
+                sad += FFABS(data_ref[x_mv + i + (y_mv + j) * linesize] - data_cur[x + i + (y + j) * linesize]);
+    }
 
     return sad + (FFABS(mv_x - me_ctx->pred_x) + FFABS(mv_y - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -413,9 +443,18 @@ static int config_output(AVFilterLink *outlink)
         preds.nb++;\
     } while(0)
 
-static void search_mv(MIContext *mi_ctx, Block *blocks, int mb_x, int mb_y, int dir)
+typedef struct ThreadData {
+    MIContext *mi_ctx;
+    Block *blocks;
+    int dir;
+} ThreadData;
+
+static void search_mv(AVMotionEstContext *me_ctx, void *arg, int mb_x, int mb_y)
 {
-    AVMotionEstContext *me_ctx = &mi_ctx->me_ctx;
+    ThreadData *td = arg;
+    MIContext *mi_ctx = td->mi_ctx;
+    Block *blocks = td->blocks;
+    const int dir = td->dir;
     AVMotionEstPredictor *preds = me_ctx->preds;
     Block *block = &blocks[mb_x + mb_y * mi_ctx->b_width];
 
@@ -555,8 +594,10 @@ static void search_mv(MIContext *mi_ctx, Block *blocks, int mb_x, int mb_y, int
     block->mvs[dir][1] = mv[1] - y_mb;
 }
 
-static void bilateral_me(MIContext *mi_ctx)
+static int bilateral_me(AVFilterContext *ctx)
 {
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData td = { mi_ctx, mi_ctx->int_blocks, 0 };
     Block *block;
     int mb_x, mb_y;
 
@@ -571,9 +612,19 @@ static void bilateral_me(MIContext *mi_ctx)
             block->mvs[0][1] = 0;
         }
 
-    for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
-        for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
-            search_mv(mi_ctx, mi_ctx->int_blocks, mb_x, mb_y, 0);
+    return ff_me_execute(ctx, &mi_ctx->me_ctx, mi_ctx->b_width, mi_ctx->b_height,
+                         mi_ctx->me_method == AV_ME_METHOD_EPZS || mi_ctx->me_method == AV_ME_METHOD_UMH,
+                         search_mv, &td);
+}
+
+static void block_sbad(AVMotionEstContext *me_ctx, void *arg, int mb_x, int mb_y)
+{
+    MIContext *mi_ctx = arg;
+    Block *block = &mi_ctx->int_blocks[mb_x + mb_y * mi_ctx->b_width];
+    int x_mb = mb_x << mi_ctx->log2_mb_size;
+    int y_mb = mb_y << mi_ctx->log2_mb_size;
+
+    block->sbad = get_sbad(me_ctx, x_mb, y_mb, x_mb + block->mvs[0][0], y_mb + block->mvs[0][1]);
 }
 
 static int var_size_bme(MIContext *mi_ctx, Block *block, int x_mb, int y_mb, int n)
@@ -752,13 +803,18 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
 
             if (mi_ctx->frames[1].avf) {
                 for (dir = 0; dir < 2; dir++) {
+                    ThreadData td = { mi_ctx, mi_ctx->frames[2].blocks, dir };
+                    int ret;
+
                     mi_ctx->me_ctx.linesize = mi_ctx->frames[2].avf->linesize[0];
                     mi_ctx->me_ctx.data_cur = mi_ctx->frames[2].avf->data[0];
                     mi_ctx->me_ctx.data_ref = mi_ctx->frames[dir ? 3 : 1].avf->data[0];
 
-                    for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
-                        for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
-                            search_mv(mi_ctx, mi_ctx->frames[2].blocks, mb_x, mb_y, dir);
+                    ret = ff_me_execute(ctx, &mi_ctx->me_ctx, mi_ctx->b_width, mi_ctx->b_height,
+                                        mi_ctx->me_method == AV_ME_METHOD_EPZS || mi_ctx->me_method == AV_ME_METHOD_UMH,
+                                        search_mv, &td);
+                    if (ret < 0)
+                        return ret;
                 }
             }
 
@@ -773,18 +829,14 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
             mi_ctx->me_ctx.data_cur = mi_ctx->frames[1].avf->data[0];
             mi_ctx->me_ctx.data_ref = mi_ctx->frames[2].avf->data[0];
 
-            bilateral_me(mi_ctx);
+            if ((ret = bilateral_me(ctx)) < 0)
+                return ret;
 
             if (mi_ctx->mc_mode == MC_MODE_AOBMC) {
-
-                for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
-                    for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++) {
-                        int x_mb = mb_x << mi_ctx->log2_mb_size;
-                        int y_mb = mb_y << mi_ctx->log2_mb_size;
-                        block = &mi_ctx->int_blocks[mb_x + mb_y * mi_ctx->b_width];
-
-                        block->sbad = get_sbad(&mi_ctx->me_ctx, x_mb, y_mb, x_mb + block->mvs[0][0], y_mb + block->mvs[0][1]);
-                    }
+                ret = ff_me_execute(ctx, &mi_ctx->me_ctx, mi_ctx->b_width, mi_ctx->b_height,
+                                    0, block_sbad, mi_ctx);
+                if (ret < 0)
+                    return ret;
             }
 
             if (mi_ctx->vsbmc) {
@@ -805,7 +857,9 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
 
                 mi_ctx->clusters[0].nb = mi_ctx->b_count;
 
-                if (ret = cluster_mvs(mi_ctx))
+                ret = cluster_mvs(mi_ctx);
+                emms_c();
+                if (ret)
                     return ret;
             }
         }
@@ -1141,6 +1195,7 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
                         bilateral_obmc(mi_ctx, block, mb_x, mb_y, alpha);
 
                     }
+                emms_c();
 
                 set_frame_data(mi_ctx, alpha, avf_out);
             }
@@ -1228,6 +1283,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     for (i = 0; i < 3; i++)
         av_freep(&mi_ctx->mv_table[i]);
+
+    ff_me_uninit_context(&mi_ctx->me_ctx);
 }
 
 static const AVFilterPad minterpolate_inputs[] = {
@@ -1253,6 +1310,7 @@ const AVFilter ff_vf_minterpolate = {
     .priv_size     = sizeof(MIContext),
     .priv_class    = &minterpolate_class,
     .uninit        = uninit,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(minterpolate_inputs),
     FILTER_OUTPUTS(minterpolate_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
@@ -49,6 +49,7 @@ typedef struct OWDenoiseContext {
     int linesize;
     int hsub, vsub;
     int pixel_depth;
+    int nb_threads;
 } OWDenoiseContext;
 
 #define OFFSET(x) offsetof(OWDenoiseContext, x)
@@ -145,10 +146,10 @@ static inline void compose(float *dst, const float *src_l, const float *src_h,
 
 static inline void decompose2D(float *dst_l, float *dst_h, const float *src,
                                int xlinesize, int ylinesize,
-                               int step, int w, int h)
+                               int step, int w, int slice_start, int slice_end)
 {
     int y, x;
-    for (y = 0; y < h; y++)
+    for (y = slice_start; y < slice_end; y++)
         for (x = 0; x < step; x++)
             decompose(dst_l + ylinesize*y + xlinesize*x,
                       dst_h + ylinesize*y + xlinesize*x,
@@ -158,10 +159,10 @@ static inline void decompose2D(float *dst_l, float *dst_h, const float *src,
 
 static inline void compose2D(float *dst, const float *src_l, const float *src_h,
                              int xlinesize, int ylinesize,
-                             int step, int w, int h)
+                             int step, int w, int slice_start, int slice_end)
 {
     int y, x;
-    for (y = 0; y < h; y++)
+    for (y = slice_start; y < slice_end; y++)
         for (x = 0; x < step; x++)
             compose(dst   + ylinesize*y + xlinesize*x,
                     src_l + ylinesize*y + xlinesize*x,
@@ -169,52 +170,126 @@ static inline void compose2D(float *dst, const float *src_l, const float *src_h,
                     step * xlinesize, (w - x + step - 1) / step);
 }
 
-static void decompose2D2(float *dst[4], float *src, float *temp[2],
+typedef struct ThreadData {
+    float *dst[2];
+    const float *src[2];
+    int xlinesize, ylinesize;
+    int step, w, h;
+} ThreadData;
+
+static int decompose2D_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadData *td = arg;
+    const int slice_start = (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+
+    decompose2D(td->dst[0], td->dst[1], td->src[0], td->xlinesize, td->ylinesize,
+                td->step, td->w, slice_start, slice_end);
+
+    return 0;
+}
+
+static int compose2D_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadData *td = arg;
+    const int slice_start = (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+
+    compose2D(td->dst[0], td->src[0], td->src[1], td->xlinesize, td->ylinesize,
+              td->step, td->w, slice_start, slice_end);
+
+    return 0;
+}
+
+/* each 1D transform only depends on its own row or column, so the rows or
+ * columns of a pass are split across the threads */
+static void decompose2D_threaded(AVFilterContext *ctx, float *dst_l, float *dst_h,
+                                 const float *src, int xlinesize, int ylinesize,
+                                 int step, int w, int h)
+{
+    OWDenoiseContext *s = ctx->priv;
+    ThreadData td = { .dst = { dst_l, dst_h }, .src = { src },
+                      .xlinesize = xlinesize, .ylinesize = ylinesize,
+                      .step = step, .w = w, .h = h };
+
+    ff_filter_execute(ctx, decompose2D_slice, &td, NULL, FFMIN(h, s->nb_threads));
+}
+
+static void compose2D_threaded(AVFilterContext *ctx, float *dst,
+                               const float *src_l, const float *src_h,
+                               int xlinesize, int ylinesize,
+                               int step, int w, int h)
+{
+    OWDenoiseContext *s = ctx->priv;
+    ThreadData td = { .dst = { dst }, .src = { src_l, src_h },
+                      .xlinesize = xlinesize, .ylinesize = ylinesize,
+                      .step = step, .w = w, .h = h };
+
+    ff_filter_execute(ctx, compose2D_slice, &td, NULL, FFMIN(h, s->nb_threads));
+}
+
+static void decompose2D2(AVFilterContext *ctx, float *dst[4], float *src, float *temp[2],
                          int linesize, int step, int w, int h)
 {
-    decompose2D(temp[0], temp[1], src,     1, linesize, step, w, h);
-    decompose2D( dst[0],  dst[1], temp[0], linesize, 1, step, h, w);
-    decompose2D( dst[2],  dst[3], temp[1], linesize, 1, step, h, w);
+    decompose2D_threaded(ctx, temp[0], temp[1], src,     1, linesize, step, w, h);
+    decompose2D_threaded(ctx,  dst[0],  dst[1], temp[0], linesize, 1, step, h, w);
+    decompose2D_threaded(ctx,  dst[2],  dst[3], temp[1], linesize, 1, step, h, w);
 }
 
-static void compose2D2(float *dst, float *src[4], float *temp[2],
+static void compose2D2(AVFilterContext *ctx, float *dst, float *src[4], float *temp[2],
                        int linesize, int step, int w, int h)
 {
-    compose2D(temp[0],  src[0],  src[1], linesize, 1, step, h, w);
-    compose2D(temp[1],  src[2],  src[3], linesize, 1, step, h, w);
-    compose2D(dst,     temp[0], temp[1], 1, linesize, step, w, h);
+    compose2D_threaded(ctx, temp[0],  src[0],  src[1], linesize, 1, step, h, w);
+    compose2D_threaded(ctx, temp[1],  src[2],  src[3], linesize, 1, step, h, w);
+    compose2D_threaded(ctx, dst,     temp[0], temp[1], 1, linesize, step, w, h);
 }
 
-static void filter(OWDenoiseContext *s,
-                   uint8_t       *dst, int dst_linesize,
-                   const uint8_t *src, int src_linesize,
-                   int width, int height, double strength)
-{
-    int x, y, i, j, depth = s->depth;
+typedef struct PlaneThreadData {
+    uint8_t *dst;
+    const uint8_t *src;
+    int dst_linesize, src_linesize;
+    int width, height;
+    int depth;
+    double strength;
+} PlaneThreadData;
 
-    while (1<<depth > width || 1<<depth > height)
-        depth--;
+static int read_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OWDenoiseContext *s = ctx->priv;
+    const PlaneThreadData *td = arg;
+    const int slice_start = (td->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr+1)) / nb_jobs;
+    int x, y;
 
     if (s->pixel_depth <= 8) {
-        for (y = 0; y < height; y++)
-            for(x = 0; x < width; x++)
-                s->plane[0][0][y*s->linesize + x] = src[y*src_linesize + x];
+        for (y = slice_start; y < slice_end; y++)
+            for(x = 0; x < td->width; x++)
+                s->plane[0][0][y*s->linesize + x] = td->src[y*td->src_linesize + x];
     } else {
-        const uint16_t *src16 = (const uint16_t *)src;
+        const uint16_t *src16 = (const uint16_t *)td->src;
+        const int src_linesize = td->src_linesize / 2;
 
-        src_linesize /= 2;
-        for (y = 0; y < height; y++)
-            for(x = 0; x < width; x++)
+        for (y = slice_start; y < slice_end; y++)
+            for(x = 0; x < td->width; x++)
                 s->plane[0][0][y*s->linesize + x] = src16[y*src_linesize + x];
     }
 
-    for (i = 0; i < depth; i++)
-        decompose2D2(s->plane[i + 1], s->plane[i][0], s->plane[0] + 1, s->linesize, 1<<i, width, height);
+    return 0;
+}
 
-    for (i = 0; i < depth; i++) {
+static int threshold_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OWDenoiseContext *s = ctx->priv;
+    const PlaneThreadData *td = arg;
+    const double strength = td->strength;
+    const int slice_start = (td->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr+1)) / nb_jobs;
+    int x, y, i, j;
+
+    for (i = 0; i < td->depth; i++) {
         for (j = 1; j < 4; j++) {
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++) {
+            for (y = slice_start; y < slice_end; y++) {
+                for (x = 0; x < td->width; x++) {
                     double v = s->plane[i + 1][j][y*s->linesize + x];
                     if      (v >  strength) v -= strength;
                     else if (v < -strength) v += strength;
@@ -224,28 +299,74 @@ static void filter(OWDenoiseContext *s,
             }
         }
     }
-    for (i = depth-1; i >= 0; i--)
-        compose2D2(s->plane[i][0], s->plane[i + 1], s->plane[0] + 1, s->linesize, 1<<i, width, height);
+
+    return 0;
+}
+
+static int write_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OWDenoiseContext *s = ctx->priv;
+    const PlaneThreadData *td = arg;
+    const int slice_start = (td->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr+1)) / nb_jobs;
+    int x, y, i;
 
     if (s->pixel_depth <= 8) {
-        for (y = 0; y < height; y++) {
-            for (x = 0; x < width; x++) {
+        for (y = slice_start; y < slice_end; y++) {
+            for (x = 0; x < td->width; x++) {
                 i = s->plane[0][0][y*s->linesize + x] + dither[x&7][y&7]*(1.0/64) + 1.0/128; // yes the rounding is insane but optimal :)
                 if ((unsigned)i > 255U) i = ~(i >> 31);
-                dst[y*dst_linesize + x] = i;
+                td->dst[y*td->dst_linesize + x] = i;
             }
         }
     } else {
-        uint16_t *dst16 = (uint16_t *)dst;
+        uint16_t *dst16 = (uint16_t *)td->dst;
+        const int dst_linesize = td->dst_linesize / 2;
 
-        dst_linesize /= 2;
-        for (y = 0; y < height; y++) {
-            for (x = 0; x < width; x++) {
+        for (y = slice_start; y < slice_end; y++) {
+            for (x = 0; x < td->width; x++) {
                 i = s->plane[0][0][y*s->linesize + x];
                 dst16[y*dst_linesize + x] = i;
             }
         }
     }
+
+    return 0;
+}
+
+static void filter(AVFilterContext *ctx,
+                   uint8_t       *dst, int dst_linesize,
+                   const uint8_t *src, int src_linesize,
+                   int width, int height, double strength)
+{
+    OWDenoiseContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(height, s->nb_threads);
+    PlaneThreadData td;
+    int i, depth = s->depth;
+
+    while (1<<depth > width || 1<<depth > height)
+        depth--;
+
+    td.dst          = dst;
+    td.src          = src;
+    td.dst_linesize = dst_linesize;
+    td.src_linesize = src_linesize;
+    td.width        = width;
+    td.height       = height;
+    td.depth        = depth;
+    td.strength     = strength;
+
+    ff_filter_execute(ctx, read_slice, &td, NULL, nb_jobs);
+
+    for (i = 0; i < depth; i++)
+        decompose2D2(ctx, s->plane[i + 1], s->plane[i][0], s->plane[0] + 1, s->linesize, 1<<i, width, height);
+
+    ff_filter_execute(ctx, threshold_slice, &td, NULL, nb_jobs);
+
+    for (i = depth-1; i >= 0; i--)
+        compose2D2(ctx, s->plane[i][0], s->plane[i + 1], s->plane[0] + 1, s->linesize, 1<<i, width, height);
+
+    ff_filter_execute(ctx, write_slice, &td, NULL, nb_jobs);
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -261,10 +382,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         out = in;
 
         if (s->luma_strength > 0)
-            filter(s, out->data[0], out->linesize[0], in->data[0], in->linesize[0], inlink->w, inlink->h, s->luma_strength);
+            filter(ctx, out->data[0], out->linesize[0], in->data[0], in->linesize[0], inlink->w, inlink->h, s->luma_strength);
         if (s->chroma_strength > 0) {
-            filter(s, out->data[1], out->linesize[1], in->data[1], in->linesize[1], cw,        ch,        s->chroma_strength);
-            filter(s, out->data[2], out->linesize[2], in->data[2], in->linesize[2], cw,        ch,        s->chroma_strength);
+            filter(ctx, out->data[1], out->linesize[1], in->data[1], in->linesize[1], cw,        ch,        s->chroma_strength);
+            filter(ctx, out->data[2], out->linesize[2], in->data[2], in->linesize[2], cw,        ch,        s->chroma_strength);
         }
     } else {
         out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
@@ -275,13 +396,13 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
 
         if (s->luma_strength > 0) {
-            filter(s, out->data[0], out->linesize[0], in->data[0], in->linesize[0], inlink->w, inlink->h, s->luma_strength);
+            filter(ctx, out->data[0], out->linesize[0], in->data[0], in->linesize[0], inlink->w, inlink->h, s->luma_strength);
         } else {
             av_image_copy_plane(out->data[0], out->linesize[0], in ->data[0], in ->linesize[0], inlink->w, inlink->h);
         }
         if (s->chroma_strength > 0) {
-            filter(s, out->data[1], out->linesize[1], in->data[1], in->linesize[1], cw, ch, s->chroma_strength);
-            filter(s, out->data[2], out->linesize[2], in->data[2], in->linesize[2], cw, ch, s->chroma_strength);
+            filter(ctx, out->data[1], out->linesize[1], in->data[1], in->linesize[1], cw, ch, s->chroma_strength);
+            filter(ctx, out->data[2], out->linesize[2], in->data[2], in->linesize[2], cw, ch, s->chroma_strength);
         } else {
             av_image_copy_plane(out->data[1], out->linesize[1], in ->data[1], in ->linesize[1], inlink->w, inlink->h);
             av_image_copy_plane(out->data[2], out->linesize[2], in ->data[2], in ->linesize[2], inlink->w, inlink->h);
@@ -323,6 +444,7 @@ static int config_input(AVFilterLink *inlink)
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
     s->pixel_depth = desc->comp[0].depth;
+    s->nb_threads = ff_filter_get_nb_threads(inlink->dst);
 
     s->linesize = FFALIGN(inlink->w, 16);
     for (j = 0; j < 4; j++) {
@@ -370,5 +492,5 @@ const AVFilter ff_vf_owdenoise = {
     FILTER_OUTPUTS(owdenoise_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .priv_class    = &owdenoise_class,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -320,10 +320,65 @@ static int frame_needs_copy(PadContext *s, AVFrame *frame)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int needs_copy;
+} ThreadData;
+
+/* fill the rows of the [x, x + w) x [y0, y1) area which are inside the slice */
+static void fill_slice(PadContext *s, AVFrame *out, int x, int w,
+                       int y0, int y1, int slice_start, int slice_end)
+{
+    y0 = FFMAX(y0, slice_start);
+    y1 = FFMIN(y1, slice_end);
+    if (w > 0 && y1 > y0)
+        ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                          x, y0, w, y1 - y0);
+}
+
+static int pad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PadContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    /* the slices are aligned on the chroma rows, so that no chroma row
+     * is shared by two jobs */
+    const int nb_units = AV_CEIL_RSHIFT(s->h, s->draw.vsub_max);
+    const int slice_start = ((nb_units *  jobnr     ) / nb_jobs) << s->draw.vsub_max;
+    const int slice_end   = FFMIN(((nb_units * (jobnr + 1)) / nb_jobs) << s->draw.vsub_max, s->h);
+
+    /* top bar */
+    fill_slice(s, out, 0, s->w, 0, s->y, slice_start, slice_end);
+
+    /* bottom bar */
+    fill_slice(s, out, 0, s->w, s->y + s->in_h, s->h, slice_start, slice_end);
+
+    /* left border */
+    fill_slice(s, out, 0, s->x, s->y, s->y + in->height, slice_start, slice_end);
+
+    if (td->needs_copy) {
+        const int y0 = FFMAX(s->y, slice_start);
+        const int y1 = FFMIN(s->y + in->height, slice_end);
+
+        if (y1 > y0)
+            ff_copy_rectangle2(&s->draw, out->data, out->linesize,
+                               in->data, in->linesize,
+                               s->x, y0, 0, y0 - s->y, in->width, y1 - y0);
+    }
+
+    /* right border */
+    fill_slice(s, out, s->x + s->in_w, s->w - s->x - s->in_w,
+               s->y, s->y + in->height, slice_start, slice_end);
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    PadContext *s = inlink->dst->priv;
-    AVFilterLink *outlink = inlink->dst->outputs[0];
+    AVFilterContext *ctx = inlink->dst;
+    PadContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    ThreadData td;
     AVFrame *out;
     int needs_copy;
     if(s->eval_mode == EVAL_MODE_FRAME && (
@@ -376,34 +431,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         }
     }
 
-    /* top bar */
-    if (s->y) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, 0, s->w, s->y);
-    }
-
-    /* bottom bar */
-    if (s->h > s->y + s->in_h) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, s->y + s->in_h, s->w, s->h - s->y - s->in_h);
-    }
-
-    /* left border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      0, s->y, s->x, in->height);
-
-    if (needs_copy) {
-        ff_copy_rectangle2(&s->draw,
-                          out->data, out->linesize, in->data, in->linesize,
-                          s->x, s->y, 0, 0, in->width, in->height);
-    }
-
-    /* right border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      s->x + s->in_w, s->y, s->w - s->x - s->in_w,
-                      in->height);
+    td.in  = in;
+    td.out = out;
+    td.needs_copy = needs_copy;
+    ff_filter_execute(ctx, pad_slice, &td, NULL,
+                      FFMIN(AV_CEIL_RSHIFT(s->h, s->draw.vsub_max), ff_filter_get_nb_threads(ctx)));
 
     out->width  = s->w;
     out->height = s->h;
@@ -459,4 +491,5 @@ const AVFilter ff_vf_pad = {
     FILTER_INPUTS(avfilter_vf_pad_inputs),
     FILTER_OUTPUTS(avfilter_vf_pad_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
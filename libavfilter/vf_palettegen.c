@@ -60,6 +60,17 @@ enum {
 
 #define NBITS 5
 #define HIST_SIZE (1<<(4*NBITS))
+#define SLICE_HIST_SIZE (1<<(3*NBITS))
+
+typedef struct ThreadData {
+    const AVFrame *f1, *f2;
+} ThreadData;
+
+/* Per job state for the threaded histogram update */
+typedef struct HistSlice {
+    struct hist_node *histogram;            // colors of the slice, in scan order, hashed without alpha
+    int ret;                                // number of new colors or error code
+} HistSlice;
 
 typedef struct PaletteGenContext {
     const AVClass *class;
@@ -71,6 +82,8 @@ typedef struct PaletteGenContext {
 
     AVFrame *prev_frame;                    // previous frame used for the diff stats_mode
     struct hist_node histogram[HIST_SIZE];  // histogram/hashtable of the colors
+    HistSlice *slices;                      // per job histograms, merged into the main one
+    int nb_slices;
     struct color_ref **refs;                // references of all the colors used in the stream
     int nb_refs;                            // number of color references (or number of different colors)
     struct range_box boxes[256];            // define the segmentation of the colorspace (the final palette)
@@ -442,19 +455,17 @@ static inline unsigned color_hash(uint32_t color, int use_alpha)
 }
 
 /**
- * Locate the color in the hash table and increment its counter.
+ * Locate the color in the hash table node and add to its counter.
  */
-static int color_inc(struct hist_node *hist, uint32_t color, int use_alpha)
+static av_always_inline int node_add(struct hist_node *node, uint32_t color, uint64_t count)
 {
     int i;
-    const unsigned hash = color_hash(color, use_alpha);
-    struct hist_node *node = &hist[hash];
     struct color_ref *e;
 
     for (i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color) {
-            e->count++;
+            e->count += count;
             return 0;
         }
     }
@@ -464,19 +475,28 @@ static int color_inc(struct hist_node *hist, uint32_t color, int use_alpha)
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->count = 1;
+    e->count = count;
     return 1;
 }
 
+/**
+ * Locate the color in the hash table and increment its counter.
+ */
+static int color_inc(struct hist_node *hist, uint32_t color, int use_alpha)
+{
+    return node_add(&hist[color_hash(color, use_alpha)], color, 1);
+}
+
 /**
  * Update histogram when pixels differ from previous frame.
  */
 static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2, int use_alpha)
+                                 const AVFrame *f1, const AVFrame *f2,
+                                 int y_start, int y_end, int use_alpha)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
@@ -495,11 +515,12 @@ static int update_histogram_diff(struct hist_node *hist,
 /**
  * Simple histogram of the frame.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f, int use_alpha)
+static int update_histogram_frame(struct hist_node *hist, const AVFrame *f,
+                                  int y_start, int y_end, int use_alpha)
 {
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f->height; y++) {
+    for (y = y_start; y < y_end; y++) {
         const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
 
         for (x = 0; x < f->width; x++) {
@@ -512,6 +533,81 @@ static int update_histogram_frame(struct hist_node *hist, const AVFrame *f, int
     return nb_diff_colors;
 }
 
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    HistSlice *slice = &s->slices[jobnr];
+    const int height = td->f2->height;
+    const int slice_start = (height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (height * (jobnr+1)) / nb_jobs;
+
+    slice->ret = td->f1 ? update_histogram_diff(slice->histogram, td->f1, td->f2, slice_start, slice_end, 0)
+                        : update_histogram_frame(slice->histogram, td->f2, slice_start, slice_end, 0);
+    return slice->ret;
+}
+
+/**
+ * Merge the slice histograms into the main one. The slice tables are hashed
+ * without alpha, so each of their entries only feeds main entries sharing the
+ * same low bits: every job works on its own range of slice entries, and the
+ * slices are merged in order so the colors end up listed exactly as if the
+ * frame had been scanned by a single thread.
+ */
+static int merge_histograms(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteGenContext *s = ctx->priv;
+    const int nb_slices = *(const int *)arg;
+    const int start = (SLICE_HIST_SIZE / nb_jobs) *  jobnr;
+    const int end   = jobnr == nb_jobs - 1 ? SLICE_HIST_SIZE : (SLICE_HIST_SIZE / nb_jobs) * (jobnr+1);
+    int nb_diff_colors = 0;
+
+    for (int j = start; j < end; j++) {
+        for (int n = 0; n < nb_slices; n++) {
+            struct hist_node *node = &s->slices[n].histogram[j];
+
+            for (int i = 0; i < node->nb_entries; i++) {
+                const uint32_t color = node->entries[i].color;
+                const int ret = node_add(&s->histogram[color_hash(color, s->use_alpha)],
+                                         color, node->entries[i].count);
+                if (ret < 0) {
+                    s->slices[jobnr].ret = ret;
+                    return ret;
+                }
+                nb_diff_colors += ret;
+            }
+            node->nb_entries = 0;
+        }
+    }
+    s->slices[jobnr].ret = nb_diff_colors;
+    return 0;
+}
+
+static int update_histogram(AVFilterContext *ctx, const AVFrame *f1, const AVFrame *f2)
+{
+    PaletteGenContext *s = ctx->priv;
+    const int nb_jobs = FFMIN(f2->height, s->nb_slices);
+    ThreadData td = { .f1 = f1, .f2 = f2 };
+    int nb_diff_colors = 0;
+
+    if (nb_jobs <= 1)
+        return f1 ? update_histogram_diff(s->histogram, f1, f2, 0, f2->height, s->use_alpha)
+                  : update_histogram_frame(s->histogram, f2, 0, f2->height, s->use_alpha);
+
+    ff_filter_execute(ctx, update_histogram_slice, &td, NULL, nb_jobs);
+    for (int n = 0; n < nb_jobs; n++)
+        if (s->slices[n].ret < 0)
+            return s->slices[n].ret;
+
+    ff_filter_execute(ctx, merge_histograms, (void *)&nb_jobs, NULL, s->nb_slices);
+    for (int n = 0; n < s->nb_slices; n++) {
+        if (s->slices[n].ret < 0)
+            return s->slices[n].ret;
+        nb_diff_colors += s->slices[n].ret;
+    }
+    return nb_diff_colors;
+}
+
 /**
  * Update the histogram for each passing frame. No frame will be pushed here.
  */
@@ -519,8 +615,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in, s->use_alpha)
-                            : update_histogram_frame(s->histogram, in, s->use_alpha);
+    int ret = update_histogram(ctx, s->prev_frame, in);
 
     if (ret > 0)
         s->nb_refs += ret;
@@ -579,6 +674,43 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+static void free_slices(PaletteGenContext *s)
+{
+    for (int n = 0; n < s->nb_slices; n++) {
+        HistSlice *slice = &s->slices[n];
+
+        if (slice->histogram) {
+            for (int i = 0; i < SLICE_HIST_SIZE; i++)
+                av_freep(&slice->histogram[i].entries);
+            av_freep(&slice->histogram);
+        }
+    }
+    s->nb_slices = 0;
+    av_freep(&s->slices);
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    PaletteGenContext *s = ctx->priv;
+    const int nb_threads = ff_filter_get_nb_threads(ctx);
+
+    free_slices(s);
+    if (nb_threads <= 1)
+        return 0;
+
+    s->slices = av_calloc(nb_threads, sizeof(*s->slices));
+    if (!s->slices)
+        return AVERROR(ENOMEM);
+    s->nb_slices = nb_threads;
+    for (int n = 0; n < nb_threads; n++) {
+        s->slices[n].histogram = av_calloc(SLICE_HIST_SIZE, sizeof(*s->slices[n].histogram));
+        if (!s->slices[n].histogram)
+            return AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
 static int init(AVFilterContext *ctx)
 {
     PaletteGenContext* s = ctx->priv;
@@ -598,12 +730,14 @@ static av_cold void uninit(AVFilterContext *ctx)
         av_freep(&s->histogram[i].entries);
     av_freep(&s->refs);
     av_frame_free(&s->prev_frame);
+    free_slices(s);
 }
 
 static const AVFilterPad palettegen_inputs[] = {
     {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input,
         .filter_frame = filter_frame,
     },
 };
@@ -627,4 +761,5 @@ const AVFilter ff_vf_palettegen = {
     FILTER_OUTPUTS(palettegen_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -23,10 +23,14 @@
  * Use a palette to downsample an input video stream.
  */
 
+#include <stdatomic.h>
+
+#include "config.h"
 #include "libavutil/bprint.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/qsort.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "framesync.h"
 #include "internal.h"
@@ -62,7 +66,7 @@ struct color_node {
 };
 
 #define NBITS 5
-#define CACHE_SIZE (1<<(4*NBITS))
+#define CACHE_SIZE (1<<(3*NBITS))
 
 struct cached_color {
     uint32_t color;
@@ -74,15 +78,34 @@ struct cache_node {
     int nb_entries;
 };
 
-struct PaletteUseContext;
+typedef struct PaletteUseSlice {
+    struct cache_node cache[CACHE_SIZE];    /* lookup cache, colors missing from the shared one with bayer */
+    unsigned *pending;                      /* bayer only: cache buckets filled in this frame */
+    int nb_pending;
+    int redo;                               /* bayer only: some pending colors got another palette entry */
+    atomic_int progress;                    /* pixels done in the processing window, error diffusion only */
+#if HAVE_THREADS
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+    int ret;
+} PaletteUseSlice;
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x_start, y_start, w, h;
+    int row;                                /* first row of the current round, -1 without rounds */
+    int redo;                               /* bayer only: redo the slices marked in the merge */
+} ThreadData;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
-                              int x_start, int y_start, int width, int height);
+typedef int (*set_frame_func)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFFrameSync fs;
-    struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    PaletteUseSlice *slices;                /* per job lookup cache and progress */
+    int nb_slices;
+    struct cache_node cache[CACHE_SIZE];    /* lookup cache shared by the jobs, bayer only */
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
     uint32_t palette[AVPALETTE_COUNT];
     int transparency_index; /* index in the palette of transparency. -1 if there is no transparency in the palette. */
@@ -332,23 +355,27 @@ end:
     search == COLOR_SEARCH_NNS_RECURSIVE ? colormap_nearest_recursive(s, root, target) :      \
                                            colormap_nearest_bruteforce(s, target)
 
+static av_always_inline unsigned color_hash(uint8_t r, uint8_t g, uint8_t b)
+{
+    const uint8_t rhash = r & ((1<<NBITS)-1);
+    const uint8_t ghash = g & ((1<<NBITS)-1);
+    const uint8_t bhash = b & ((1<<NBITS)-1);
+    return rhash<<(NBITS*2) | ghash<<NBITS | bhash;
+}
+
 /**
  * Check if the requested color is in the cache already. If not, find it in the
  * color tree and cache it.
  * Note: a, r, g, and b are the components of color, but are passed as well to avoid
  * recomputing them (they are generally computed by the caller for other uses).
  */
-static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
+static av_always_inline int color_get(PaletteUseContext *s, struct cache_node *cache, uint32_t color,
                                       uint8_t a, uint8_t r, uint8_t g, uint8_t b,
                                       const enum color_search_method search_method)
 {
     int i;
     const uint8_t argb_elts[] = {a, r, g, b};
-    const uint8_t rhash = r & ((1<<NBITS)-1);
-    const uint8_t ghash = g & ((1<<NBITS)-1);
-    const uint8_t bhash = b & ((1<<NBITS)-1);
-    const unsigned hash = rhash<<(NBITS*2) | ghash<<NBITS | bhash;
-    struct cache_node *node = &s->cache[hash];
+    struct cache_node *node = &cache[color_hash(r, g, b)];
     struct cached_color *e;
 
     // first, check for transparency
@@ -372,7 +399,45 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
     return e->pal_entry;
 }
 
-static av_always_inline int get_dst_color_err(PaletteUseContext *s,
+/**
+ * The bayer lookups are cached on the original color (in the bucket of the
+ * dithered one), so a color is mapped to the palette entry found for its first
+ * occurrence in scan order. The jobs only read the shared cache and keep the
+ * colors missing from it in their own one. Those are merged into the shared
+ * cache in slice order once the jobs are done, and the slices which found a
+ * different entry for a color than a previous slice are redone, so the output
+ * does not depend on the slicing.
+ */
+static av_always_inline int bayer_color_get(PaletteUseContext *s, PaletteUseSlice *slice,
+                                            uint32_t color, uint8_t a, uint8_t r, uint8_t g, uint8_t b,
+                                            const enum color_search_method search_method)
+{
+    const unsigned hash = color_hash(r, g, b);
+    const struct cache_node *node = &s->cache[hash];
+    const int listed = slice->cache[hash].nb_entries > 0;
+    unsigned *e;
+    int i, ret;
+
+    if (a < s->trans_thresh && s->transparency_index >= 0)
+        return s->transparency_index;
+
+    for (i = 0; i < node->nb_entries; i++)
+        if (node->entries[i].color == color)
+            return node->entries[i].pal_entry;
+
+    ret = color_get(s, slice->cache, color, a, r, g, b, search_method);
+    if (ret < 0 || listed)
+        return ret;
+
+    e = av_dynarray2_add((void**)&slice->pending, &slice->nb_pending,
+                         sizeof(*slice->pending), NULL);
+    if (!e)
+        return AVERROR(ENOMEM);
+    *e = hash;
+    return ret;
+}
+
+static av_always_inline int get_dst_color_err(PaletteUseContext *s, struct cache_node *cache,
                                               uint32_t c, int *ea, int *er, int *eg, int *eb,
                                               const enum color_search_method search_method)
 {
@@ -381,7 +446,7 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     const uint8_t g = c >>  8 & 0xff;
     const uint8_t b = c       & 0xff;
     uint32_t dstc;
-    const int dstx = color_get(s, c, a, r, g, b, search_method);
+    const int dstx = color_get(s, cache, c, a, r, g, b, search_method);
     if (dstx < 0)
         return dstx;
     dstc = s->palette[dstx];
@@ -396,24 +461,78 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     return dstx;
 }
 
+static int slice_wait(PaletteUseSlice *slice, int progress)
+{
+    int cur = atomic_load_explicit(&slice->progress, memory_order_acquire);
+
+    if (cur >= progress)
+        return cur;
+
+#if HAVE_THREADS
+    pthread_mutex_lock(&slice->mutex);
+    while ((cur = atomic_load_explicit(&slice->progress, memory_order_acquire)) < progress)
+        pthread_cond_wait(&slice->cond, &slice->mutex);
+    pthread_mutex_unlock(&slice->mutex);
+#endif
+    return cur;
+}
+
+static void slice_report(PaletteUseSlice *slice, int progress)
+{
+#if HAVE_THREADS
+    pthread_mutex_lock(&slice->mutex);
+    atomic_store_explicit(&slice->progress, progress, memory_order_release);
+    pthread_cond_broadcast(&slice->cond);
+    pthread_mutex_unlock(&slice->mutex);
+#else
+    atomic_store_explicit(&slice->progress, progress, memory_order_release);
+#endif
+}
+
+/**
+ * Without error diffusion, the jobs work on contiguous slices of rows.
+ *
+ * With error diffusion and several jobs, the frame is processed in rounds of
+ * one row per job, starting at row. Each pixel waits for the row above, done by the previous
+ * job or in the previous round, up to the last pixel spreading error to it or
+ * to its right neighbours. The pixels are then updated in the same order as a
+ * single threaded run and the output is identical.
+ */
 static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
-                                      int x_start, int y_start, int w, int h,
+                                      int x_start, int y_start, int w, int h, int row,
+                                      int jobnr, int nb_jobs,
                                       enum dithering_mode dither,
                                       const enum color_search_method search_method)
 {
     int x, y;
     const int src_linesize = in ->linesize[0] >> 2;
     const int dst_linesize = out->linesize[0];
-    uint32_t *src = ((uint32_t *)in ->data[0]) + y_start*src_linesize;
-    uint8_t  *dst =              out->data[0]  + y_start*dst_linesize;
+    const int error_diffusion = dither != DITHERING_NONE && dither != DITHERING_BAYER;
+    const int wavefront = error_diffusion && row >= 0;
+    const int lag = dither == DITHERING_SIERRA2 ? 5 : 3;
+    const int width = w;
+    PaletteUseSlice *slice = &s->slices[jobnr];
+    PaletteUseSlice *above = wavefront && jobnr > 0 ? &s->slices[jobnr - 1] : NULL;
+    struct cache_node *cache = dither == DITHERING_BAYER ? s->cache : slice->cache;
+    const int y_first = wavefront ? y_start + row + jobnr : y_start + (h *  jobnr   ) / nb_jobs;
+    const int y_end   = wavefront ? y_first + 1           : y_start + (h * (jobnr+1)) / nb_jobs;
 
     w += x_start;
     h += y_start;
 
-    for (y = y_start; y < h; y++) {
+    for (y = y_first; y < y_end; y++) {
+        uint32_t *src = (uint32_t *)in->data[0] + y*src_linesize;
+        uint8_t  *dst =             out->data[0] + y*dst_linesize;
+        const int above_done = (y - 1 - y_start) * width;
+        const int done = (y - y_start) * width;
+        int above_progress = 0;
+
         for (x = x_start; x < w; x++) {
             int ea, er, eg, eb;
 
+            if (above && above_progress < above_done + FFMIN(x - x_start + lag, width))
+                above_progress = slice_wait(above, above_done + FFMIN(x - x_start + lag, width));
+
             if (dither == DITHERING_BAYER) {
                 const int d = s->ordered_dither[(y & 7)<<3 | (x & 7)];
                 const uint8_t a8 = src[x] >> 24 & 0xff;
@@ -423,7 +542,8 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = av_clip_uint8(r8 + d);
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
-                const int color = color_get(s, src[x], a8, r, g, b, search_method);
+                const int color = nb_jobs > 1 ? bayer_color_get(s, slice, src[x], a8, r, g, b, search_method)
+                                              : color_get(s, cache, src[x], a8, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -431,7 +551,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_HECKBERT) {
                 const int right = x < w - 1, down = y < h - 1;
-                const int color = get_dst_color_err(s, src[x], &ea, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &ea, &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -443,7 +563,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_FLOYD_STEINBERG) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &ea, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &ea, &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -457,7 +577,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA2) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(s, src[x], &ea, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &ea, &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -476,7 +596,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_SIERRA2_4A) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(s, src[x], &ea, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &ea, &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -491,15 +611,18 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = src[x] >> 16 & 0xff;
                 const uint8_t g = src[x] >>  8 & 0xff;
                 const uint8_t b = src[x]       & 0xff;
-                const int color = color_get(s, src[x], a, r, g, b, search_method);
+                const int color = color_get(s, cache, src[x], a, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
                 dst[x] = color;
             }
+
+            if (wavefront && ((x - x_start) & 31) == 31)
+                slice_report(slice, done + x - x_start + 1);
         }
-        src += src_linesize;
-        dst += dst_linesize;
+        if (wavefront)
+            slice_report(slice, done + width);
     }
     return 0;
 }
@@ -923,12 +1046,67 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+static int slices_ret(const PaletteUseContext *s, int nb_jobs)
+{
+    for (int i = 0; i < nb_jobs; i++)
+        if (s->slices[i].ret < 0)
+            return s->slices[i].ret;
+    return 0;
+}
+
+/**
+ * Add the colors the bayer jobs did not find in the shared cache to it, in
+ * slice order, and mark the slices which need to be redone.
+ */
+static int merge_bayer_caches(PaletteUseContext *s, int nb_jobs, int *redo)
+{
+    int ret = 0;
+
+    *redo = 0;
+    for (int n = 0; n < nb_jobs; n++) {
+        PaletteUseSlice *slice = &s->slices[n];
+
+        slice->redo = 0;
+        for (int i = 0; i < slice->nb_pending; i++) {
+            struct cache_node *pending = &slice->cache[slice->pending[i]];
+            struct cache_node *node    = &s->cache[slice->pending[i]];
+
+            for (int j = 0; j < pending->nb_entries && ret >= 0; j++) {
+                const struct cached_color *p = &pending->entries[j];
+                struct cached_color *e = NULL;
+
+                for (int k = 0; k < node->nb_entries; k++) {
+                    if (node->entries[k].color == p->color) {
+                        e = &node->entries[k];
+                        break;
+                    }
+                }
+                if (e) {
+                    slice->redo |= e->pal_entry != p->pal_entry;
+                    continue;
+                }
+                e = av_dynarray2_add((void**)&node->entries, &node->nb_entries,
+                                     sizeof(*node->entries), NULL);
+                if (!e)
+                    ret = AVERROR(ENOMEM);
+                else
+                    *e = *p;
+            }
+            pending->nb_entries = 0;
+        }
+        slice->nb_pending = 0;
+        *redo |= slice->redo;
+    }
+    return ret;
+}
+
 static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
 {
-    int x, y, w, h, ret;
+    int x, y, w, h, ret, nb_jobs;
     AVFilterContext *ctx = inlink->dst;
     PaletteUseContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
+    ThreadData td;
 
     AVFrame *out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -952,7 +1130,43 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    ret = s->set_frame(s, out, in, x, y, w, h);
+    td.in      = in;
+    td.out     = out;
+    td.x_start = x;
+    td.y_start = y;
+    td.w       = w;
+    td.h       = h;
+
+    td.row     = -1;
+    td.redo    = 0;
+
+    nb_jobs = FFMIN(h, s->nb_slices);
+    for (int i = 0; i < nb_jobs; i++) {
+        atomic_init(&s->slices[i].progress, 0);
+        s->slices[i].ret = 0;
+    }
+    if (s->dither != DITHERING_NONE && s->dither != DITHERING_BAYER && nb_jobs > 1) {
+        /* A job only ever waits on the previous one, so this cannot deadlock
+         * however few of the jobs the executor runs at the same time. */
+        for (td.row = 0, ret = 0; td.row < h && ret >= 0; td.row += nb_jobs) {
+            ff_filter_execute(ctx, s->set_frame, &td, NULL, FFMIN(nb_jobs, h - td.row));
+            ret = slices_ret(s, nb_jobs);
+        }
+    } else {
+        ff_filter_execute(ctx, s->set_frame, &td, NULL, nb_jobs);
+        ret = slices_ret(s, nb_jobs);
+    }
+    if (s->dither == DITHERING_BAYER && nb_jobs > 1) {
+        int redo, ret2 = merge_bayer_caches(s, nb_jobs, &redo);
+
+        if (ret >= 0)
+            ret = ret2;
+        if (ret >= 0 && redo) {
+            td.redo = 1;
+            ff_filter_execute(ctx, s->set_frame, &td, NULL, nb_jobs);
+            ret = slices_ret(s, nb_jobs);
+        }
+    }
     if (ret < 0) {
         av_frame_free(&out);
         *outf = NULL;
@@ -965,12 +1179,56 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     return 0;
 }
 
+static void free_slices(PaletteUseContext *s)
+{
+    for (int n = 0; n < s->nb_slices; n++) {
+        PaletteUseSlice *slice = &s->slices[n];
+
+        for (int i = 0; i < CACHE_SIZE; i++)
+            av_freep(&slice->cache[i].entries);
+        av_freep(&slice->pending);
+#if HAVE_THREADS
+        pthread_mutex_destroy(&slice->mutex);
+        pthread_cond_destroy(&slice->cond);
+#endif
+    }
+    s->nb_slices = 0;
+    av_freep(&s->slices);
+}
+
+static int alloc_slices(PaletteUseContext *s, int nb_slices)
+{
+    s->slices = av_calloc(nb_slices, sizeof(*s->slices));
+    if (!s->slices)
+        return AVERROR(ENOMEM);
+
+    for (int n = 0; n < nb_slices; n++) {
+#if HAVE_THREADS
+        PaletteUseSlice *slice = &s->slices[n];
+
+        if (pthread_mutex_init(&slice->mutex, NULL))
+            return AVERROR(ENOMEM);
+        if (pthread_cond_init(&slice->cond, NULL)) {
+            pthread_mutex_destroy(&slice->mutex);
+            return AVERROR(ENOMEM);
+        }
+#endif
+        s->nb_slices++;
+    }
+    return 0;
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     int ret;
     AVFilterContext *ctx = outlink->src;
     PaletteUseContext *s = ctx->priv;
 
+    free_slices(s);
+    ret = alloc_slices(s, ff_filter_get_nb_threads(ctx));
+    if (ret < 0)
+        return ret;
+
     ret = ff_framesync_init_dualinput(&s->fs, ctx);
     if (ret < 0)
         return ret;
@@ -1013,6 +1271,13 @@ static void load_palette(PaletteUseContext *s, const AVFrame *palette_frame)
     if (s->new) {
         memset(s->palette, 0, sizeof(s->palette));
         memset(s->map, 0, sizeof(s->map));
+        for (int n = 0; n < s->nb_slices; n++) {
+            struct cache_node *cache = s->slices[n].cache;
+
+            for (i = 0; i < CACHE_SIZE; i++)
+                av_freep(&cache[i].entries);
+            memset(cache, 0, sizeof(s->slices[n].cache));
+        }
         for (i = 0; i < CACHE_SIZE; i++)
             av_freep(&s->cache[i].entries);
         memset(s->cache, 0, sizeof(s->cache));
@@ -1063,10 +1328,22 @@ static int load_apply_palette(FFFrameSync *fs)
 }
 
 #define DEFINE_SET_FRAME(color_search, name, value)                             \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
-                            int x_start, int y_start, int w, int h)             \
+static int set_frame_##name(AVFilterContext *ctx, void *arg,                    \
+                            int jobnr, int nb_jobs)                             \
 {                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value, color_search);  \
+    PaletteUseContext *s = ctx->priv;                                           \
+    PaletteUseSlice *slice = &s->slices[jobnr];                                 \
+    const ThreadData *td = arg;                                                 \
+                                                                                \
+    if (td->redo && !slice->redo)                                               \
+        return 0;                                                               \
+    slice->ret = set_frame(s, td->out, td->in, td->x_start, td->y_start,        \
+                           td->w, td->h, td->row, jobnr, nb_jobs,               \
+                           value, color_search);                                \
+    /* never leave the next job waiting on a failed one */                      \
+    if (slice->ret < 0)                                                         \
+        slice_report(slice, INT_MAX);                                           \
+    return slice->ret;                                                          \
 }
 
 #define DEFINE_SET_FRAME_COLOR_SEARCH(color_search, color_search_macro)                                 \
@@ -1134,11 +1411,11 @@ static int activate(AVFilterContext *ctx)
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     PaletteUseContext *s = ctx->priv;
 
     ff_framesync_uninit(&s->fs);
-    for (i = 0; i < CACHE_SIZE; i++)
+    free_slices(s);
+    for (int i = 0; i < CACHE_SIZE; i++)
         av_freep(&s->cache[i].entries);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
@@ -1174,4 +1451,5 @@ const AVFilter ff_vf_paletteuse = {
     FILTER_OUTPUTS(paletteuse_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -35,6 +35,9 @@ typedef struct SCDetContext {
 
     ptrdiff_t width[4];
     ptrdiff_t height[4];
+    ptrdiff_t ds_width[4];
+    ptrdiff_t ds_height[4];
+    int step;
     int nb_planes;
     int bitdepth;
     ff_scene_sad_fn sad;
@@ -43,6 +46,7 @@ typedef struct SCDetContext {
     AVFrame *prev_picref;
     double threshold;
     int sc_pass;
+    int downscale;
 } SCDetContext;
 
 #define OFFSET(x) offsetof(SCDetContext, x)
@@ -54,6 +58,7 @@ static const AVOption scdet_options[] = {
     { "t",           "set scene change detect threshold",        OFFSET(threshold),  AV_OPT_TYPE_DOUBLE,   {.dbl = 10.},     0,  100., V|F },
     { "sc_pass",     "Set the flag to pass scene change frames", OFFSET(sc_pass),    AV_OPT_TYPE_BOOL,     {.dbl =  0  },    0,    1,  V|F },
     { "s",           "Set the flag to pass scene change frames", OFFSET(sc_pass),    AV_OPT_TYPE_BOOL,     {.dbl =  0  },    0,    1,  V|F },
+    { "downscale",   "set the log2 of the analysis downscaling factor", OFFSET(downscale), AV_OPT_TYPE_INT, {.i64 = 0 },       0,    4,  V|F },
     {NULL}
 };
 
@@ -90,6 +95,14 @@ static int config_input(AVFilterLink *inlink)
         s->height[plane] = inlink->h >> ((plane == 1 || plane == 2) ? desc->log2_chroma_h : 0);
     }
 
+    s->step = desc->comp[0].step / ((s->bitdepth + 7) / 8);
+    while ((inlink->w >> s->downscale) < 1 || (inlink->h >> s->downscale) < 1)
+        s->downscale--;
+    memcpy(s->ds_width,  s->width,  sizeof(s->width));
+    memcpy(s->ds_height, s->height, sizeof(s->height));
+    ff_scene_downscale_dims(s->ds_width, s->ds_height, s->step,
+                            s->nb_planes, s->downscale);
+
     s->sad = ff_scene_sad_get_fn(s->bitdepth == 8 ? 8 : 16);
     if (!s->sad)
         return AVERROR(EINVAL);
@@ -109,30 +122,33 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     double ret = 0;
     SCDetContext *s = ctx->priv;
     AVFrame *prev_picref = s->prev_picref;
+    AVFrame *cur = frame;
+
+    if (s->downscale) {
+        cur = ff_scene_downscale(ctx, frame, s->ds_width, s->ds_height, s->step,
+                                 s->nb_planes, s->bitdepth, s->downscale);
+        if (!cur)
+            return 0;
+    }
 
-    if (prev_picref && frame->height == prev_picref->height
-                    && frame->width  == prev_picref->width) {
-        uint64_t sad = 0;
+    if (prev_picref && cur->height == prev_picref->height
+                    && cur->width  == prev_picref->width) {
+        uint64_t sad;
         double mafd, diff;
         uint64_t count = 0;
 
-        for (int plane = 0; plane < s->nb_planes; plane++) {
-            uint64_t plane_sad;
-            s->sad(prev_picref->data[plane], prev_picref->linesize[plane],
-                    frame->data[plane], frame->linesize[plane],
-                    s->width[plane], s->height[plane], &plane_sad);
-            sad += plane_sad;
-            count += s->width[plane] * s->height[plane];
-        }
+        sad = ff_scene_sad_frame(ctx, s->sad, prev_picref, cur,
+                                 s->ds_width, s->ds_height, s->nb_planes);
+        for (int plane = 0; plane < s->nb_planes; plane++)
+            count += s->ds_width[plane] * s->ds_height[plane];
 
-        emms_c();
         mafd = (double)sad * 100. / count / (1ULL << s->bitdepth);
         diff = fabs(mafd - s->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff), 0, 100.);
         s->prev_mafd = mafd;
-        av_frame_free(&prev_picref);
     }
-    s->prev_picref = av_frame_clone(frame);
+    av_frame_free(&s->prev_picref);
+    s->prev_picref = cur == frame ? av_frame_clone(frame) : cur;
     return ret;
 }
 
@@ -206,7 +222,7 @@ const AVFilter ff_vf_scdet = {
     .priv_size     = sizeof(SCDetContext),
     .priv_class    = &scdet_class,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(scdet_inputs),
     FILTER_OUTPUTS(scdet_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
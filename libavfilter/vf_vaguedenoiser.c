@@ -48,11 +48,12 @@ typedef struct VagueDenoiserContext {
     int nb_planes;
     int planeheight[4];
     int planewidth[4];
+    int nb_threads;
 
     float *block;
-    float *in;
-    float *out;
-    float *tmp;
+    float **in;                 ///< per thread transform input
+    float **out;                ///< per thread transform output
+    float **tmp;                ///< per thread synthesis temporary
 
     int hlowsize[4][32];
     int hhighsize[4][32];
@@ -146,14 +147,24 @@ static int config_input(AVFilterLink *inlink)
     s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, desc->log2_chroma_w);
     s->planewidth[0]  = s->planewidth[3]  = inlink->w;
 
+    s->nb_threads = ff_filter_get_nb_threads(inlink->dst);
     s->block = av_malloc_array(inlink->w * inlink->h, sizeof(*s->block));
-    s->in    = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->in));
-    s->out   = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->out));
-    s->tmp   = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->tmp));
+    s->in    = av_calloc(s->nb_threads, sizeof(*s->in));
+    s->out   = av_calloc(s->nb_threads, sizeof(*s->out));
+    s->tmp   = av_calloc(s->nb_threads, sizeof(*s->tmp));
 
     if (!s->block || !s->in || !s->out || !s->tmp)
         return AVERROR(ENOMEM);
 
+    for (i = 0; i < s->nb_threads; i++) {
+        s->in[i]  = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->in[i]));
+        s->out[i] = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->out[i]));
+        s->tmp[i] = av_malloc_array(32 + FFMAX(inlink->w, inlink->h), sizeof(*s->tmp[i]));
+
+        if (!s->in[i] || !s->out[i] || !s->tmp[i])
+            return AVERROR(ENOMEM);
+    }
+
     s->threshold *= 1 << (s->depth - 8);
     s->peak = (1 << s->depth) - 1;
 
@@ -403,23 +414,213 @@ static float bayes_threshold(float *block, const int width, const int height,
     return threshold * threshold / (FFMAX(sqrtf(mean - threshold), FLT_EPSILON));
 }
 
-static void filter(VagueDenoiserContext *s, AVFrame *in, AVFrame *out)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int plane;
+    int width, height;          ///< dimensions of the current transform step
+    /* subbands to threshold */
+    int nb_bands;
+    float *band[4 * 32];
+    int band_width[4 * 32];
+    int band_height[4 * 32];
+    float band_threshold[4 * 32];
+} ThreadData;
+
+static int read_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int p = td->plane;
+    const int height = s->planeheight[p];
+    const int width = s->planewidth[p];
+    const int slice_start = (height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (height * (jobnr+1)) / nb_jobs;
+    const int linesize = td->in->linesize[p];
+    float *output = s->block + slice_start * width;
+
+    if (s->depth <= 8) {
+        const uint8_t *srcp8 = td->in->data[p] + slice_start * linesize;
+
+        for (int y = slice_start; y < slice_end; y++) {
+            for (int x = 0; x < width; x++)
+                output[x] = srcp8[x];
+            srcp8 += linesize;
+            output += width;
+        }
+    } else {
+        const uint16_t *srcp16 = (const uint16_t *)(td->in->data[p] + slice_start * linesize);
+
+        for (int y = slice_start; y < slice_end; y++) {
+            for (int x = 0; x < width; x++)
+                output[x] = srcp16[x];
+            srcp16 += linesize / 2;
+            output += width;
+        }
+    }
+
+    return 0;
+}
+
+static int write_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int p = td->plane;
+    const int height = s->planeheight[p];
+    const int width = s->planewidth[p];
+    const int slice_start = (height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (height * (jobnr+1)) / nb_jobs;
+    const int linesize = td->out->linesize[p];
+    const float *input = s->block + slice_start * width;
+
+    if (s->depth <= 8) {
+        uint8_t *dstp8 = td->out->data[p] + slice_start * linesize;
+
+        for (int y = slice_start; y < slice_end; y++) {
+            for (int x = 0; x < width; x++)
+                dstp8[x] = av_clip_uint8(input[x] + 0.5f);
+            input += width;
+            dstp8 += linesize;
+        }
+    } else {
+        uint16_t *dstp16 = (uint16_t *)(td->out->data[p] + slice_start * linesize);
+
+        for (int y = slice_start; y < slice_end; y++) {
+            for (int x = 0; x < width; x++)
+                dstp16[x] = av_clip(input[x] + 0.5f, 0, s->peak);
+            input += width;
+            dstp16 += linesize / 2;
+        }
+    }
+
+    return 0;
+}
+
+static int transform_rows(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int width = s->planewidth[td->plane];
+    const int low_size = (td->width + 1) >> 1;
+    const int slice_start = (td->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr+1)) / nb_jobs;
+    float *input = s->block + slice_start * width;
+
+    for (int j = slice_start; j < slice_end; j++) {
+        copy(input, s->in[jobnr] + NPAD, td->width);
+        transform_step(s->in[jobnr], s->out[jobnr], td->width, low_size, s);
+        copy(s->out[jobnr] + NPAD, input, td->width);
+        input += width;
+    }
+
+    return 0;
+}
+
+static int transform_columns(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int width = s->planewidth[td->plane];
+    const int low_size = (td->height + 1) >> 1;
+    const int slice_start = (td->width *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->width * (jobnr+1)) / nb_jobs;
+    float *input = s->block + slice_start;
+
+    for (int j = slice_start; j < slice_end; j++) {
+        copyv(input, width, s->in[jobnr] + NPAD, td->height);
+        transform_step(s->in[jobnr], s->out[jobnr], td->height, low_size, s);
+        copyh(s->out[jobnr] + NPAD, input, width, td->height);
+        input++;
+    }
+
+    return 0;
+}
+
+static int invert_columns(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int width = s->planewidth[td->plane];
+    const int slice_start = (td->width *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->width * (jobnr+1)) / nb_jobs;
+    float *idx3 = s->block + slice_start;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        copyv(idx3, width, s->in[jobnr] + NPAD, td->height);
+        invert_step(s->in[jobnr], s->out[jobnr], s->tmp[jobnr], td->height, s);
+        copyh(s->out[jobnr] + NPAD, idx3, width, td->height);
+        idx3++;
+    }
+
+    return 0;
+}
+
+static int invert_rows(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int width = s->planewidth[td->plane];
+    const int slice_start = (td->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr+1)) / nb_jobs;
+    float *idx3 = s->block + slice_start * width;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        copy(idx3, s->in[jobnr] + NPAD, td->width);
+        invert_step(s->in[jobnr], s->out[jobnr], s->tmp[jobnr], td->width, s);
+        copy(s->out[jobnr] + NPAD, idx3, td->width);
+        idx3 += width;
+    }
+
+    return 0;
+}
+
+static int threshold_bands(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int width = s->planewidth[td->plane];
+
+    for (int n = 0; n < td->nb_bands; n++) {
+        const int slice_start = (td->band_height[n] *  jobnr   ) / nb_jobs;
+        const int slice_end   = (td->band_height[n] * (jobnr+1)) / nb_jobs;
+
+        s->thresholding(td->band[n] + slice_start * width, td->band_width[n],
+                        slice_end - slice_start, width,
+                        td->band_threshold[n], s->percent);
+    }
+
+    return 0;
+}
+
+static void add_band(VagueDenoiserContext *s, ThreadData *td, float *block,
+                     int width, int height)
 {
-    int p, y, x, i, j;
+    const int n = td->nb_bands++;
+
+    td->band[n]           = block;
+    td->band_width[n]     = width;
+    td->band_height[n]    = height;
+    /* computed serially, as the sum order affects the result */
+    td->band_threshold[n] = bayes_threshold(block, width, height,
+                                            s->planewidth[td->plane], s->threshold);
+}
+
+static void filter(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    VagueDenoiserContext *s = ctx->priv;
+    ThreadData td;
+
+    td.in  = in;
+    td.out = out;
 
-    for (p = 0; p < s->nb_planes; p++) {
+    for (int p = 0; p < s->nb_planes; p++) {
         const int height = s->planeheight[p];
         const int width = s->planewidth[p];
-        const uint8_t *srcp8 = in->data[p];
-        const uint16_t *srcp16 = (const uint16_t *)in->data[p];
-        uint8_t *dstp8 = out->data[p];
-        uint16_t *dstp16 = (uint16_t *)out->data[p];
-        float *output = s->block;
+        const int nb_jobs = FFMIN(s->nb_threads, FFMIN(width, height));
         int h_low_size0 = width;
         int v_low_size0 = height;
         int nsteps_transform = s->nsteps;
         int nsteps_invert = s->nsteps;
-        const float *input = s->block;
 
         if (!((1 << p) & s->planes)) {
             av_image_copy_plane(out->data[p], out->linesize[p], in->data[p], in->linesize[p],
@@ -427,110 +628,58 @@ static void filter(VagueDenoiserContext *s, AVFrame *in, AVFrame *out)
             continue;
         }
 
-        if (s->depth <= 8) {
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++)
-                    output[x] = srcp8[x];
-                srcp8 += in->linesize[p];
-                output += width;
-            }
-        } else {
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++)
-                    output[x] = srcp16[x];
-                srcp16 += in->linesize[p] / 2;
-                output += width;
-            }
-        }
+        td.plane = p;
+        ff_filter_execute(ctx, read_slice, &td, NULL, nb_jobs);
 
         while (nsteps_transform--) {
-            int low_size = (h_low_size0 + 1) >> 1;
-            float *input = s->block;
-            for (j = 0; j < v_low_size0; j++) {
-                copy(input, s->in + NPAD, h_low_size0);
-                transform_step(s->in, s->out, h_low_size0, low_size, s);
-                copy(s->out + NPAD, input, h_low_size0);
-                input += width;
-            }
-
-            low_size = (v_low_size0 + 1) >> 1;
-            input = s->block;
-            for (j = 0; j < h_low_size0; j++) {
-                copyv(input, width, s->in + NPAD, v_low_size0);
-                transform_step(s->in, s->out, v_low_size0, low_size, s);
-                copyh(s->out + NPAD, input, width, v_low_size0);
-                input++;
-            }
+            td.width  = h_low_size0;
+            td.height = v_low_size0;
+            ff_filter_execute(ctx, transform_rows, &td, NULL,
+                              FFMIN(nb_jobs, v_low_size0));
+            ff_filter_execute(ctx, transform_columns, &td, NULL,
+                              FFMIN(nb_jobs, h_low_size0));
 
             h_low_size0 = (h_low_size0 + 1) >> 1;
             v_low_size0 = (v_low_size0 + 1) >> 1;
         }
 
+        td.nb_bands = 0;
         if (s->type == 0) {
-            s->thresholding(s->block, width, height, width, s->threshold, s->percent);
+            td.band[0]           = s->block;
+            td.band_width[0]     = width;
+            td.band_height[0]    = height;
+            td.band_threshold[0] = s->threshold;
+            td.nb_bands          = 1;
         } else {
             for (int n = 0; n < s->nsteps; n++) {
-                float threshold;
-                float *block;
-
-                if (n == s->nsteps - 1) {
-                    threshold = bayes_threshold(s->block, s->hlowsize[p][n], s->vlowsize[p][n], width, s->threshold);
-                    s->thresholding(s->block, s->hlowsize[p][n], s->vlowsize[p][n], width, threshold, s->percent);
-                }
-                block = s->block + s->hlowsize[p][n];
-                threshold = bayes_threshold(block, s->hhighsize[p][n], s->vlowsize[p][n], width, s->threshold);
-                s->thresholding(block, s->hhighsize[p][n], s->vlowsize[p][n], width, threshold, s->percent);
-                block = s->block + s->vlowsize[p][n] * width;
-                threshold = bayes_threshold(block, s->hlowsize[p][n], s->vhighsize[p][n], width, s->threshold);
-                s->thresholding(block, s->hlowsize[p][n], s->vhighsize[p][n], width, threshold, s->percent);
-                block = s->block + s->hlowsize[p][n] + s->vlowsize[p][n] * width;
-                threshold = bayes_threshold(block, s->hhighsize[p][n], s->vhighsize[p][n], width, s->threshold);
-                s->thresholding(block, s->hhighsize[p][n], s->vhighsize[p][n], width, threshold, s->percent);
+                if (n == s->nsteps - 1)
+                    add_band(s, &td, s->block, s->hlowsize[p][n], s->vlowsize[p][n]);
+                add_band(s, &td, s->block + s->hlowsize[p][n],
+                         s->hhighsize[p][n], s->vlowsize[p][n]);
+                add_band(s, &td, s->block + s->vlowsize[p][n] * width,
+                         s->hlowsize[p][n], s->vhighsize[p][n]);
+                add_band(s, &td, s->block + s->hlowsize[p][n] + s->vlowsize[p][n] * width,
+                         s->hhighsize[p][n], s->vhighsize[p][n]);
             }
         }
+        ff_filter_execute(ctx, threshold_bands, &td, NULL, nb_jobs);
 
         while (nsteps_invert--) {
-            const int idx = s->vlowsize[p][nsteps_invert]  + s->vhighsize[p][nsteps_invert];
-            const int idx2 = s->hlowsize[p][nsteps_invert] + s->hhighsize[p][nsteps_invert];
-            float * idx3 = s->block;
-            for (i = 0; i < idx2; i++) {
-                copyv(idx3, width, s->in + NPAD, idx);
-                invert_step(s->in, s->out, s->tmp, idx, s);
-                copyh(s->out + NPAD, idx3, width, idx);
-                idx3++;
-            }
-
-            idx3 = s->block;
-            for (i = 0; i < idx; i++) {
-                copy(idx3, s->in + NPAD, idx2);
-                invert_step(s->in, s->out, s->tmp, idx2, s);
-                copy(s->out + NPAD, idx3, idx2);
-                idx3 += width;
-            }
+            td.height = s->vlowsize[p][nsteps_invert] + s->vhighsize[p][nsteps_invert];
+            td.width  = s->hlowsize[p][nsteps_invert] + s->hhighsize[p][nsteps_invert];
+            ff_filter_execute(ctx, invert_columns, &td, NULL,
+                              FFMIN(nb_jobs, td.width));
+            ff_filter_execute(ctx, invert_rows, &td, NULL,
+                              FFMIN(nb_jobs, td.height));
         }
 
-        if (s->depth <= 8) {
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++)
-                    dstp8[x] = av_clip_uint8(input[x] + 0.5f);
-                input += width;
-                dstp8 += out->linesize[p];
-            }
-        } else {
-            for (y = 0; y < height; y++) {
-                for (x = 0; x < width; x++)
-                    dstp16[x] = av_clip(input[x] + 0.5f, 0, s->peak);
-                input += width;
-                dstp16 += out->linesize[p] / 2;
-            }
-        }
+        ff_filter_execute(ctx, write_slice, &td, NULL, nb_jobs);
     }
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx  = inlink->dst;
-    VagueDenoiserContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out;
     int direct = av_frame_is_writable(in);
@@ -547,7 +696,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
-    filter(s, in, out);
+    filter(ctx, in, out);
 
     if (!direct)
         av_frame_free(&in);
@@ -579,6 +728,14 @@ static av_cold void uninit(AVFilterContext *ctx)
     VagueDenoiserContext *s = ctx->priv;
 
     av_freep(&s->block);
+    for (int i = 0; i < s->nb_threads; i++) {
+        if (s->in)
+            av_freep(&s->in[i]);
+        if (s->out)
+            av_freep(&s->out[i]);
+        if (s->tmp)
+            av_freep(&s->tmp[i]);
+    }
     av_freep(&s->in);
     av_freep(&s->out);
     av_freep(&s->tmp);
@@ -611,5 +768,5 @@ const AVFilter ff_vf_vaguedenoiser = {
     FILTER_INPUTS(vaguedenoiser_inputs),
     FILTER_OUTPUTS(vaguedenoiser_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
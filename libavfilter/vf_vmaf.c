@@ -0,0 +1,1142 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Calculate the VMAF between two input videos, with native implementations
+ * of the VIF, ADM and motion features and of the SVM regression.
+ */
+
+#include <float.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/file.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "avfilter.h"
+#include "framesync.h"
+#include "internal.h"
+#include "video.h"
+#include "vif.h"
+#include "vmaf_adm.h"
+#include "vmaf_motion.h"
+
+enum VMAFFeature {
+    FEATURE_ADM2,
+    FEATURE_MOTION2,
+    FEATURE_VIF_SCALE0,
+    FEATURE_VIF_SCALE1,
+    FEATURE_VIF_SCALE2,
+    FEATURE_VIF_SCALE3,
+    NB_FEATURES
+};
+
+static const char *const feature_names[NB_FEATURES] = {
+    "adm2", "motion2", "vif_scale0", "vif_scale1", "vif_scale2", "vif_scale3",
+};
+
+typedef struct VMAFModel {
+    int nb_features;
+    int feature[NB_FEATURES];           ///< model input index -> VMAFFeature
+    int linear_rescale;
+    double slopes[NB_FEATURES + 1];     ///< [0] is for the score
+    double intercepts[NB_FEATURES + 1];
+    double gamma;
+    double rho;
+    int nb_sv;
+    double *sv_coef;
+    double *sv;                         ///< nb_sv * nb_features
+    int transform;
+    double p[3];
+    int out_gte_in, out_lte_in;
+    int clip;
+    double clip_min, clip_max;
+} VMAFModel;
+
+typedef struct VMAFContext {
+    const AVClass *class;
+    FFFrameSync fs;
+    const AVPixFmtDescriptor *desc;
+    int width;
+    int height;
+    int nb_threads;
+    char *model_path;
+    char *log_path;
+    int enable_transform;
+
+    float *ref_data;
+    float *main_data;
+    float *vif_buf[NUM_DATA_BUFS];
+    float **vif_temp;
+
+    VMAFADMDSPContext adm_dsp;
+    ptrdiff_t band_stride;
+    float *band_a[2][2];                ///< low band of reference and main, for even and odd scales
+    float *band[2][3];                  ///< h, v and d bands of reference and main
+    float *decouple_r[3];
+    float *csf_a[3];
+    float *csf_f[3];
+    float *row_sum[6];                  ///< per row masked distortion and reference energy
+    float **dwt_temp;
+
+    VMAFMotionData motion;
+
+    VMAFModel model;
+    int has_model;
+    double (*features)[NB_FEATURES];
+    unsigned features_size;
+    int nb_frames;
+} VMAFContext;
+
+#define OFFSET(x) offsetof(VMAFContext, x)
+#define FLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_VIDEO_PARAM
+
+static const AVOption vmaf_options[] = {
+    { "model_path", "set the JSON model file to compute the VMAF score with", OFFSET(model_path), AV_OPT_TYPE_STRING, {.str=NULL}, 0, 1, FLAGS },
+    { "log_path",   "set the file to write the per frame scores to",         OFFSET(log_path),   AV_OPT_TYPE_STRING, {.str=NULL}, 0, 1, FLAGS },
+    { "enable_transform", "apply the score transform of the model", OFFSET(enable_transform), AV_OPT_TYPE_BOOL, {.i64=0}, 0, 1, FLAGS },
+    { NULL }
+};
+
+FRAMESYNC_DEFINE_CLASS(vmaf, VMAFContext, fs);
+
+/* ADM: detail loss measure on a 4 level db2 wavelet decomposition */
+
+#define ADM_BORDER_FACTOR     0.1
+#define ADM_ENHN_GAIN_LIMIT   100.f
+#define ADM_NORM_VIEW_DIST    3.0
+#define ADM_REF_DISPLAY_HEIGHT 1080
+
+static const float dwt2_db2_lo[4] = {
+     0.482962913144690,  0.836516303737469,  0.224143868041857, -0.129409522550921
+};
+static const float dwt2_db2_hi[4] = {
+    -0.129409522550921, -0.224143868041857,  0.836516303737469, -0.482962913144690
+};
+
+/* Watson et al., "Visibility of wavelet quantization noise", 1997 */
+static const float dwt_7_9_basis_function_amplitudes[6][4] = {
+    { 0.62171,  0.67234,  0.72709,  0.67234  },
+    { 0.34537,  0.41317,  0.49428,  0.41317  },
+    { 0.18004,  0.22727,  0.28688,  0.22727  },
+    { 0.091401, 0.11792,  0.15214,  0.11792  },
+    { 0.045943, 0.059758, 0.077698, 0.059758 },
+    { 0.023013, 0.030018, 0.039212, 0.030018 },
+};
+
+static float dwt_quant_step(int lambda, int theta)
+{
+    static const float a = 0.495, k = 0.466, f0 = 0.401;
+    static const float g[4] = { 1.501, 1.0, 0.534, 1.0 };
+    /* display visual resolution, in pixels per degree of visual angle */
+    const float r = ADM_NORM_VIEW_DIST * ADM_REF_DISPLAY_HEIGHT * M_PI / 180.0;
+    const float temp = log10(pow(2.0, lambda + 1) * f0 * g[theta] / r);
+
+    return 2.0 * a * pow(10.0, k * temp * temp) / dwt_7_9_basis_function_amplitudes[lambda][theta];
+}
+
+static av_always_inline int mirror(int i, int n)
+{
+    return i < 0 ? -i : (i >= n ? 2 * n - i - 1 : i);
+}
+
+static void dwt2_v_c(const float *src0, const float *src1,
+                     const float *src2, const float *src3,
+                     float *lo, float *hi, int w)
+{
+    for (int j = 0; j < w; j++) {
+        const float s0 = src0[j], s1 = src1[j], s2 = src2[j], s3 = src3[j];
+
+        lo[j] = dwt2_db2_lo[0] * s0 + dwt2_db2_lo[1] * s1 + dwt2_db2_lo[2] * s2 + dwt2_db2_lo[3] * s3;
+        hi[j] = dwt2_db2_hi[0] * s0 + dwt2_db2_hi[1] * s1 + dwt2_db2_hi[2] * s2 + dwt2_db2_hi[3] * s3;
+    }
+}
+
+av_cold void ff_vmaf_adm_init(VMAFADMDSPContext *dsp)
+{
+    dsp->dwt2_v = dwt2_v_c;
+}
+
+typedef struct ADMThreadData {
+    const float *src[2];                ///< reference and main low band of the previous scale
+    ptrdiff_t src_stride;
+    float *dst_a[2];
+    int src_w, src_h;
+    int w, h;                           ///< dimensions of the bands
+    int scale;
+} ADMThreadData;
+
+static void adm_dwt2_row(const VMAFADMDSPContext *dsp, const float *src,
+                         ptrdiff_t src_stride, int w, int h, int i,
+                         float *tmplo, float *tmphi,
+                         float *a, float *bh, float *bv, float *bd)
+{
+    const int w2 = (w + 1) / 2;
+
+    dsp->dwt2_v(src + mirror(2 * i - 1, h) * src_stride,
+                src + mirror(2 * i,     h) * src_stride,
+                src + mirror(2 * i + 1, h) * src_stride,
+                src + mirror(2 * i + 2, h) * src_stride,
+                tmplo, tmphi, w);
+
+    for (int j = 0; j < w2; j++) {
+        const int j0 = mirror(2 * j - 1, w), j1 = mirror(2 * j,     w);
+        const int j2 = mirror(2 * j + 1, w), j3 = mirror(2 * j + 2, w);
+
+        a[j]  = dwt2_db2_lo[0] * tmplo[j0] + dwt2_db2_lo[1] * tmplo[j1] + dwt2_db2_lo[2] * tmplo[j2] + dwt2_db2_lo[3] * tmplo[j3];
+        bv[j] = dwt2_db2_hi[0] * tmplo[j0] + dwt2_db2_hi[1] * tmplo[j1] + dwt2_db2_hi[2] * tmplo[j2] + dwt2_db2_hi[3] * tmplo[j3];
+        bh[j] = dwt2_db2_lo[0] * tmphi[j0] + dwt2_db2_lo[1] * tmphi[j1] + dwt2_db2_lo[2] * tmphi[j2] + dwt2_db2_lo[3] * tmphi[j3];
+        bd[j] = dwt2_db2_hi[0] * tmphi[j0] + dwt2_db2_hi[1] * tmphi[j1] + dwt2_db2_hi[2] * tmphi[j2] + dwt2_db2_hi[3] * tmphi[j3];
+    }
+}
+
+static int adm_dwt2(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VMAFContext *s = ctx->priv;
+    const ADMThreadData *td = arg;
+    const ptrdiff_t stride = s->band_stride;
+    float *tmplo = s->dwt_temp[jobnr];
+    float *tmphi = tmplo + FFALIGN(s->width, 8) + 8;
+    const int slice_start = (td->h *  jobnr   ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr+1)) / nb_jobs;
+
+    for (int n = 0; n < 2; n++) {
+        for (int i = slice_start; i < slice_end; i++)
+            adm_dwt2_row(&s->adm_dsp, td->src[n], td->src_stride,
+                         td->src_w, td->src_h, i, tmplo, tmphi,
+                         td->dst_a[n]  + i * stride,
+                         s->band[n][0] + i * stride,
+                         s->band[n][1] + i * stride,
+                         s->band[n][2] + i * stride);
+    }
+
+    return 0;
+}
+
+/**
+ * Rectangle of the bands the scores are computed on, leaving out a border
+ * of ADM_BORDER_FACTOR of the size on each side.
+ */
+static void adm_region(int w, int h, int *left, int *top, int *right, int *bottom)
+{
+    *left   = w * ADM_BORDER_FACTOR - 0.5;
+    *top    = h * ADM_BORDER_FACTOR - 0.5;
+    *right  = w - *left;
+    *bottom = h - *top;
+}
+
+/**
+ * Split the main bands into the part restored from the reference and the
+ * additive impairments, and weight the latter with the contrast sensitivity
+ * function. This covers the region plus the taps of the masking filter.
+ */
+static int adm_decouple_csf(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VMAFContext *s = ctx->priv;
+    const ADMThreadData *td = arg;
+    const ptrdiff_t stride = s->band_stride;
+    const float factor1 = dwt_quant_step(td->scale, 1);
+    const float factor2 = dwt_quant_step(td->scale, 2);
+    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+    const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
+    const float eps = 1e-30f;
+    int left   = td->w * ADM_BORDER_FACTOR - 0.5 - 1;
+    int top    = td->h * ADM_BORDER_FACTOR - 0.5 - 1;
+    int right  = td->w - left + 2;
+    int bottom = td->h - top + 2;
+    int slice_start, slice_end;
+
+    left   = FFMAX(left, 0);
+    top    = FFMAX(top, 0);
+    right  = FFMIN(right, td->w);
+    bottom = FFMIN(bottom, td->h);
+    slice_start = top + ((bottom - top) *  jobnr   ) / nb_jobs;
+    slice_end   = top + ((bottom - top) * (jobnr+1)) / nb_jobs;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        for (int j = left; j < right; j++) {
+            const ptrdiff_t x = i * stride + j;
+            const float oh = s->band[0][0][x], ov = s->band[0][1][x], od = s->band[0][2][x];
+            const float th = s->band[1][0][x], tv = s->band[1][1][x], td_ = s->band[1][2][x];
+            const float kh = av_clipf(th  / (oh + eps), 0.f, 1.f);
+            const float kv = av_clipf(tv  / (ov + eps), 0.f, 1.f);
+            const float kd = av_clipf(td_ / (od + eps), 0.f, 1.f);
+            const float ot_dp    = oh * th + ov * tv;
+            const float o_mag_sq = oh * oh + ov * ov;
+            const float t_mag_sq = th * th + tv * tv;
+            /* the angle between reference and main is below 1 degree */
+            const int angle_flag = ot_dp >= 0.0f && ot_dp * ot_dp >= cos_1deg_sq * o_mag_sq * t_mag_sq;
+            float rst[3] = { kh * oh, kv * ov, kd * od };
+            const float t[3] = { th, tv, td_ };
+
+            for (int theta = 0; theta < 3; theta++) {
+                float csf_a;
+
+                if (angle_flag) {
+                    if (rst[theta] > 0.f)
+                        rst[theta] = FFMIN(rst[theta] * ADM_ENHN_GAIN_LIMIT, t[theta]);
+                    else if (rst[theta] < 0.f)
+                        rst[theta] = FFMAX(rst[theta] * ADM_ENHN_GAIN_LIMIT, t[theta]);
+                }
+                csf_a = rfactor[theta] * (t[theta] - rst[theta]);
+                s->decouple_r[theta][x] = rst[theta];
+                s->csf_a[theta][x] = csf_a;
+                s->csf_f[theta][x] = (1.0f / 30) * fabsf(csf_a);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Contrast masking of the restored details by the impairments around them,
+ * accumulated per row along with the energy of the reference details.
+ */
+static int adm_cm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VMAFContext *s = ctx->priv;
+    const ADMThreadData *td = arg;
+    const ptrdiff_t stride = s->band_stride;
+    const float factor1 = dwt_quant_step(td->scale, 1);
+    const float factor2 = dwt_quant_step(td->scale, 2);
+    const float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
+    const int w = td->w, h = td->h;
+    int left, top, right, bottom, slice_start, slice_end;
+
+    adm_region(w, h, &left, &top, &right, &bottom);
+    slice_start = top + ((bottom - top) *  jobnr   ) / nb_jobs;
+    slice_end   = top + ((bottom - top) * (jobnr+1)) / nb_jobs;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        const ptrdiff_t r0 = mirror(i - 1, h) * stride, r1 = i * stride, r2 = mirror(i + 1, h) * stride;
+        float num[3] = { 0 }, den[3] = { 0 };
+
+        for (int j = left; j < right; j++) {
+            const int j0 = mirror(j - 1, w), j2 = mirror(j + 1, w);
+            float thr = 0.f;
+
+            for (int theta = 0; theta < 3; theta++) {
+                const float *f = s->csf_f[theta];
+
+                thr += f[r0 + j0] + f[r0 + j] + f[r0 + j2] +
+                       f[r1 + j0] + (1.0f / 15) * fabsf(s->csf_a[theta][r1 + j]) + f[r1 + j2] +
+                       f[r2 + j0] + f[r2 + j] + f[r2 + j2];
+            }
+
+            for (int theta = 0; theta < 3; theta++) {
+                const float o = fabsf(s->band[0][theta][r1 + j] * rfactor[theta]);
+                float x = fabsf(s->decouple_r[theta][r1 + j] * rfactor[theta]) - thr;
+
+                x = FFMAX(x, 0.f);
+                num[theta] += x * x * x;
+                den[theta] += o * o * o;
+            }
+        }
+
+        for (int theta = 0; theta < 3; theta++) {
+            s->row_sum[theta    ][i] = num[theta];
+            s->row_sum[theta + 3][i] = den[theta];
+        }
+    }
+
+    return 0;
+}
+
+static float compute_adm(AVFilterContext *ctx)
+{
+    VMAFContext *s = ctx->priv;
+    const double numden_limit = 1e-10 * (s->width * s->height) / (1920.0 * 1080.0);
+    ADMThreadData td;
+    double num = 0.0, den = 0.0;
+
+    td.src[0]     = s->ref_data;
+    td.src[1]     = s->main_data;
+    td.src_stride = s->width;
+    td.src_w      = s->width;
+    td.src_h      = s->height;
+
+    for (int scale = 0; scale < 4; scale++) {
+        const int nb_jobs = FFMIN((td.src_h + 1) / 2, s->nb_threads);
+        int left, top, right, bottom;
+        float area, num_scale = 0.f, den_scale = 0.f;
+
+        td.w        = (td.src_w + 1) / 2;
+        td.h        = (td.src_h + 1) / 2;
+        td.scale    = scale;
+        td.dst_a[0] = s->band_a[0][scale & 1];
+        td.dst_a[1] = s->band_a[1][scale & 1];
+
+        ff_filter_execute(ctx, adm_dwt2,         &td, NULL, nb_jobs);
+        ff_filter_execute(ctx, adm_decouple_csf, &td, NULL, nb_jobs);
+        ff_filter_execute(ctx, adm_cm,           &td, NULL, nb_jobs);
+
+        /* rows are summed in order so the result does not depend on the
+         * number of threads */
+        adm_region(td.w, td.h, &left, &top, &right, &bottom);
+        area = powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+        for (int theta = 0; theta < 3; theta++) {
+            float accum_num = 0.f, accum_den = 0.f;
+
+            for (int i = top; i < bottom; i++) {
+                accum_num += s->row_sum[theta    ][i];
+                accum_den += s->row_sum[theta + 3][i];
+            }
+            num_scale += powf(accum_num, 1.0f / 3.0f) + area;
+            den_scale += powf(accum_den, 1.0f / 3.0f) + area;
+        }
+        num += num_scale;
+        den += den_scale;
+
+        td.src[0]     = td.dst_a[0];
+        td.src[1]     = td.dst_a[1];
+        td.src_stride = s->band_stride;
+        td.src_w      = td.w;
+        td.src_h      = td.h;
+    }
+
+    num = num < numden_limit ? 0 : num;
+    den = den < numden_limit ? 0 : den;
+
+    return den == 0.0 ? 1.f : num / den;
+}
+
+/* Model: libsvm nu-SVR with a RBF kernel, stored in a libvmaf JSON model */
+
+#define JSON_MAX_DEPTH 32
+
+static const char *json_skip_ws(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+        p++;
+    return p;
+}
+
+static const char *json_skip_string(const char *p)
+{
+    for (p++; *p && *p != '"'; p++)
+        if (*p == '\\' && p[1])
+            p++;
+    return *p ? p + 1 : NULL;
+}
+
+static const char *json_skip_value(const char *p, int depth)
+{
+    const char *start;
+
+    p = json_skip_ws(p);
+    if (*p == '"')
+        return json_skip_string(p);
+
+    if (*p == '{' || *p == '[') {
+        const char close = *p == '{' ? '}' : ']';
+
+        if (depth >= JSON_MAX_DEPTH)
+            return NULL;
+        p = json_skip_ws(p + 1);
+        if (*p == close)
+            return p + 1;
+        for (;;) {
+            if (close == '}') {
+                if (*p != '"' || !(p = json_skip_string(p)))
+                    return NULL;
+                p = json_skip_ws(p);
+                if (*p++ != ':')
+                    return NULL;
+            }
+            if (!(p = json_skip_value(p, depth + 1)))
+                return NULL;
+            p = json_skip_ws(p);
+            if (*p == close)
+                return p + 1;
+            if (*p++ != ',')
+                return NULL;
+            p = json_skip_ws(p);
+        }
+    }
+
+    /* number or literal */
+    start = p;
+    while (*p && !strchr(",]} \t\r\n", *p))
+        p++;
+    return p > start ? p : NULL;
+}
+
+/**
+ * Return the value of the member key of the object at p, NULL if absent.
+ */
+static const char *json_get(const char *p, const char *key)
+{
+    const size_t len = strlen(key);
+
+    if (!p)
+        return NULL;
+    p = json_skip_ws(p);
+    if (*p++ != '{')
+        return NULL;
+    for (;;) {
+        const char *k, *end;
+
+        p = json_skip_ws(p);
+        if (*p != '"')
+            return NULL;
+        k = p + 1;
+        if (!(end = json_skip_string(p)))
+            return NULL;
+        p = json_skip_ws(end);
+        if (*p++ != ':')
+            return NULL;
+        p = json_skip_ws(p);
+        if (end - 1 - k == len && !memcmp(k, key, len))
+            return p;
+        if (!(p = json_skip_value(p, 1)))
+            return NULL;
+        p = json_skip_ws(p);
+        if (*p++ != ',')
+            return NULL;
+    }
+}
+
+/**
+ * Parse an array of numbers, return the number of elements or a negative
+ * value on error.
+ */
+static int json_get_numbers(const char *p, double *dst, int max)
+{
+    int n = 0;
+
+    if (!p || *p++ != '[')
+        return AVERROR_INVALIDDATA;
+    p = json_skip_ws(p);
+    if (*p == ']')
+        return 0;
+    for (;;) {
+        char *end;
+
+        if (n >= max)
+            return AVERROR_INVALIDDATA;
+        dst[n++] = strtod(p, &end);
+        if (end == p)
+            return AVERROR_INVALIDDATA;
+        p = json_skip_ws(end);
+        if (*p == ']')
+            return n;
+        if (*p++ != ',')
+            return AVERROR_INVALIDDATA;
+        p = json_skip_ws(p);
+    }
+}
+
+/**
+ * Unescape the string at p into a newly allocated buffer.
+ */
+static char *json_get_string(const char *p)
+{
+    const char *end;
+    char *str, *q;
+
+    if (!p || *p != '"' || !(end = json_skip_string(p)))
+        return NULL;
+    if (!(q = str = av_malloc(end - p)))
+        return NULL;
+    for (p++; p < end - 1; p++) {
+        if (*p == '\\') {
+            switch (*++p) {
+            case 'n': *q++ = '\n'; break;
+            case 't': *q++ = '\t'; break;
+            case 'r': *q++ = '\r'; break;
+            case 'b': *q++ = '\b'; break;
+            case 'f': *q++ = '\f'; break;
+            case '"': case '\\': case '/': *q++ = *p; break;
+            default:
+                av_free(str);
+                return NULL;
+            }
+        } else {
+            *q++ = *p;
+        }
+    }
+    *q = 0;
+    return str;
+}
+
+static int json_get_bool(const char *p)
+{
+    if (!p)
+        return 0;
+    if (*p == '"')
+        p++;
+    return av_strstart(p, "true", NULL);
+}
+
+static int parse_svm(AVFilterContext *ctx, VMAFModel *m, const char *str)
+{
+    const char *p = str;
+    int nb_sv = -1;
+
+    m->rho = m->gamma = NAN;
+
+    /* header */
+    while (*p) {
+        const char *line = p;
+        const char *arg;
+
+        p += strcspn(p, "\n");
+        if (*p)
+            p++;
+        if (av_strstart(line, "SV", &arg) && (*arg == '\n' || !*arg))
+            break;
+        if (av_strstart(line, "svm_type ", &arg)) {
+            if (!av_strstart(arg, "nu_svr", NULL) && !av_strstart(arg, "epsilon_svr", NULL))
+                goto unsupported;
+        } else if (av_strstart(line, "kernel_type ", &arg)) {
+            if (!av_strstart(arg, "rbf", NULL))
+                goto unsupported;
+        } else if (av_strstart(line, "gamma ", &arg)) {
+            m->gamma = strtod(arg, NULL);
+        } else if (av_strstart(line, "rho ", &arg)) {
+            m->rho = strtod(arg, NULL);
+        } else if (av_strstart(line, "total_sv ", &arg)) {
+            nb_sv = strtol(arg, NULL, 10);
+        }
+    }
+    if (nb_sv <= 0 || isnan(m->gamma) || isnan(m->rho))
+        return AVERROR_INVALIDDATA;
+
+    m->sv_coef = av_calloc(nb_sv, sizeof(*m->sv_coef));
+    m->sv      = av_calloc(nb_sv, m->nb_features * sizeof(*m->sv));
+    if (!m->sv_coef || !m->sv)
+        return AVERROR(ENOMEM);
+
+    /* support vectors: coef index:value ... */
+    for (m->nb_sv = 0; m->nb_sv < nb_sv; m->nb_sv++) {
+        double *sv = m->sv + m->nb_sv * m->nb_features;
+        char *end;
+
+        m->sv_coef[m->nb_sv] = strtod(p, &end);
+        if (end == p)
+            return AVERROR_INVALIDDATA;
+        p = end;
+        for (;;) {
+            long idx;
+
+            p += strspn(p, " \t");
+            if (!*p || *p == '\n' || *p == '\r')
+                break;
+            idx = strtol(p, &end, 10);
+            if (end == p || *end != ':' || idx < 1 || idx > m->nb_features)
+                return AVERROR_INVALIDDATA;
+            p = end + 1;
+            sv[idx - 1] = strtod(p, &end);
+            if (end == p)
+                return AVERROR_INVALIDDATA;
+            p = end;
+        }
+        p += strspn(p, "\r\n");
+    }
+
+    return 0;
+
+unsupported:
+    av_log(ctx, AV_LOG_ERROR, "Only RBF kernel SVR models are supported.\n");
+    return AVERROR_PATCHWELCOME;
+}
+
+static int load_model(AVFilterContext *ctx, VMAFModel *m, const char *filename,
+                      int enable_transform)
+{
+    uint8_t *buf = NULL;
+    char *json = NULL, *names = NULL, *svm = NULL;
+    const char *dict, *p, *transform;
+    size_t size;
+    int ret;
+
+    ret = av_file_map(filename, &buf, &size, 0, ctx);
+    if (ret < 0)
+        return ret;
+    json = av_malloc(size + 1);
+    if (!json) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    memcpy(json, buf, size);
+    json[size] = 0;
+
+    ret = AVERROR_INVALIDDATA;
+    dict = json_get(json, "model_dict");
+    if (!dict)
+        goto end;
+
+    /* features */
+    p = json_get(dict, "feature_names");
+    if (!p || *p++ != '[')
+        goto end;
+    for (m->nb_features = 0;; m->nb_features++) {
+        int i;
+
+        p = json_skip_ws(p);
+        if (*p == ']')
+            break;
+        if (m->nb_features >= NB_FEATURES || !(names = json_get_string(p)))
+            goto end;
+        for (i = 0; i < NB_FEATURES; i++)
+            if (strstr(names, feature_names[i]))
+                break;
+        if (i == NB_FEATURES) {
+            av_log(ctx, AV_LOG_ERROR, "Unsupported model feature '%s'.\n", names);
+            ret = AVERROR_PATCHWELCOME;
+            goto end;
+        }
+        av_freep(&names);
+        m->feature[m->nb_features] = i;
+        p = json_skip_ws(json_skip_string(p));
+        if (*p == ',')
+            p++;
+        else if (*p != ']')
+            goto end;
+    }
+    if (!m->nb_features)
+        goto end;
+
+    /* feature and score normalization */
+    p = json_get(dict, "norm_type");
+    if (p && av_strstart(p, "\"linear_rescale\"", NULL)) {
+        m->linear_rescale = 1;
+        if (json_get_numbers(json_get(dict, "slopes"),     m->slopes,     NB_FEATURES + 1) != m->nb_features + 1 ||
+            json_get_numbers(json_get(dict, "intercepts"), m->intercepts, NB_FEATURES + 1) != m->nb_features + 1 ||
+            m->slopes[0] == 0.0)
+            goto end;
+    } else if (p && !av_strstart(p, "\"none\"", NULL)) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported model normalization.\n");
+        ret = AVERROR_PATCHWELCOME;
+        goto end;
+    }
+
+    transform = json_get(dict, "score_transform");
+    if (enable_transform && transform && json_get_bool(json_get(transform, "enabled"))) {
+        static const char *const coeffs[3] = { "p0", "p1", "p2" };
+
+        m->transform = 1;
+        for (int i = 0; i < 3; i++) {
+            p = json_get(transform, coeffs[i]);
+            m->p[i] = p ? strtod(p, NULL) : 0.0;
+        }
+        m->out_gte_in = json_get_bool(json_get(transform, "out_gte_in"));
+        m->out_lte_in = json_get_bool(json_get(transform, "out_lte_in"));
+    }
+
+    p = json_get(dict, "score_clip");
+    if (p) {
+        double clip[2];
+
+        if (json_get_numbers(p, clip, 2) != 2)
+            goto end;
+        m->clip     = 1;
+        m->clip_min = clip[0];
+        m->clip_max = clip[1];
+    }
+
+    svm = json_get_string(json_get(dict, "model"));
+    if (!svm)
+        goto end;
+    ret = parse_svm(ctx, m, svm);
+
+end:
+    if (ret == AVERROR_INVALIDDATA)
+        av_log(ctx, AV_LOG_ERROR, "Invalid model file '%s'.\n", filename);
+    av_free(names);
+    av_free(svm);
+    av_free(json);
+    av_file_unmap(buf, size);
+    return ret;
+}
+
+static double predict(const VMAFModel *m, const double *features)
+{
+    double x[NB_FEATURES];
+    double score = 0.0;
+
+    for (int i = 0; i < m->nb_features; i++) {
+        x[i] = features[m->feature[i]];
+        if (m->linear_rescale)
+            x[i] = m->slopes[i + 1] * x[i] + m->intercepts[i + 1];
+    }
+
+    for (int n = 0; n < m->nb_sv; n++) {
+        const double *sv = m->sv + n * m->nb_features;
+        double dist = 0.0;
+
+        for (int i = 0; i < m->nb_features; i++)
+            dist += (x[i] - sv[i]) * (x[i] - sv[i]);
+        score += m->sv_coef[n] * exp(-m->gamma * dist);
+    }
+    score -= m->rho;
+
+    if (m->linear_rescale)
+        score = (score - m->intercepts[0]) / m->slopes[0];
+
+    if (m->transform) {
+        double value = m->p[0] + m->p[1] * score + m->p[2] * score * score;
+
+        if (m->out_gte_in)
+            value = FFMAX(value, score);
+        if (m->out_lte_in)
+            value = FFMIN(value, score);
+        score = value;
+    }
+
+    if (m->clip)
+        score = av_clipd(score, m->clip_min, m->clip_max);
+
+    return score;
+}
+
+static void convert(const VMAFContext *s, const AVFrame *in, float *dst)
+{
+    const float factor = 1.f / (1 << (s->desc->comp[0].depth - 8));
+    const int w = s->width;
+
+    for (int i = 0; i < s->height; i++) {
+        if (s->desc->comp[0].depth <= 8) {
+            const uint8_t *src = in->data[0] + i * in->linesize[0];
+
+            for (int j = 0; j < w; j++)
+                dst[j] = src[j] * factor - 128.f;
+        } else {
+            const uint16_t *src = (const uint16_t *)(in->data[0] + i * in->linesize[0]);
+
+            for (int j = 0; j < w; j++)
+                dst[j] = src[j] * factor - 128.f;
+        }
+        dst += w;
+    }
+}
+
+static void set_meta(AVDictionary **metadata, const char *key, float d)
+{
+    char value[128];
+    snprintf(value, sizeof(value), "%f", d);
+    av_dict_set(metadata, key, value, 0);
+}
+
+static int do_vmaf(FFFrameSync *fs)
+{
+    AVFilterContext *ctx = fs->parent;
+    VMAFContext *s = ctx->priv;
+    AVFrame *main, *ref;
+    double *features;
+    float vif[4];
+    int ret;
+
+    ret = ff_framesync_dualinput_get(fs, &main, &ref);
+    if (ret < 0)
+        return ret;
+    if (ctx->is_disabled || !ref)
+        return ff_filter_frame(ctx->outputs[0], main);
+
+    features = av_fast_realloc(s->features, &s->features_size,
+                               (s->nb_frames + 1) * sizeof(*s->features));
+    if (!features) {
+        av_frame_free(&main);
+        return AVERROR(ENOMEM);
+    }
+    s->features = (double (*)[NB_FEATURES])features;
+    features = s->features[s->nb_frames++];
+
+    convert(s, ref,  s->ref_data);
+    convert(s, main, s->main_data);
+
+    ff_compute_vif2(ctx, s->ref_data, s->main_data,
+                    s->width, s->height, s->width, s->width,
+                    vif, s->vif_buf, s->vif_temp, s->nb_threads);
+    for (int i = 0; i < 4; i++)
+        features[FEATURE_VIF_SCALE0 + i] = vif[i];
+    features[FEATURE_ADM2] = compute_adm(ctx);
+    /* turned into motion2 once the next frame is known */
+    features[FEATURE_MOTION2] = ff_vmafmotion_process(&s->motion, ref);
+
+    set_meta(&main->metadata, "lavfi.vmaf.adm2",       features[FEATURE_ADM2]);
+    set_meta(&main->metadata, "lavfi.vmaf.motion",     features[FEATURE_MOTION2]);
+    set_meta(&main->metadata, "lavfi.vmaf.vif_scale0", features[FEATURE_VIF_SCALE0]);
+    set_meta(&main->metadata, "lavfi.vmaf.vif_scale1", features[FEATURE_VIF_SCALE1]);
+    set_meta(&main->metadata, "lavfi.vmaf.vif_scale2", features[FEATURE_VIF_SCALE2]);
+    set_meta(&main->metadata, "lavfi.vmaf.vif_scale3", features[FEATURE_VIF_SCALE3]);
+
+    return ff_filter_frame(ctx->outputs[0], main);
+}
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    VMAFContext *s = ctx->priv;
+    int ret;
+
+    if (s->model_path) {
+        ret = load_model(ctx, &s->model, s->model_path, s->enable_transform);
+        if (ret < 0)
+            return ret;
+        s->has_model = 1;
+    }
+
+    ff_vmaf_adm_init(&s->adm_dsp);
+    s->fs.on_event = do_vmaf;
+
+    return 0;
+}
+
+static const enum AVPixelFormat pix_fmts[] = {
+    AV_PIX_FMT_GRAY8, AV_PIX_FMT_GRAY10,
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV444P,
+    AV_PIX_FMT_YUV440P, AV_PIX_FMT_YUV411P, AV_PIX_FMT_YUV410P,
+    AV_PIX_FMT_YUVJ411P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P,
+    AV_PIX_FMT_YUVJ440P, AV_PIX_FMT_YUVJ444P,
+    AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV444P10,
+    AV_PIX_FMT_YUV440P10,
+    AV_PIX_FMT_NONE
+};
+
+static int config_input_ref(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx  = inlink->dst;
+    VMAFContext *s = ctx->priv;
+    const int w = inlink->w, h = inlink->h;
+    const size_t band_size = (size_t)FFALIGN((w + 1) / 2, 8) * ((h + 1) / 2) + 8;
+    int ret;
+
+    if (ctx->inputs[0]->w != ctx->inputs[1]->w ||
+        ctx->inputs[0]->h != ctx->inputs[1]->h) {
+        av_log(ctx, AV_LOG_ERROR, "Width and height of input videos must be same.\n");
+        return AVERROR(EINVAL);
+    }
+    if (ctx->inputs[0]->format != ctx->inputs[1]->format) {
+        av_log(ctx, AV_LOG_ERROR, "Inputs must be of same pixel format.\n");
+        return AVERROR(EINVAL);
+    }
+    if (w < 32 || h < 32) {
+        av_log(ctx, AV_LOG_ERROR, "Input videos must be at least 32x32.\n");
+        return AVERROR(EINVAL);
+    }
+
+    s->desc = av_pix_fmt_desc_get(inlink->format);
+    s->width = w;
+    s->height = h;
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->band_stride = FFALIGN((w + 1) / 2, 8);
+
+    for (int i = 0; i < NUM_DATA_BUFS; i++) {
+        if (!(s->vif_buf[i] = av_calloc(w, h * sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+
+    /* padded for the SIMD vertical DWT reading past the last row */
+    if (!(s->ref_data  = av_calloc((size_t)w * h + 8, sizeof(float))) ||
+        !(s->main_data = av_calloc((size_t)w * h + 8, sizeof(float))))
+        return AVERROR(ENOMEM);
+
+    if (!(s->vif_temp = av_calloc(s->nb_threads, sizeof(*s->vif_temp))) ||
+        !(s->dwt_temp = av_calloc(s->nb_threads, sizeof(*s->dwt_temp))))
+        return AVERROR(ENOMEM);
+    for (int i = 0; i < s->nb_threads; i++) {
+        if (!(s->vif_temp[i] = av_calloc(w, sizeof(float))) ||
+            !(s->dwt_temp[i] = av_calloc(2 * (FFALIGN(w, 8) + 8), sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+
+    for (int n = 0; n < 2; n++) {
+        for (int i = 0; i < 2; i++) {
+            if (!(s->band_a[n][i] = av_calloc(band_size, sizeof(float))))
+                return AVERROR(ENOMEM);
+        }
+        for (int i = 0; i < 3; i++) {
+            if (!(s->band[n][i] = av_calloc(band_size, sizeof(float))))
+                return AVERROR(ENOMEM);
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!(s->decouple_r[i] = av_calloc(band_size, sizeof(float))) ||
+            !(s->csf_a[i]      = av_calloc(band_size, sizeof(float))) ||
+            !(s->csf_f[i]      = av_calloc(band_size, sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+    for (int i = 0; i < 6; i++) {
+        if (!(s->row_sum[i] = av_calloc((h + 1) / 2, sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+
+    ret = ff_vmafmotion_init(&s->motion, w, h, inlink->format);
+    if (ret < 0)
+        return ret;
+
+    return 0;
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    VMAFContext *s = ctx->priv;
+    AVFilterLink *mainlink = ctx->inputs[0];
+    int ret;
+
+    ret = ff_framesync_init_dualinput(&s->fs, ctx);
+    if (ret < 0)
+        return ret;
+    outlink->w = mainlink->w;
+    outlink->h = mainlink->h;
+    outlink->time_base = mainlink->time_base;
+    outlink->sample_aspect_ratio = mainlink->sample_aspect_ratio;
+    outlink->frame_rate = mainlink->frame_rate;
+
+    if ((ret = ff_framesync_configure(&s->fs)) < 0)
+        return ret;
+
+    outlink->time_base = s->fs.time_base;
+
+    return 0;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    VMAFContext *s = ctx->priv;
+    return ff_framesync_activate(&s->fs);
+}
+
+static void write_scores(AVFilterContext *ctx)
+{
+    VMAFContext *s = ctx->priv;
+    double sum[NB_FEATURES] = { 0 }, vmaf_sum = 0.0;
+    FILE *f = NULL;
+
+    if (s->log_path) {
+        f = av_fopen_utf8(s->log_path, "w");
+        if (!f) {
+            int err = AVERROR(errno);
+            av_log(ctx, AV_LOG_ERROR, "Could not open log file %s: %s\n",
+                   s->log_path, av_err2str(err));
+        }
+    }
+
+    for (int n = 0; n < s->nb_frames; n++) {
+        double *features = s->features[n];
+
+        /* motion2 is the smallest motion to the previous and next frames */
+        if (n + 1 < s->nb_frames)
+            features[FEATURE_MOTION2] = FFMIN(features[FEATURE_MOTION2],
+                                              s->features[n + 1][FEATURE_MOTION2]);
+
+        if (f)
+            fprintf(f, "n:%d", n);
+        if (s->has_model) {
+            const double vmaf = predict(&s->model, features);
+
+            vmaf_sum += vmaf;
+            if (f)
+                fprintf(f, " vmaf:%f", vmaf);
+        }
+        for (int i = 0; i < NB_FEATURES; i++) {
+            sum[i] += features[i];
+            if (f)
+                fprintf(f, " %s:%f", feature_names[i], features[i]);
+        }
+        if (f)
+            fprintf(f, "\n");
+    }
+    if (f)
+        fclose(f);
+
+    for (int i = 0; i < NB_FEATURES; i++)
+        av_log(ctx, AV_LOG_INFO, "%s average:%f\n", feature_names[i], sum[i] / s->nb_frames);
+    if (s->has_model)
+        av_log(ctx, AV_LOG_INFO, "VMAF score: %f\n", vmaf_sum / s->nb_frames);
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    VMAFContext *s = ctx->priv;
+
+    if (s->nb_frames > 0)
+        write_scores(ctx);
+
+    ff_framesync_uninit(&s->fs);
+    ff_vmafmotion_uninit(&s->motion);
+
+    for (int i = 0; i < NUM_DATA_BUFS; i++)
+        av_freep(&s->vif_buf[i]);
+    av_freep(&s->ref_data);
+    av_freep(&s->main_data);
+    for (int i = 0; i < s->nb_threads; i++) {
+        if (s->vif_temp)
+            av_freep(&s->vif_temp[i]);
+        if (s->dwt_temp)
+            av_freep(&s->dwt_temp[i]);
+    }
+    av_freep(&s->vif_temp);
+    av_freep(&s->dwt_temp);
+
+    for (int n = 0; n < 2; n++) {
+        for (int i = 0; i < 2; i++)
+            av_freep(&s->band_a[n][i]);
+        for (int i = 0; i < 3; i++)
+            av_freep(&s->band[n][i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        av_freep(&s->decouple_r[i]);
+        av_freep(&s->csf_a[i]);
+        av_freep(&s->csf_f[i]);
+    }
+    for (int i = 0; i < 6; i++)
+        av_freep(&s->row_sum[i]);
+
+    av_freep(&s->model.sv_coef);
+    av_freep(&s->model.sv);
+    av_freep(&s->features);
+}
+
+static const AVFilterPad vmaf_inputs[] = {
+    {
+        .name         = "main",
+        .type         = AVMEDIA_TYPE_VIDEO,
+    },{
+        .name         = "reference",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input_ref,
+    },
+};
+
+static const AVFilterPad vmaf_outputs[] = {
+    {
+        .name          = "default",
+        .type          = AVMEDIA_TYPE_VIDEO,
+        .config_props  = config_output,
+    },
+};
+
+const AVFilter ff_vf_vmaf = {
+    .name          = "vmaf",
+    .description   = NULL_IF_CONFIG_SMALL("Calculate the VMAF between two video streams."),
+    .preinit       = vmaf_framesync_preinit,
+    .init          = init,
+    .uninit        = uninit,
+    .activate      = activate,
+    .priv_size     = sizeof(VMAFContext),
+    .priv_class    = &vmaf_class,
+    FILTER_INPUTS(vmaf_inputs),
+    FILTER_OUTPUTS(vmaf_outputs),
+    FILTER_PIXFMTS_ARRAY(pix_fmts),
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS             |
+                     AVFILTER_FLAG_METADATA_ONLY,
+};
@@ -0,0 +1,40 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_VIF_H
+#define AVFILTER_VIF_H
+
+#include "avfilter.h"
+
+#define NUM_DATA_BUFS 13
+
+/**
+ * Compute the VIF score of the 4 scales of the main plane against the
+ * reference one. Both planes are float, offset by -128 and scaled to 8 bits.
+ *
+ * @param data_buf    buffers of w * h floats
+ * @param temp        one buffer of w floats per thread
+ * @param gnb_threads number of threads to run the filtering on
+ */
+int ff_compute_vif2(AVFilterContext *ctx,
+                    const float *ref, const float *main, int w, int h,
+                    int ref_stride, int main_stride, float *score,
+                    float *const data_buf[NUM_DATA_BUFS], float **temp,
+                    int gnb_threads);
+
+#endif /* AVFILTER_VIF_H */
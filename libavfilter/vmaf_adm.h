@@ -0,0 +1,37 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_VMAF_ADM_H
+#define AVFILTER_VMAF_ADM_H
+
+typedef struct VMAFADMDSPContext {
+    /**
+     * Vertical pass of the db2 wavelet analysis: filter four source rows
+     * into one row of low and one row of high coefficients.
+     *
+     * w may be rounded up to a multiple of 8: the source rows must be
+     * readable and lo/hi writable for 8 floats past w.
+     */
+    void (*dwt2_v)(const float *src0, const float *src1,
+                   const float *src2, const float *src3,
+                   float *lo, float *hi, int w);
+} VMAFADMDSPContext;
+
+void ff_vmaf_adm_init(VMAFADMDSPContext *dsp);
+
+#endif /* AVFILTER_VMAF_ADM_H */
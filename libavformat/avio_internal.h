@@ -77,6 +77,12 @@ typedef struct FFIOContext {
      * is updated each time a successful writeout ends up further position-wise
      */
     int64_t written_output_size;
+
+    /**
+     * Pools used by av_get_packet() to allocate packet payloads, if set.
+     * Owned by the demuxing AVFormatContext this context belongs to.
+     */
+    struct PacketPool *packet_pool;
 } FFIOContext;
 
 static av_always_inline FFIOContext *ffiocontext(AVIOContext *ctx)
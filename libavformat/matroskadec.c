@@ -1044,12 +1044,21 @@ static int ebml_read_ascii(AVIOContext *pb, int size,
 static int ebml_read_binary(AVIOContext *pb, int length,
                             int64_t pos, EbmlBin *bin)
 {
+    FFIOContext *const ctx = ffiocontext(pb);
     int ret;
 
-    ret = av_buffer_realloc(&bin->buf, length + AV_INPUT_BUFFER_PADDING_SIZE);
-    if (ret < 0)
-        return ret;
-    memset(bin->buf->data + length, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    if (ctx->packet_pool) {
+        // Blocks end up as packet payloads, so take them from the pools.
+        av_buffer_unref(&bin->buf);
+        bin->buf = avpriv_packet_pool_get(ctx->packet_pool, length);
+        if (!bin->buf)
+            return AVERROR(ENOMEM);
+    } else {
+        ret = av_buffer_realloc(&bin->buf, length + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (ret < 0)
+            return ret;
+        memset(bin->buf->data + length, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    }
 
     bin->data = bin->buf->data;
     bin->size = length;
@@ -157,6 +157,7 @@ const AVCodec *ff_find_decoder(AVFormatContext *s, const AVStream *st,
  * Return the number of bytes read or an error. */
 static int append_packet_chunked(AVIOContext *s, AVPacket *pkt, int size)
 {
+    FFIOContext *const ctx = ffiocontext(s);
     int orig_size      = pkt->size;
     int ret;
 
@@ -170,10 +171,19 @@ static int append_packet_chunked(AVIOContext *s, AVPacket *pkt, int size)
         if (read_size > SANE_CHUNK_SIZE/10) {
             read_size = ffio_limit(s, read_size);
             // If filesize/maxsize is unknown, limit to SANE_CHUNK_SIZE
-            if (ffiocontext(s)->maxsize < 0)
+            if (ctx->maxsize < 0)
                 read_size = FFMIN(read_size, SANE_CHUNK_SIZE);
         }
 
+        if (!pkt->buf && !pkt->size && ctx->packet_pool) {
+            pkt->buf = avpriv_packet_pool_get(ctx->packet_pool, read_size);
+            if (!pkt->buf) {
+                ret = AVERROR(ENOMEM);
+                break;
+            }
+            pkt->data = pkt->buf->data;
+        }
+
         ret = av_grow_packet(pkt, read_size);
         if (ret < 0)
             break;
@@ -716,6 +726,9 @@ void avformat_free_context(AVFormatContext *s)
     av_dict_free(&si->id3v2_meta);
     av_packet_free(&si->pkt);
     av_packet_free(&si->parse_pkt);
+    if (s->pb && ffiocontext(s->pb)->packet_pool == &si->packet_pool)
+        ffiocontext(s->pb)->packet_pool = NULL;
+    avpriv_packet_pool_uninit(&si->packet_pool);
     av_freep(&s->streams);
     ff_flush_packet_queue(s);
     av_freep(&s->url);
@@ -16,9 +16,33 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#define _DEFAULT_SOURCE
+#define _SVID_SOURCE // needed for MAP_ANONYMOUS
+#define _DARWIN_C_SOURCE // needed for MAP_ANON
 #include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
+#if HAVE_MMAP && HAVE_MADVISE
+#include <sys/mman.h>
+#if defined(MAP_ANON) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#if defined(MADV_HUGEPAGE) && defined(MAP_ANONYMOUS)
+#define USE_HUGE_PAGES 1
+#endif
+#endif
+#ifndef USE_HUGE_PAGES
+#define USE_HUGE_PAGES 0
+#endif
+#if USE_HUGE_PAGES && defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MPOL_LOCAL
+#define MPOL_LOCAL 4    // memory policy mode from linux/mempolicy.h
+#endif
+#endif
 
 #include "avassert.h"
 #include "buffer_internal.h"
@@ -26,6 +50,10 @@
 #include "mem.h"
 #include "thread.h"
 
+#define HUGE_PAGE_SIZE (2 << 20)
+
+static size_t huge_page_threshold = 0;
+
 static AVBufferRef *buffer_create(AVBuffer *buf, uint8_t *data, size_t size,
                                   void (*free)(void *opaque, uint8_t *data),
                                   void *opaque, int flags)
@@ -74,11 +102,75 @@ void av_buffer_default_free(void *opaque, uint8_t *data)
     av_free(data);
 }
 
+void av_buffer_set_hugepage_threshold(size_t size)
+{
+    huge_page_threshold = size ? FFMAX(size, HUGE_PAGE_SIZE) : 0;
+}
+
+#if USE_HUGE_PAGES
+static void buffer_huge_free(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+/**
+ * Map anonymous memory aligned to the huge page size and ask for it to be
+ * backed by transparent huge pages. The memory is zeroed by the kernel and
+ * not touched here, so that pages are faulted in on the NUMA node of the
+ * thread that first writes them, normally the one producing the data.
+ */
+static AVBufferRef *buffer_alloc_huge(size_t size)
+{
+    AVBufferRef *ret;
+    size_t map_size, lead;
+    uint8_t *map, *data;
+
+    if (size > SIZE_MAX - 2 * HUGE_PAGE_SIZE)
+        return NULL;
+    map_size = FFALIGN(size, HUGE_PAGE_SIZE);
+
+    map = mmap(NULL, map_size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    // Trim the mapping to a huge page aligned range.
+    lead = FFALIGN((uintptr_t)map, HUGE_PAGE_SIZE) - (uintptr_t)map;
+    data = map + lead;
+    if (lead)
+        munmap(map, lead);
+    if (HUGE_PAGE_SIZE - lead)
+        munmap(data + map_size, HUGE_PAGE_SIZE - lead);
+
+    madvise(data, map_size, MADV_HUGEPAGE);
+#if defined(__linux__) && defined(SYS_mbind)
+    // Allocate on the node of the faulting CPU, even if the process runs
+    // with an interleaving policy.
+    syscall(SYS_mbind, data, map_size, MPOL_LOCAL, NULL, 0, 0);
+#endif
+
+    ret = av_buffer_create(data, size, buffer_huge_free,
+                           (void *)(uintptr_t)map_size, 0);
+    if (!ret)
+        munmap(data, map_size);
+
+    return ret;
+}
+#endif
+
 AVBufferRef *av_buffer_alloc(size_t size)
 {
     AVBufferRef *ret = NULL;
     uint8_t    *data = NULL;
 
+#if USE_HUGE_PAGES
+    if (huge_page_threshold && size >= huge_page_threshold) {
+        ret = buffer_alloc_huge(size);
+        if (ret)
+            return ret;
+    }
+#endif
+
     data = av_malloc(size);
     if (!data)
         return NULL;
@@ -96,6 +188,12 @@ AVBufferRef *av_buffer_allocz(size_t size)
     if (!ret)
         return NULL;
 
+#if USE_HUGE_PAGES
+    // Freshly mapped memory is already zeroed.
+    if (ret->buffer->free == buffer_huge_free)
+        return ret;
+#endif
+
     memset(ret->data, 0, size);
     return ret;
 }
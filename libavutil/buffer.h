@@ -107,6 +107,27 @@ AVBufferRef *av_buffer_alloc(size_t size);
  */
 AVBufferRef *av_buffer_allocz(size_t size);
 
+/**
+ * Back large buffers with huge pages.
+ *
+ * Once set, av_buffer_alloc() and av_buffer_allocz() serve requests of at
+ * least size bytes, such as the planes of pooled video frames, from
+ * memory mapped on a 2 MiB boundary and marked for transparent huge pages,
+ * which reduces TLB misses when processing very large frames. On NUMA
+ * systems these pages are placed on the node of the thread that first
+ * writes to them rather than of the allocating thread.
+ *
+ * Sizes are rounded up to a multiple of 2 MiB, so this is only worthwhile
+ * for sizes well above that. If the system does not support it, this has
+ * no effect.
+ *
+ * @param size minimum buffer size for huge page backing; it is raised to
+ *             2 MiB if smaller. 0 (the default) disables huge pages.
+ * @note This is a global setting; it affects all subsequently allocated
+ *       buffers, but not existing ones.
+ */
+void av_buffer_set_hugepage_threshold(size_t size);
+
 /**
  * Always treat the buffer as read-only, even when it has only one
  * reference.
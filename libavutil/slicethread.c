@@ -25,6 +25,8 @@
 
 #if HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS2THREADS
 
+typedef struct SharedPool SharedPool;
+
 typedef struct WorkerContext {
     AVSliceThread   *ctx;
     pthread_mutex_t mutex;
@@ -49,8 +51,34 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    /* shared pool contexts only, protected by the pool mutex */
+    SharedPool      *pool;
+    AVSliceThread   *prev, *next;   ///< links in the queue of the pool
+    int             queued;
+    int             nb_slots;       ///< thread numbers handed out in this execution
+    int             nb_busy;        ///< pool workers running jobs of this context
 };
 
+/**
+ * Process-wide pool of workers, shared by all the contexts created with
+ * avpriv_slicethread_create_shared(). The contexts with pending jobs are
+ * queued and each idle worker joins the one at the head, which is then
+ * moved to the tail, so the submitters are served in turn.
+ */
+struct SharedPool {
+    pthread_t       *threads;
+    int             nb_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    AVSliceThread   *head, *tail;
+    int             finished;
+    int             refcount;
+};
+
+static AVMutex shared_pool_lock = AV_MUTEX_INITIALIZER;
+static SharedPool *shared_pool;
+
 static int run_jobs(AVSliceThread *ctx)
 {
     unsigned nb_jobs    = ctx->nb_jobs;
@@ -92,6 +120,215 @@ static void *attribute_align_arg thread_worker(void *v)
     }
 }
 
+static void queue_push(SharedPool *pool, AVSliceThread *ctx)
+{
+    ctx->next = NULL;
+    ctx->prev = pool->tail;
+    if (pool->tail)
+        pool->tail->next = ctx;
+    else
+        pool->head = ctx;
+    pool->tail  = ctx;
+    ctx->queued = 1;
+}
+
+static void queue_remove(SharedPool *pool, AVSliceThread *ctx)
+{
+    if (ctx->prev)
+        ctx->prev->next = ctx->next;
+    else
+        pool->head = ctx->next;
+    if (ctx->next)
+        ctx->next->prev = ctx->prev;
+    else
+        pool->tail = ctx->prev;
+    ctx->queued = 0;
+}
+
+static void run_shared_jobs(AVSliceThread *ctx, int threadnr)
+{
+    unsigned nb_jobs = ctx->nb_jobs;
+    unsigned jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs)
+        ctx->worker_func(ctx->priv, jobnr, threadnr, nb_jobs, ctx->nb_active_threads);
+}
+
+static void *attribute_align_arg shared_pool_worker(void *v)
+{
+    SharedPool *pool = v;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        AVSliceThread *ctx;
+        int threadnr;
+
+        while (!pool->head && !pool->finished)
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        if (pool->finished)
+            break;
+
+        ctx      = pool->head;
+        threadnr = ctx->nb_slots++;
+        queue_remove(pool, ctx);
+        if (ctx->nb_slots < ctx->nb_active_threads)
+            queue_push(pool, ctx);
+        ctx->nb_busy++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        run_shared_jobs(ctx, threadnr);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (!--ctx->nb_busy)
+            pthread_cond_signal(&ctx->done_cond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static void shared_pool_free(SharedPool **ppool)
+{
+    SharedPool *pool = *ppool;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->finished = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    av_freep(&pool->threads);
+    av_freep(ppool);
+}
+
+static int shared_pool_alloc(SharedPool **ppool)
+{
+    SharedPool *pool;
+    int nb_threads = av_cpu_count();
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return AVERROR(ENOMEM);
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_free(pool);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    *ppool = pool;
+
+    for (int i = 0; i < nb_threads; i++) {
+        int ret = pthread_create(&pool->threads[i], NULL, shared_pool_worker, pool);
+        if (ret) {
+            shared_pool_free(ppool);
+            return AVERROR(ret);
+        }
+        pool->nb_threads++;
+    }
+
+    return 0;
+}
+
+static int shared_pool_ref(SharedPool **ppool)
+{
+    int ret = 0;
+
+    ff_mutex_lock(&shared_pool_lock);
+    if (!shared_pool)
+        ret = shared_pool_alloc(&shared_pool);
+    if (ret >= 0) {
+        shared_pool->refcount++;
+        *ppool = shared_pool;
+    }
+    ff_mutex_unlock(&shared_pool_lock);
+
+    return ret;
+}
+
+static void shared_pool_unref(SharedPool **ppool)
+{
+    ff_mutex_lock(&shared_pool_lock);
+    if (!--(*ppool)->refcount)
+        shared_pool_free(&shared_pool);
+    *ppool = NULL;
+    ff_mutex_unlock(&shared_pool_lock);
+}
+
+static void shared_execute(AVSliceThread *ctx, int nb_jobs)
+{
+    SharedPool *pool = ctx->pool;
+
+    /* the calling thread and the pool workers together must not run more
+     * jobs of this context at once than there are CPUs */
+    ctx->nb_jobs           = nb_jobs;
+    ctx->nb_active_threads = FFMIN3(nb_jobs, ctx->nb_threads, pool->nb_threads);
+    atomic_store_explicit(&ctx->current_job, 0, memory_order_relaxed);
+
+    if (ctx->nb_active_threads > 1) {
+        pthread_mutex_lock(&pool->mutex);
+        ctx->nb_slots = 1;
+        queue_push(pool, ctx);
+        for (int i = 1; i < ctx->nb_active_threads; i++)
+            pthread_cond_signal(&pool->cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    /* the calling thread always takes part, so the jobs complete even when
+     * all the workers of the pool are busy with other contexts */
+    run_shared_jobs(ctx, 0);
+
+    if (ctx->nb_active_threads > 1) {
+        pthread_mutex_lock(&pool->mutex);
+        if (ctx->queued)
+            queue_remove(pool, ctx);
+        while (ctx->nb_busy)
+            pthread_cond_wait(&ctx->done_cond, &pool->mutex);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+int avpriv_slicethread_create_shared(AVSliceThread **pctx, void *priv,
+                                     void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                     int nb_threads)
+{
+    AVSliceThread *ctx;
+    int ret;
+
+    av_assert0(nb_threads >= 0);
+    if (!nb_threads) {
+        int nb_cpus = av_cpu_count();
+        if (nb_cpus > 1)
+            nb_threads = nb_cpus + 1;
+        else
+            nb_threads = 1;
+    }
+
+    *pctx = ctx = av_mallocz(sizeof(*ctx));
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    ctx->priv        = priv;
+    ctx->worker_func = worker_func;
+    ctx->nb_threads  = nb_threads;
+
+    atomic_init(&ctx->first_job, 0);
+    atomic_init(&ctx->current_job, 0);
+    pthread_mutex_init(&ctx->done_mutex, NULL);
+    pthread_cond_init(&ctx->done_cond, NULL);
+
+    if ((ret = shared_pool_ref(&ctx->pool)) < 0) {
+        avpriv_slicethread_free(pctx);
+        return ret;
+    }
+
+    return nb_threads;
+}
+
 int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
                               void (*main_func)(void *priv),
@@ -167,6 +404,11 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     int nb_workers, i, is_last = 0;
 
     av_assert0(nb_jobs > 0);
+    if (ctx->pool) {
+        shared_execute(ctx, nb_jobs);
+        return;
+    }
+
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
@@ -206,9 +448,14 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
         return;
 
     ctx = *pctx;
+    if (ctx->pool)
+        shared_pool_unref(&ctx->pool);
+
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
+    if (!ctx->workers)
+        nb_workers = 0;
 
     ctx->finished = 1;
     for (i = 0; i < nb_workers; i++) {
@@ -243,6 +490,14 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return AVERROR(ENOSYS);
 }
 
+int avpriv_slicethread_create_shared(AVSliceThread **pctx, void *priv,
+                                     void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                     int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     av_assert0(0);
@@ -35,6 +35,27 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create a slice threading context running its jobs on the process-wide
+ * shared worker pool instead of threads of its own. The pool has one worker
+ * per CPU and is freed with the last context using it. The contexts with
+ * pending jobs get the idle workers in turn; nb_threads only caps how many
+ * of them work for this context at once. The thread calling
+ * avpriv_slicethread_execute() always runs jobs too, and counts towards the
+ * limit of one thread per CPU for each context.
+ * The jobs are started in increasing order, but there is no guarantee that
+ * several of them run at the same time: a job may wait on lower numbered
+ * jobs, never on higher numbered ones.
+ * @param pctx slice threading context returned here
+ * @param priv private pointer to be passed to callback function
+ * @param worker_func callback function to be executed
+ * @param nb_threads number of threads, 0 for automatic, must be >= 0
+ * @return return number of threads or negative AVERROR on failure
+ */
+int avpriv_slicethread_create_shared(AVSliceThread **pctx, void *priv,
+                                     void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                     int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
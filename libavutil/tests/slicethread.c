@@ -0,0 +1,122 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program drives two users of the shared slice thread pool at
+ * the same time and checks that every job runs exactly once, that no thread
+ * number is used twice at once and that no more jobs of a context run at
+ * once than there are CPUs.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/cpu.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
+
+#define NB_CPUS         3
+#define NB_USER_THREADS 8
+#define NB_JOBS         16
+#define NB_EXECUTES     200
+
+typedef struct User {
+    AVSliceThread *ctx;
+    int         nb_threads;
+    int         runs[NB_JOBS];
+    atomic_int  busy[NB_USER_THREADS];
+    atomic_int  active;
+    atomic_int  errors;
+} User;
+
+static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    User *u = priv;
+    volatile unsigned sum = 0;
+    int active;
+
+    if (threadnr < 0 || threadnr >= nb_threads ||
+        nb_threads > NB_CPUS || nb_threads > u->nb_threads) {
+        atomic_fetch_add(&u->errors, 1);
+        return;
+    }
+    if (atomic_exchange(&u->busy[threadnr], 1))
+        atomic_fetch_add(&u->errors, 1);
+    active = atomic_fetch_add(&u->active, 1) + 1;
+    if (active > nb_threads)
+        atomic_fetch_add(&u->errors, 1);
+
+    for (int i = 0; i < 10000; i++)
+        sum += i * jobnr;
+    u->runs[jobnr]++;
+
+    atomic_fetch_sub(&u->active, 1);
+    atomic_store(&u->busy[threadnr], 0);
+}
+
+static void *thread_main(void *arg)
+{
+    User *u = arg;
+
+    for (int i = 0; i < NB_EXECUTES; i++) {
+        memset(u->runs, 0, sizeof(u->runs));
+        avpriv_slicethread_execute(u->ctx, NB_JOBS, 0);
+        for (int j = 0; j < NB_JOBS; j++)
+            if (u->runs[j] != 1)
+                atomic_fetch_add(&u->errors, 1);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    User users[2] = { 0 };
+    pthread_t threads[2];
+    int ret = 0;
+
+    av_cpu_force_count(NB_CPUS);
+
+    for (int i = 0; i < 2; i++) {
+        users[i].nb_threads = avpriv_slicethread_create_shared(&users[i].ctx, &users[i],
+                                                               worker_func, NB_USER_THREADS);
+        if (users[i].nb_threads < 0) {
+            fprintf(stderr, "avpriv_slicethread_create_shared failed.\n");
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        if ((ret = pthread_create(&threads[i], NULL, thread_main, &users[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            return 1;
+        }
+    }
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < 2; i++) {
+        if (atomic_load(&users[i].errors)) {
+            fprintf(stderr, "user %d: %d errors\n", i, atomic_load(&users[i].errors));
+            ret = 2;
+        }
+        avpriv_slicethread_free(&users[i].ctx);
+    }
+
+    return ret;
+}
@@ -281,13 +281,33 @@ static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_freep(cc);
 }
 
+static void resample_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ResampleContext *c = priv;
+
+    if (jobnr == nb_jobs - 1) {
+        /* the last channel updates the context; do this on a copy, so the
+         * other channels still see the state they have been started with */
+        ResampleContext tmp = *c;
+
+        c->job.consumed = c->job.resample(&tmp, c->job.dst->ch[jobnr], c->job.src->ch[jobnr], c->job.n, 1);
+        c->job.index    = tmp.index;
+        c->job.frac     = tmp.frac;
+    } else
+        c->job.resample(c, c->job.dst->ch[jobnr], c->job.src->ch[jobnr], c->job.n, 0);
+
+    if (c->job.need_emms)
+        emms_c();
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int nb_threads)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
@@ -317,6 +337,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
             return NULL;
 
         c->format= format;
+        c->nb_threads = -1;
 
         c->felem_size= av_get_bytes_per_sample(c->format);
 
@@ -374,8 +395,22 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     swri_resample_dsp_init(c);
 
+    if (c->nb_threads != nb_threads) {
+        avpriv_slicethread_free(&c->slicethread);
+        c->nb_threads = nb_threads;
+        if (nb_threads != 1) {
+            int ret = avpriv_slicethread_create(&c->slicethread, c, resample_worker, NULL, nb_threads);
+            if (ret <= 1 && ret != AVERROR(ENOSYS)) {
+                avpriv_slicethread_free(&c->slicethread);
+                if (ret < 0)
+                    goto error;
+            }
+        }
+    }
+
     return c;
 error:
+    avpriv_slicethread_free(&c->slicethread);
     av_freep(&c->filter_bank);
     av_free(c);
     return NULL;
@@ -495,8 +530,21 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
              * when frac and dst_incr_mod are zero */
             resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
                             c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            if (c->slicethread && dst->ch_count > 1) {
+                c->job.resample  = resample_func;
+                c->job.dst       = dst;
+                c->job.src       = src;
+                c->job.n         = dst_size;
+                c->job.need_emms = need_emms;
+                avpriv_slicethread_execute(c->slicethread, dst->ch_count, 0);
+                *consumed = c->job.consumed;
+                c->index  = c->job.index;
+                c->frac   = c->job.frac;
+                need_emms = 0;
+            } else {
+                for (i = 0; i < dst->ch_count; i++)
+                    *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            }
         }
     }
 
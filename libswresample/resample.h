@@ -24,6 +24,7 @@
 
 #include "libavutil/log.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/slicethread.h"
 
 #include "swresample_internal.h"
 
@@ -58,6 +59,19 @@ typedef struct ResampleContext {
         int (*resample_linear)(struct ResampleContext *c, void *dst,
                                const void *src, int n, int update_ctx);
     } dsp;
+
+    AVSliceThread *slicethread;
+    int nb_threads;                    /* as requested by the user, 0 for automatic */
+
+    /* state of the channels currently resampled by the thread pool */
+    struct {
+        int (*resample)(struct ResampleContext *c, void *dst,
+                        const void *src, int n, int update_ctx);
+        AudioData *dst, *src;
+        int n;
+        int need_emms;
+        int consumed, index, frac;
+    } job;
 } ResampleContext;
 
 void swri_resample_dsp_init(ResampleContext *c);
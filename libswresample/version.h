@@ -29,7 +29,7 @@
 #include "libavutil/version.h"
 
 #define LIBSWRESAMPLE_VERSION_MAJOR   4
-#define LIBSWRESAMPLE_VERSION_MINOR   0
+#define LIBSWRESAMPLE_VERSION_MINOR   1
 #define LIBSWRESAMPLE_VERSION_MICRO 100
 
 #define LIBSWRESAMPLE_VERSION_INT  AV_VERSION_INT(LIBSWRESAMPLE_VERSION_MAJOR, \
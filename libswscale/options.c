@@ -83,6 +83,7 @@ static const AVOption swscale_options[] = {
 
     { "threads",         "number of threads",             OFFSET(nb_threads),   AV_OPT_TYPE_INT, {.i64 = 1 }, 0, INT_MAX, VE, "threads" },
         { "auto",        NULL,                            0,                  AV_OPT_TYPE_CONST, {.i64 = 0 },    .flags = VE, "threads" },
+    { "shared_threads",  "use the process-wide shared worker pool", OFFSET(shared_threads), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, VE },
 
     { NULL }
 };
@@ -1209,8 +1209,12 @@ static int context_init_threaded(SwsContext *c,
 {
     int ret;
 
-    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
-                                    ff_sws_slice_worker, NULL, c->nb_threads);
+    if (c->shared_threads)
+        ret = avpriv_slicethread_create_shared(&c->slicethread, (void*)c,
+                                               ff_sws_slice_worker, c->nb_threads);
+    else
+        ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                        ff_sws_slice_worker, NULL, c->nb_threads);
     if (ret == AVERROR(ENOSYS)) {
         c->nb_threads = 1;
         return 0;
@@ -0,0 +1,76 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/alsdsp.h"
+#include "libavcodec/mathops.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem_internal.h"
+
+#define BUF_SIZE 256
+#define MAX_ORDER 1023
+
+#define randomize_buffers()                                 \
+    do {                                                    \
+        int i;                                              \
+        for (i = 0; i < MAX_ORDER + BUF_SIZE; i++) {        \
+            int32_t r = sign_extend(rnd(), 24);             \
+            ref_buf[i] = r;                                 \
+            new_buf[i] = r;                                 \
+        }                                                   \
+        for (i = 0; i < MAX_ORDER; i++)                     \
+            coeffs[i] = sign_extend(rnd(), 22);             \
+    } while (0)
+
+static void check_reconstruct(void)
+{
+    LOCAL_ALIGNED_16(int32_t, ref_buf, [MAX_ORDER + BUF_SIZE]);
+    LOCAL_ALIGNED_16(int32_t, new_buf, [MAX_ORDER + BUF_SIZE]);
+    LOCAL_ALIGNED_16(int32_t, coeffs,  [MAX_ORDER]);
+    static const int orders[] = { 1, 2, 3, 4, 7, 10, 20, 32, 127, MAX_ORDER };
+    ALSDSPContext c;
+    int i;
+
+    ff_alsdsp_init(&c);
+    if (check_func(c.reconstruct, "als_reconstruct")) {
+        declare_func(void, int32_t *samples, const int32_t *coeffs,
+                     int order, int len);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(orders); i++) {
+            int order = orders[i];
+            int len   = rnd() % (BUF_SIZE + 1);
+
+            randomize_buffers();
+            call_ref(ref_buf + MAX_ORDER, coeffs + MAX_ORDER - order, order, len);
+            call_new(new_buf + MAX_ORDER, coeffs + MAX_ORDER - order, order, len);
+            if (memcmp(ref_buf, new_buf, (MAX_ORDER + BUF_SIZE) * sizeof(*ref_buf)))
+                fail();
+        }
+        randomize_buffers();
+        bench_new(new_buf + MAX_ORDER, coeffs + MAX_ORDER - 20, 20, BUF_SIZE);
+    }
+
+    report("reconstruct");
+}
+
+void checkasm_check_alsdsp(void)
+{
+    check_reconstruct();
+}
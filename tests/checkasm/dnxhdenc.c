@@ -0,0 +1,84 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/dnxhdenc.h"
+#include "libavutil/mem.h"
+#include "libavutil/mem_internal.h"
+
+static void check_ssd_block(DNXHDEncContext *ctx)
+{
+    LOCAL_ALIGNED_16(int16_t, qblock, [64]);
+    LOCAL_ALIGNED_16(int16_t, block,  [64]);
+    int i;
+
+    declare_func(int, int16_t *qblock, int16_t *block);
+
+    if (check_func(ctx->ssd_block, "dnxhd_ssd_block")) {
+        for (i = 0; i < 64; i++) {
+            block[i]  = rnd() & 0x3FF;
+            qblock[i] = block[i] + (int)(rnd() % 513) - 256;
+        }
+        if (call_ref(qblock, block) != call_new(qblock, block))
+            fail();
+        bench_new(qblock, block);
+    }
+
+    report("ssd_block");
+}
+
+static void check_quantize_10bit(DNXHDEncContext *ctx)
+{
+    LOCAL_ALIGNED_16(int16_t, ref,  [64]);
+    LOCAL_ALIGNED_16(int16_t, new,  [64]);
+    LOCAL_ALIGNED_16(int,     qmat, [64]);
+    int i;
+
+    declare_func(void, int16_t *block, const int *qmat);
+
+    if (check_func(ctx->quantize_10bit, "dnxhd_10bit_quantize")) {
+        for (i = 0; i < 64; i++) {
+            ref[i]  = new[i] = rnd();
+            qmat[i] = rnd() & 0x3FFF;
+        }
+        call_ref(ref, qmat);
+        call_new(new, qmat);
+        if (memcmp(ref, new, 64 * sizeof(*ref)))
+            fail();
+        bench_new(new, qmat);
+    }
+
+    report("quantize_10bit");
+}
+
+void checkasm_check_dnxhdenc(void)
+{
+    DNXHDEncContext *ctx = av_mallocz(sizeof(*ctx));
+
+    if (!ctx)
+        return;
+
+    ctx->bit_depth = 10;
+    ff_dnxhdenc_init(ctx);
+
+    check_ssd_block(ctx);
+    check_quantize_10bit(ctx);
+
+    av_free(ctx);
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/jpeg2000dwt.h"
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+
+#define LEN 64
+#define PAD 6
+#define BUF_SIZE ((LEN + 2 * PAD) * FF_DWT_COLS)
+
+#define randomize_buffers()                                  \
+    do {                                                     \
+        int i;                                               \
+        for (i = 0; i < BUF_SIZE; i++)                       \
+            src[i] = (int32_t)rnd() >> 8;                    \
+    } while (0)
+
+static void check_sd_cols(const char *name, void (*func)(int32_t *, int, int))
+{
+    LOCAL_ALIGNED_32(int32_t, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, new, [BUF_SIZE]);
+    int i0;
+
+    declare_func(void, int32_t *p, int i0, int i1);
+
+    if (!check_func(func, "%s", name))
+        return;
+
+    for (i0 = 0; i0 < 2; i0++) {
+        int i1;
+        for (i1 = i0 + 2; i1 <= LEN; i1 += 7) {
+            randomize_buffers();
+            memcpy(ref, src, sizeof(*src) * BUF_SIZE);
+            memcpy(new, src, sizeof(*src) * BUF_SIZE);
+            call_ref(ref + PAD * FF_DWT_COLS, i0, i1);
+            call_new(new + PAD * FF_DWT_COLS, i0, i1);
+            if (memcmp(ref, new, sizeof(*src) * BUF_SIZE))
+                fail();
+        }
+    }
+    bench_new(new + PAD * FF_DWT_COLS, 0, LEN);
+}
+
+void checkasm_check_jpeg2000dwt(void)
+{
+    int border[2][2] = { { 0, LEN }, { 0, LEN } };
+    DWTContext s53 = { 0 }, s97 = { 0 };
+
+    if (ff_jpeg2000_dwt_init(&s53, border, 1, FF_DWT53) < 0 ||
+        ff_jpeg2000_dwt_init(&s97, border, 1, FF_DWT97_INT) < 0) {
+        fail();
+        goto end;
+    }
+
+    check_sd_cols("jpeg2000_sd_cols53", s53.sd_cols53);
+    report("sd_cols53");
+
+    check_sd_cols("jpeg2000_sd_cols97_int", s97.sd_cols97_int);
+    report("sd_cols97_int");
+
+end:
+    ff_dwt_destroy(&s53);
+    ff_dwt_destroy(&s97);
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/proresencdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+
+#define MAX_BLOCKS 32
+
+static void check_quantize(void)
+{
+    LOCAL_ALIGNED_16(int16_t, blocks, [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_16(int16_t, ref,    [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_16(int16_t, new,    [64 * MAX_BLOCKS]);
+    int16_t qmat[64];
+    ProresEncDSPContext c;
+    int i, nb_blocks;
+
+    declare_func(int, int16_t *levels, const int16_t *blocks,
+                 int nb_blocks, const int16_t *qmat);
+
+    ff_proresencdsp_init(&c);
+
+    if (check_func(c.quantize, "prores_quantize")) {
+        for (nb_blocks = 1; nb_blocks <= MAX_BLOCKS; nb_blocks <<= 1) {
+            for (i = 0; i < 64 * MAX_BLOCKS; i++)
+                blocks[i] = rnd();
+            // mostly small quantizers as in the encoder, some large ones
+            for (i = 0; i < 64; i++)
+                qmat[i] = 2 + rnd() % (i & 7 ? 1022 : 32766);
+            memset(ref, 0, 64 * MAX_BLOCKS * sizeof(*ref));
+            memset(new, 0, 64 * MAX_BLOCKS * sizeof(*new));
+
+            if (call_ref(ref, blocks, nb_blocks, qmat) !=
+                call_new(new, blocks, nb_blocks, qmat) ||
+                memcmp(ref, new, 64 * MAX_BLOCKS * sizeof(*ref)))
+                fail();
+        }
+        bench_new(new, blocks, 16, qmat);
+    }
+
+    report("quantize");
+}
+
+void checkasm_check_proresencdsp(void)
+{
+    check_quantize();
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+#include "libavfilter/scene_sad.h"
+
+#include "checkasm.h"
+
+#define WIDTH  200
+#define HEIGHT 16
+#define STRIDE (WIDTH * 2 + 64)
+#define BUF_SIZE (STRIDE * HEIGHT)
+
+#define randomize_buffers(buf, size, mask)            \
+    do {                                              \
+        for (int j = 0; j < size; j += 2)             \
+            AV_WN16A(buf + j, rnd() & mask);          \
+    } while (0)
+
+static void check_scene_sad(int depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src2, [BUF_SIZE]);
+    const int mask = depth == 8 ? 0xFFFF : 0xFFF;
+    ff_scene_sad_fn sad = ff_scene_sad_get_fn(depth);
+
+    declare_func(void, SCENE_SAD_PARAMS);
+
+    if (check_func(sad, "scene_sad%s", depth == 8 ? "" : "16")) {
+        randomize_buffers(src1, BUF_SIZE, mask);
+        randomize_buffers(src2, BUF_SIZE, mask);
+
+        for (int w = 1; w <= WIDTH; w += 33) {
+            uint64_t sum_ref, sum_new;
+
+            call_ref(src1, STRIDE, src2, STRIDE, w, HEIGHT, &sum_ref);
+            call_new(src1, STRIDE, src2, STRIDE, w, HEIGHT, &sum_new);
+            if (sum_ref != sum_new)
+                fail();
+        }
+        bench_new(src1, STRIDE, src2, STRIDE, WIDTH, HEIGHT, &(uint64_t){ 0 });
+    }
+}
+
+void checkasm_check_scene_sad(void)
+{
+    check_scene_sad(8);
+    report("scene_sad");
+
+    check_scene_sad(16);
+    report("scene_sad16");
+}
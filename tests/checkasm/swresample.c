@@ -0,0 +1,281 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#include "libswresample/resample.h"
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define SRC_LEN 2048
+#define DST_LEN 256
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j += 4)     \
+            AV_WN32A(buf + j, rnd());     \
+    } while (0)
+
+static const struct {
+    enum AVSampleFormat fmt;
+    const char *name;
+} formats[] = {
+    { AV_SAMPLE_FMT_S16P, "int16"  },
+    { AV_SAMPLE_FMT_S32P, "int32"  },
+    { AV_SAMPLE_FMT_FLTP, "float"  },
+    { AV_SAMPLE_FMT_DBLP, "double" },
+};
+
+static const struct {
+    int in, out;
+} rates[] = {
+    { 48000, 44100 },
+    { 44100, 48000 },
+    { 44100,  8000 },
+};
+
+static void fill_src(enum AVSampleFormat fmt, uint8_t *src)
+{
+    int i;
+
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32P:
+        randomize_buffers(src, SRC_LEN * av_get_bytes_per_sample(fmt));
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        for (i = 0; i < SRC_LEN; i++)
+            ((float *)src)[i] = (int32_t)rnd() / (float)INT32_MAX;
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        for (i = 0; i < SRC_LEN; i++)
+            ((double *)src)[i] = (int32_t)rnd() / (double)INT32_MAX;
+        break;
+    }
+}
+
+static int compare_dst(enum AVSampleFormat fmt, const uint8_t *dst0,
+                       const uint8_t *dst1, int len)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)dst0, (const float *)dst1,
+                                         16 * FLT_EPSILON, len);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)dst0, (const double *)dst1,
+                                          16 * DBL_EPSILON, len);
+    default:
+        return memcmp(dst0, dst1, len * av_get_bytes_per_sample(fmt));
+    }
+}
+
+static void check_resample(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [SRC_LEN * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_LEN * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_LEN * 8]);
+    int i, j, linear;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, ResampleContext *c, void *dst,
+                      const void *src, int n, int update_ctx);
+
+    for (linear = 0; linear < 2; linear++) {
+        for (i = 0; i < FF_ARRAY_ELEMS(formats); i++) {
+            for (j = 0; j < FF_ARRAY_ELEMS(rates); j++) {
+                ResampleContext *c, c0, c1;
+                int ret0, ret1;
+
+                c = swri_resampler.init(NULL, rates[j].out, rates[j].in, 16, 10,
+                                        linear, 0.97, formats[i].fmt,
+                                        SWR_FILTER_TYPE_KAISER, 9, 0, 0, 0, 1);
+                if (!c)
+                    fail();
+
+                /* start in the middle of a phase so that the linear
+                 * interpolation actually kicks in */
+                c->frac  = c->src_incr / 3;
+                c->index = 0;
+
+                if (check_func(linear ? c->dsp.resample_linear : c->dsp.resample_common,
+                               "resample_%s_%s_%d_%d", linear ? "linear" : "common",
+                               formats[i].name, rates[j].in, rates[j].out)) {
+                    fill_src(formats[i].fmt, src);
+                    memset(dst0, 0, DST_LEN * 8);
+                    memset(dst1, 0, DST_LEN * 8);
+                    c0 = c1 = *c;
+
+                    ret0 = call_ref(&c0, dst0, src, DST_LEN, 1);
+                    ret1 = call_new(&c1, dst1, src, DST_LEN, 1);
+                    if (ret0 != ret1 || c0.index != c1.index || c0.frac != c1.frac ||
+                        compare_dst(formats[i].fmt, dst0, dst1, DST_LEN))
+                        fail();
+
+                    c1 = *c;
+                    bench_new(&c1, dst1, src, DST_LEN, 0);
+                }
+                swri_resampler.free(&c);
+            }
+        }
+    }
+
+    report("resample");
+}
+
+#define NB_IN 6
+
+static void check_rematrix_float(void)
+{
+    LOCAL_ALIGNED_32(float, src, [NB_IN], [DST_LEN]);
+    LOCAL_ALIGNED_32(float, dst0, [DST_LEN]);
+    LOCAL_ALIGNED_32(float, dst1, [DST_LEN]);
+    float coeffs[NB_IN];
+    struct SwrContext *s;
+    int i, j;
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_FLTP, 48000,
+                           AV_CH_LAYOUT_5POINT1, AV_SAMPLE_FMT_FLTP, 48000, 0, NULL);
+    if (!s || swr_init(s) < 0) {
+        fail();
+        swr_free(&s);
+        return;
+    }
+
+    for (i = 0; i < NB_IN; i++) {
+        for (j = 0; j < DST_LEN; j++)
+            src[i][j] = (int32_t)rnd() / (float)INT32_MAX;
+        coeffs[i] = (int32_t)rnd() / (float)INT32_MAX;
+    }
+
+    {
+        declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in,
+                          void *coeffp, integer index, integer len);
+
+        if (check_func(s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f,
+                       "mix_1_1_float")) {
+            call_ref(dst0, src[0], coeffs, 1, DST_LEN);
+            call_new(dst1, src[0], coeffs, 1, DST_LEN);
+            if (!float_near_abs_eps_array(dst0, dst1, FLT_EPSILON, DST_LEN))
+                fail();
+            bench_new(dst1, src[0], coeffs, 1, DST_LEN);
+        }
+    }
+
+    {
+        declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in1,
+                          const void *in2, void *coeffp, integer index1,
+                          integer index2, integer len);
+
+        if (check_func(s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f,
+                       "mix_2_1_float")) {
+            call_ref(dst0, src[0], src[1], coeffs, 2, 3, DST_LEN);
+            call_new(dst1, src[0], src[1], coeffs, 2, 3, DST_LEN);
+            if (!float_near_abs_eps_array(dst0, dst1, 2 * FLT_EPSILON, DST_LEN))
+                fail();
+            bench_new(dst1, src[0], src[1], coeffs, 2, 3, DST_LEN);
+        }
+    }
+
+    swr_free(&s);
+
+    report("rematrix_float");
+}
+
+static void check_rematrix_int16(void)
+{
+    LOCAL_ALIGNED_32(int16_t, src, [2], [DST_LEN + 16]);
+    LOCAL_ALIGNED_32(int16_t, dst0, [DST_LEN + 16]);
+    LOCAL_ALIGNED_32(int16_t, dst1, [DST_LEN + 16]);
+    struct SwrContext *s;
+    void *coeffs1, *coeffs2;
+    int i, j, off;
+
+    /* The default 5.1 to stereo downmix needs no clipping and keeps every
+     * coefficient below 1 << 15, so the SIMD matrix uses the same scale as
+     * the C one and the results must match exactly. */
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, AV_SAMPLE_FMT_S16P, 48000,
+                           AV_CH_LAYOUT_5POINT1, AV_SAMPLE_FMT_S16P, 48000, 0, NULL);
+    if (!s || swr_init(s) < 0) {
+        fail();
+        swr_free(&s);
+        return;
+    }
+    /* the SIMD functions take the coefficients in their own layout */
+    coeffs1 = s->mix_1_1_simd ? s->native_simd_matrix : s->native_matrix;
+    coeffs2 = s->mix_2_1_simd ? s->native_simd_matrix : s->native_matrix;
+
+    for (i = 0; i < 2; i++)
+        for (j = 0; j < DST_LEN + 16; j++)
+            src[i][j] = rnd();
+
+    {
+        declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in,
+                          void *coeffp, integer index, integer len);
+
+        if (check_func(s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f,
+                       "mix_1_1_int16")) {
+            /* the second pass hits the unaligned code path */
+            for (off = 0; off < 2; off++) {
+                memset(dst0, 0, (DST_LEN + 16) * sizeof(*dst0));
+                memset(dst1, 0, (DST_LEN + 16) * sizeof(*dst1));
+                call_ref(dst0 + off, src[0] + off, s->native_matrix, 0, DST_LEN);
+                call_new(dst1 + off, src[0] + off, coeffs1, 0, DST_LEN);
+                if (memcmp(dst0, dst1, (DST_LEN + 16) * sizeof(*dst0)))
+                    fail();
+            }
+            bench_new(dst1, src[0], coeffs1, 0, DST_LEN);
+        }
+    }
+
+    {
+        declare_func_emms(AV_CPU_FLAG_MMX, void, void *out, const void *in1,
+                          const void *in2, void *coeffp, integer index1,
+                          integer index2, integer len);
+
+        if (check_func(s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f,
+                       "mix_2_1_int16")) {
+            for (off = 0; off < 2; off++) {
+                memset(dst0, 0, (DST_LEN + 16) * sizeof(*dst0));
+                memset(dst1, 0, (DST_LEN + 16) * sizeof(*dst1));
+                call_ref(dst0 + off, src[0] + off, src[1], s->native_matrix, 0, 2, DST_LEN);
+                call_new(dst1 + off, src[0] + off, src[1], coeffs2, 0, 2, DST_LEN);
+                if (memcmp(dst0, dst1, (DST_LEN + 16) * sizeof(*dst0)))
+                    fail();
+            }
+            bench_new(dst1, src[0], src[1], coeffs2, 0, 2, DST_LEN);
+        }
+    }
+
+    swr_free(&s);
+
+    report("rematrix_int16");
+}
+
+void checkasm_check_swresample(void)
+{
+    check_resample();
+    check_rematrix_float();
+    check_rematrix_int16();
+}
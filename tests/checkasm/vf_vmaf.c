@@ -0,0 +1,76 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/mem_internal.h"
+#include "libavfilter/vmaf_adm.h"
+
+#include "checkasm.h"
+
+#define WIDTH 963
+/* the SIMD versions may write up to 8 floats past the end of the row */
+#define BUF_SIZE (WIDTH + 8)
+
+#define randomize_buffers(buf, size)                   \
+    do {                                               \
+        for (int j = 0; j < size; j++)                 \
+            buf[j] = (float)(rnd() & 0xFF) - 128.f;    \
+    } while (0)
+
+static void check_dwt2_v(const VMAFADMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, src, [4], [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, lo_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, lo_new, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, hi_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, hi_new, [BUF_SIZE]);
+
+    declare_func(void, const float *src0, const float *src1,
+                 const float *src2, const float *src3,
+                 float *lo, float *hi, int w);
+
+    for (int i = 0; i < 4; i++)
+        randomize_buffers(src[i], BUF_SIZE);
+
+    if (check_func(dsp->dwt2_v, "vmaf_dwt2_v")) {
+        for (int w = 1; w <= WIDTH; w += 481) {
+            memset(lo_ref, 0, BUF_SIZE * sizeof(float));
+            memset(lo_new, 0, BUF_SIZE * sizeof(float));
+            memset(hi_ref, 0, BUF_SIZE * sizeof(float));
+            memset(hi_new, 0, BUF_SIZE * sizeof(float));
+
+            call_ref(src[0], src[1], src[2], src[3], lo_ref, hi_ref, w);
+            call_new(src[0], src[1], src[2], src[3], lo_new, hi_new, w);
+            /* the filter relies on these being bit-exact with the C version */
+            if (memcmp(lo_ref, lo_new, w * sizeof(float)) ||
+                memcmp(hi_ref, hi_new, w * sizeof(float)))
+                fail();
+        }
+        bench_new(src[0], src[1], src[2], src[3], lo_new, hi_new, WIDTH);
+    }
+    report("dwt2_v");
+}
+
+void checkasm_check_vf_vmaf(void)
+{
+    VMAFADMDSPContext dsp;
+
+    ff_vmaf_adm_init(&dsp);
+    check_dwt2_v(&dsp);
+}
@@ -382,6 +382,16 @@ refcmp_metadata(){
         -f null /dev/null | awk -v ref=${ref} -v fuzz=${fuzz} -f ${base}/refcmp-metadata.awk -
 }
 
+vmaf_model(){
+    model=$1
+    fuzz=${2:-0.001}
+    log="${outdir}/${test}.log"
+    ffmpeg $FLAGS $ENC_OPTS \
+        -lavfi "testsrc2=size=300x200:rate=1:duration=5,format=yuv420p,split[ref][tmp];[tmp]avgblur=4[enc];[enc][ref]vmaf=model_path=${model}:enable_transform=1:log_path=${log}" \
+        -f null /dev/null &&
+    tr ' ' '\n' < ${log} | sed 's/:/=/' | awk -v ref=${ref} -v fuzz=${fuzz} -f ${base}/refcmp-metadata.awk -
+}
+
 pixfmt_conversion(){
     conversion="${test#pixfmt-}"
     outdir="tests/data/pixfmt"
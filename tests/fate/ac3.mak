@@ -63,6 +63,23 @@ FATE_EAC3 += fate-eac3-5
 fate-eac3-5: CMD = pcm -i $(TARGET_SAMPLES)/eac3/the_great_wall_7.1.eac3
 fate-eac3-5: REF = $(SAMPLES)/eac3/the_great_wall_7.1.pcm
 
+# frame threads must match the single threaded output
+FATE_AC3 += fate-ac3-5.1-frame-threads
+fate-ac3-5.1-frame-threads: CMD = threads=3 thread_type=frame pcm -i $(TARGET_SAMPLES)/ac3/monsters_inc_5.1_448_small.ac3
+fate-ac3-5.1-frame-threads: REF = $(SAMPLES)/ac3/monsters_inc_5.1_448_small_v2.pcm
+
+FATE_AC3 += fate-ac3-fixed-5.1-downmix-stereo-frame-threads
+fate-ac3-fixed-5.1-downmix-stereo-frame-threads: CMD = threads=3 thread_type=frame pcm -c ac3_fixed -request_channel_layout 3 -i $(TARGET_SAMPLES)/ac3/monsters_inc_5.1_448_small.ac3
+fate-ac3-fixed-5.1-downmix-stereo-frame-threads: REF = $(SAMPLES)/ac3/monsters_inc_5.1_448_small_stereo_v2.pcm
+
+FATE_EAC3 += fate-eac3-1-frame-threads
+fate-eac3-1-frame-threads: CMD = threads=3 thread_type=frame pcm -i $(TARGET_SAMPLES)/eac3/csi_miami_5.1_256_spx_small.eac3
+fate-eac3-1-frame-threads: REF = $(SAMPLES)/eac3/csi_miami_5.1_256_spx_small_v2.pcm
+
+FATE_EAC3 += fate-eac3-5-frame-threads
+fate-eac3-5-frame-threads: CMD = threads=3 thread_type=frame pcm -i $(TARGET_SAMPLES)/eac3/the_great_wall_7.1.eac3
+fate-eac3-5-frame-threads: REF = $(SAMPLES)/eac3/the_great_wall_7.1.pcm
+
 $(FATE_AC3) $(FATE_EAC3): CMP = oneoff
 
 FATE_AC3-$(call  DEMDEC, AC3,  AC3)  += $(FATE_AC3)
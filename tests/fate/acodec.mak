@@ -137,6 +137,16 @@ fate-acodec-flac: CODEC = flac -compression_level 2
 fate-acodec-flac-exact-rice: FMT = flac
 fate-acodec-flac-exact-rice: CODEC = flac -compression_level 2 -exact_rice_parameters 1
 
+# slice threaded encoding must match the single threaded reference
+define FATE_ACODEC_FLAC_THREADS
+FATE_ACODEC-$(call ENCDEC, FLAC, FLAC) += fate-acodec-flac-threads-$(1)
+fate-acodec-flac-threads-$(1): CMD = md5 -auto_conversion_filters -f wav -i $(TARGET_PATH)/tests/data/asynth-44100-2.wav -threads $(1) -thread_type slice -flags +bitexact -fflags +bitexact -b:a 128k -c flac -compression_level 2 -f flac
+fate-acodec-flac-threads-$(1): CMP = oneline
+fate-acodec-flac-threads-$(1): REF = 151eef9097f944726968bec48649f00a
+endef
+
+$(foreach N,2 3 4,$(eval $(call FATE_ACODEC_FLAC_THREADS,$(N))))
+
 FATE_ACODEC-$(call ENCDEC, G723_1, G723_1) += fate-acodec-g723_1
 fate-acodec-g723_1: tests/data/asynth-8000-1.wav
 fate-acodec-g723_1: SRC = tests/data/asynth-8000-1.wav
@@ -11,5 +11,16 @@ FATE_ALS += fate-mpeg4-als-conformance-09
 
 fate-mpeg4-als-conformance-09: CMD = crc -i $(TARGET_SAMPLES)/lossless-audio/als_09_512ch2k16b.mp4
 
+# frame threads must match the single threaded output
+ALS_FRAME_THREADS = 2 3 5
+
+define FATE_ALS_FRAME_THREADS
+FATE_ALS += fate-mpeg4-als-conformance-$(1)-frame-threads-$(2)
+fate-mpeg4-als-conformance-$(1)-frame-threads-$(2): CMD = threads=$(2) thread_type=frame crc -i $(TARGET_SAMPLES)/lossless-audio/als_$(1)_2ch48k16b.mp4
+fate-mpeg4-als-conformance-$(1)-frame-threads-$(2): REF = $(SRC_PATH)/tests/ref/fate/mpeg4-als-conformance-$(1)
+endef
+
+$(foreach N,$(ALS_SUITE),$(foreach T,$(ALS_FRAME_THREADS),$(eval $(call FATE_ALS_FRAME_THREADS,$(N),$(T)))))
+
 FATE_SAMPLES_AVCONV-$(call DEMDEC, MOV, ALS) += $(FATE_ALS)
 fate-als: $(FATE_ALS)
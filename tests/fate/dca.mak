@@ -38,6 +38,15 @@ $(foreach N,$(DCADEC_SUITE_LOSSLESS_16),$(eval $(call FATE_DCADEC_LOSSLESS_SUITE
 $(foreach N,$(DCADEC_SUITE_LOSSLESS_24),$(eval $(call FATE_DCADEC_LOSSLESS_SUITE,$(N),s24le)))
 $(foreach N,$(DCADEC_SUITE_LOSSY),$(eval $(call FATE_DCADEC_LOSSY_SUITE,$(N))))
 
+# channel sets decoded on slice threads must match the single threaded output
+define FATE_DCADEC_LOSSLESS_THREADS
+FATE_DCADEC_LOSSLESS += fate-dca-$(1)-slice-threads
+fate-dca-$(1)-slice-threads: CMD = threads=3 thread_type=slice framemd5 -i $(TARGET_SAMPLES)/dts/dcadec-suite/$(1).dtshd -c:a pcm_s24le -af aresample
+fate-dca-$(1)-slice-threads: REF = $(SRC_PATH)/tests/ref/fate/dca-$(1)
+endef
+
+$(foreach N,xll_71_24_48_768_0 xll_x96_51_24_96_1509 xll_xch_61_24_48_768,$(eval $(call FATE_DCADEC_LOSSLESS_THREADS,$(N))))
+
 # lossy downmix tests
 FATE_DCADEC_LOSSY += fate-dca-core_51_24_48_768_1-dmix_2
 fate-dca-core_51_24_48_768_1-dmix_2: CMD = ffmpeg -request_channel_layout 0x3 -i $(TARGET_SAMPLES)/dts/dcadec-suite/core_51_24_48_768_1.dtshd -f f32le -af aresample -
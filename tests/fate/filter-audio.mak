@@ -392,10 +392,17 @@ fate-filter-hdcd-s32p: CMD = md5 -i $(SRC) -af hdcd -f s32le
 fate-filter-hdcd-s32p: CMP = oneline
 fate-filter-hdcd-s32p: REF = 0c5513e83eedaa10ab6fac9ddc173cf5
 
+# The tone starts at 0.1s, so silence_end shows whether the look-ahead delay is
+# compensated, and the frame list shows that no samples are lost or added.
+LOUDNORM_LOOKAHEAD_DEPS = FFPROBE AVDEVICE LAVFI_INDEV AEVALSRC_FILTER LOUDNORM_FILTER ASETNSAMPLES_FILTER SILENCEDETECT_FILTER
+FATE_AFILTER_FFPROBE-$(call ALLYES, $(LOUDNORM_LOOKAHEAD_DEPS)) += fate-filter-loudnorm-lookahead
+fate-filter-loudnorm-lookahead: CMD = run ffprobe$(PROGSSUF)$(EXESUF) -of compact=p=0 -show_entries frame=pts,nb_samples:frame_tags -bitexact -f lavfi "aevalsrc=if(gte(n\,4800)\,0.5*cos(2*PI*440*t)\,0):s=48000:d=2,loudnorm=lookahead=37,asetnsamples=n=24000:p=0,silencedetect=n=-60dB:d=0.05"
+
 FATE_AFILTER-yes += fate-filter-formats
 fate-filter-formats: libavfilter/tests/formats$(EXESUF)
 fate-filter-formats: CMD = run libavfilter/tests/formats$(EXESUF)
 
 FATE_SAMPLES_AVCONV += $(FATE_AFILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_AFILTER-yes)
-fate-afilter: $(FATE_AFILTER-yes) $(FATE_AFILTER_SAMPLES-yes)
+FATE_FFPROBE += $(FATE_AFILTER_FFPROBE-yes)
+fate-afilter: $(FATE_AFILTER-yes) $(FATE_AFILTER_SAMPLES-yes) $(FATE_AFILTER_FFPROBE-yes)
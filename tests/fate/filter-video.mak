@@ -818,6 +818,12 @@ FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_METADATA_DEPS)) += fate-filter-met
 fate-filter-metadata-ebur128: SRC = $(TARGET_SAMPLES)/filter/seq-3341-7_seq-3342-5-24bit.flac
 fate-filter-metadata-ebur128: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',ebur128=metadata=1"
 
+EBUR128_PEAK_METADATA_DEPS = FFPROBE AVDEVICE LAVFI_INDEV AMOVIE_FILTER WAV_DEMUXER PCM_S16LE_DECODER EBUR128_FILTER SWRESAMPLE
+FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_PEAK_METADATA_DEPS)) += fate-filter-metadata-ebur128-peak
+fate-filter-metadata-ebur128-peak: tests/data/asynth-44100-6.wav
+fate-filter-metadata-ebur128-peak: SRC = $(TARGET_PATH)/tests/data/asynth-44100-6.wav
+fate-filter-metadata-ebur128-peak: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',ebur128=metadata=1:peak=sample+true"
+
 READVITC_METADATA_DEPS = FFPROBE LAVFI_INDEV MOVIE_FILTER AVCODEC AVDEVICE \
                          AVI_DEMUXER FFVHUFF_DECODER READVITC_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(READVITC_METADATA_DEPS)) += fate-filter-metadata-readvitc-def
@@ -859,6 +865,12 @@ fate-filter-refcmp-ssim-rgb: CMD = refcmp_metadata ssim rgb24 0.015
 FATE_FILTER-$(call ALLYES, $(REFCMP_DEPS) SSIM_FILTER) += fate-filter-refcmp-ssim-yuv
 fate-filter-refcmp-ssim-yuv: CMD = refcmp_metadata ssim yuv422p 0.015
 
+FATE_FILTER-$(call ALLYES, $(REFCMP_DEPS) VMAF_FILTER) += fate-filter-refcmp-vmaf-yuv
+fate-filter-refcmp-vmaf-yuv: CMD = refcmp_metadata vmaf yuv420p 0.015
+
+FATE_FILTER-$(call ALLYES, $(REFCMP_DEPS) VMAF_FILTER) += fate-filter-vmaf-model
+fate-filter-vmaf-model: CMD = vmaf_model $(SRC_PATH)/tests/vmaf_model.json 0.015
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
@@ -227,6 +227,17 @@ FATE_H264-$(call DEMDEC, FLV, H264) += fate-h264-brokensps-2580
 FATE_H264-$(call DEMDEC, MXF, H264) += fate-h264-xavc-4389
 FATE_H264-$(call DEMDEC, MOV, H264) += fate-h264-attachment-631
 FATE_H264-$(call DEMDEC, MPEGTS, H264) += fate-h264-skip-nokey fate-h264-skip-nointra
+
+# low-delay frame threading must output the same frames in the same order
+define FATE_H264_FRAMES_IN_FLIGHT_TEST
+FATE_H264-$(call DEMDEC, H264, H264) += fate-h264-frames-in-flight-$(2)-$(1)
+fate-h264-frames-in-flight-$(2)-$(1): CMD = threads=4 thread_type=frame framecrc -max_frames_in_flight $(2) -i $(TARGET_SAMPLES)/h264-conformance/$(3)
+fate-h264-frames-in-flight-$(2)-$(1): REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-$(1)
+endef
+
+$(foreach M,1 2 3,$(eval $(call FATE_H264_FRAMES_IN_FLIGHT_TEST,cabac_mot_fld0_full,$(M),camp_mot_fld0_full.26l)))
+$(foreach M,1 2 3,$(eval $(call FATE_H264_FRAMES_IN_FLIGHT_TEST,frext-frext_mmco4_sony_b,$(M),FRext/FRExt_MMCO4_Sony_B.264)))
+
 FATE_H264_FFPROBE-$(call DEMDEC, MATROSKA, H264) += fate-h264-dts_5frames
 
 FATE_SAMPLES_AVCONV += $(FATE_H264-yes)
@@ -253,6 +253,24 @@ fate-hevc-bsf-mp4toannexb: CMD = md5 -i $(TARGET_PATH)/tests/data/hevc-mp4.mov -
 fate-hevc-bsf-mp4toannexb: CMP = oneline
 fate-hevc-bsf-mp4toannexb: REF = 1873662a3af1848c37e4eb25722c8df9
 
+# frame threads running WPP slice threads must match the single threaded output
+define FATE_HEVC_WPP_FRAME_TEST
+FATE_HEVC += fate-hevc-wpp-frame-threads-$(1)
+fate-hevc-wpp-frame-threads-$(1): CMD = threads=2 thread_type=frame framecrc -wpp_threads 3 -flags unaligned -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit -pix_fmt yuv420p
+fate-hevc-wpp-frame-threads-$(1): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+endef
+
+$(foreach N,WPP_B_ericsson_MAIN_2 WPP_E_ericsson_MAIN_2,$(eval $(call FATE_HEVC_WPP_FRAME_TEST,$(N))))
+
+# low-delay frame threading must output the same frames in the same order
+define FATE_HEVC_FRAMES_IN_FLIGHT_TEST
+FATE_HEVC += fate-hevc-frames-in-flight-$(2)-$(1)
+fate-hevc-frames-in-flight-$(2)-$(1): CMD = threads=4 thread_type=frame framecrc -max_frames_in_flight $(2) -flags unaligned -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit -pix_fmt yuv420p
+fate-hevc-frames-in-flight-$(2)-$(1): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+endef
+
+$(foreach N,POC_A_Bossen_3 RAP_A_docomo_4,$(foreach M,1 2 3,$(eval $(call FATE_HEVC_FRAMES_IN_FLIGHT_TEST,$(N),$(M)))))
+
 fate-hevc-skiploopfilter: CMD = framemd5 -skip_loop_filter nokey -i $(TARGET_SAMPLES)/hevc-conformance/SAO_D_Samsung_5.bit -sws_flags bitexact
 FATE_HEVC += fate-hevc-skiploopfilter
 
@@ -1094,5 +1094,17 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+# the reference is the single threaded output, the threaded runs must match it
+FATE_SWR_THREADS-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, FRAMECRC) += fate-swr-threads-1
+fate-swr-threads-1: tests/data/asynth-44100-6.wav
+fate-swr-threads-1: CMD = framecrc -i $(TARGET_PATH)/tests/data/asynth-44100-6.wav -af aresample=48000:internal_sample_fmt=s16p:threads=1 -c:a pcm_s16le
+fate-swr-threads-1: REF = $(SRC_PATH)/tests/ref/fate/swr-threads
+
+FATE_SWR_THREADS-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, FRAMECRC) += fate-swr-threads
+fate-swr-threads: tests/data/asynth-44100-6.wav
+fate-swr-threads: CMD = framecrc -i $(TARGET_PATH)/tests/data/asynth-44100-6.wav -af aresample=48000:internal_sample_fmt=s16p:threads=4 -c:a pcm_s16le
+
+FATE_SWR += $(FATE_SWR_THREADS-yes)
 FATE_FFMPEG += $(FATE_SWR)
 fate-swr: $(FATE_SWR)
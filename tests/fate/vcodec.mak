@@ -290,6 +290,7 @@ fate-vsynth%-mpeg2-thread-ivlc:  ENCOPTS = -qscale 10 -bf 2 -flags +ildct+ilme \
 
 FATE_MPEG4_MP4 = mpeg4
 FATE_MPEG4_AVI = mpeg4-rc                                               \
+                 mpeg4-frames-in-flight                                 \
                  mpeg4-adv                                              \
                  mpeg4-qprd                                             \
                  mpeg4-adap                                             \
@@ -334,6 +335,10 @@ fate-vsynth%-mpeg4-qprd:         ENCOPTS = -b 450k -bf 2 -trellis 1          \
 
 fate-vsynth%-mpeg4-rc:           ENCOPTS = -b 400k -bf 2
 
+fate-vsynth%-mpeg4-frames-in-flight: ENCOPTS   = -b 400k -bf 2
+fate-vsynth%-mpeg4-frames-in-flight: DECINOPTS = -threads 4 -thread_type frame \
+                                                 -max_frames_in_flight 3
+
 fate-vsynth%-mpeg4-thread:       ENCOPTS = -b 500k -flags +mv4+aic         \
                                            -data_partitioning 1 -trellis 1 \
                                            -mbd bits -ps 200 -bf 2         \
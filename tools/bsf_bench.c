@@ -0,0 +1,175 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the throughput of a bitstream filter chain.
+ *
+ * All packets of one stream are read into memory first, so that only the
+ * filtering itself is timed:
+ *
+ *   bsf_bench input.h264 h264_metadata=video_full_range_flag=1 20
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/error.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavformat/avformat.h"
+
+#include "libavcodec/bsf.h"
+
+static int filter_all(const AVCodecParameters *par, AVRational time_base,
+                      const char *bsf_str, AVPacket **pkts, int nb_pkts,
+                      int64_t *out_size)
+{
+    AVBSFContext *bsf = NULL;
+    AVPacket *pkt = av_packet_alloc();
+    int ret, i;
+
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    ret = av_bsf_list_parse_str(bsf_str, &bsf);
+    if (ret < 0)
+        goto end;
+
+    ret = avcodec_parameters_copy(bsf->par_in, par);
+    if (ret < 0)
+        goto end;
+    bsf->time_base_in = time_base;
+
+    ret = av_bsf_init(bsf);
+    if (ret < 0)
+        goto end;
+
+    for (i = 0; i <= nb_pkts; i++) {
+        if (i < nb_pkts) {
+            ret = av_packet_ref(pkt, pkts[i]);
+            if (ret < 0)
+                goto end;
+            ret = av_bsf_send_packet(bsf, pkt);
+        } else {
+            ret = av_bsf_send_packet(bsf, NULL);
+        }
+        if (ret < 0)
+            goto end;
+
+        while ((ret = av_bsf_receive_packet(bsf, pkt)) >= 0) {
+            *out_size += pkt->size;
+            av_packet_unref(pkt);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            goto end;
+    }
+    ret = 0;
+
+end:
+    av_bsf_free(&bsf);
+    av_packet_free(&pkt);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    AVFormatContext *fmt_ctx = NULL;
+    AVPacket **pkts = NULL;
+    AVStream *st;
+    int nb_pkts = 0, iterations = 10;
+    int64_t in_size = 0, out_size = 0, start, elapsed;
+    int ret, i, stream_index;
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <input file> <bsf list> [iterations]\n",
+                argv[0]);
+        return 1;
+    }
+    if (argc > 3)
+        iterations = FFMAX(atoi(argv[3]), 1);
+
+    ret = avformat_open_input(&fmt_ctx, argv[1], NULL, NULL);
+    if (ret < 0)
+        goto end;
+    ret = avformat_find_stream_info(fmt_ctx, NULL);
+    if (ret < 0)
+        goto end;
+    stream_index = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO,
+                                       -1, -1, NULL, 0);
+    if (stream_index < 0)
+        stream_index = 0;
+    st = fmt_ctx->streams[stream_index];
+
+    while (1) {
+        AVPacket *pkt = av_packet_alloc();
+        if (!pkt) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        ret = av_read_frame(fmt_ctx, pkt);
+        if (ret < 0) {
+            av_packet_free(&pkt);
+            break;
+        }
+        if (pkt->stream_index != stream_index) {
+            av_packet_free(&pkt);
+            continue;
+        }
+        ret = av_dynarray_add_nofree(&pkts, &nb_pkts, pkt);
+        if (ret < 0) {
+            av_packet_free(&pkt);
+            goto end;
+        }
+        in_size += pkt->size;
+    }
+    if (!nb_pkts) {
+        fprintf(stderr, "No packets read from %s\n", argv[1]);
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    start = av_gettime_relative();
+    for (i = 0; i < iterations; i++) {
+        ret = filter_all(st->codecpar, st->time_base, argv[2],
+                         pkts, nb_pkts, &out_size);
+        if (ret < 0)
+            goto end;
+    }
+    elapsed = FFMAX(av_gettime_relative() - start, 1);
+
+    printf("%s: %d packets, %"PRId64" bytes in, %"PRId64" bytes out\n",
+           argv[2], nb_pkts, in_size, out_size / iterations);
+    printf("%.3f ms per pass, %.1f MB/s, %.0f packets/s\n",
+           elapsed / 1000.0 / iterations,
+           (double)in_size * iterations / elapsed,
+           (double)nb_pkts * iterations * 1000000 / elapsed);
+    ret = 0;
+
+end:
+    for (i = 0; i < nb_pkts; i++)
+        av_packet_free(&pkts[i]);
+    av_freep(&pkts);
+    avformat_close_input(&fmt_ctx);
+    if (ret < 0) {
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}